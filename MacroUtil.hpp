@@ -19,4 +19,15 @@
     TypeName(const TypeName&);             \
     void operator=(const TypeName&)
 
+//!Marks a function that can be evaluated at compile time, functions with
+//!loops and more than one statement need C++14 so before that the macro is
+//!empty and the function is only evaluated at run time
+#if __cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+
+#   define UTIL_CONSTEXPR constexpr
+#else
+
+#   define UTIL_CONSTEXPR
+#endif
+
 #endif
\ No newline at end of file
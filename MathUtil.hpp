@@ -6,9 +6,21 @@
 #ifndef UTILITIES_MATHUTILS_H_
 #   define UTILITIES_MATHUTILS_H_
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <stdint.h>
 #include <stdlib.h>
 #include <math.h>
+#include <vector>
+
+#include "SimdUtil.hpp"
+
+//pdep and pext are only available to 64 bit x86 builds
+#if defined(UTIL_SIMD_DISPATCH) && (defined(__x86_64__) || defined(_M_X64))
+
+#   define UTIL_MATH_PDEP
+#endif
 
 namespace util { namespace math {
 
@@ -174,6 +186,645 @@ inline void decomposeDMC(unsigned dmc, unsigned& a, unsigned& b) {
     b = (b ^ (b >> 4)) & 0x00ff00ff;
     b = (b ^ (b >> 8)) & 0x0000ffff;
 }
+
+/*!Spreads the 32 bits of the value out to every second bit of the result*/
+inline uint64_t spreadBits2(uint32_t a) {
+
+    uint64_t r = a;
+    r = (r | (r << 16)) & 0x0000ffff0000ffffULL;
+    r = (r | (r << 8))  & 0x00ff00ff00ff00ffULL;
+    r = (r | (r << 4))  & 0x0f0f0f0f0f0f0f0fULL;
+    r = (r | (r << 2))  & 0x3333333333333333ULL;
+    r = (r | (r << 1))  & 0x5555555555555555ULL;
+
+    return r;
+}
+
+/*!Gathers every second bit of the value, the inverse of spreadBits2()*/
+inline uint32_t compactBits2(uint64_t a) {
+
+    a &= 0x5555555555555555ULL;
+    a = (a ^ (a >> 1))  & 0x3333333333333333ULL;
+    a = (a ^ (a >> 2))  & 0x0f0f0f0f0f0f0f0fULL;
+    a = (a ^ (a >> 4))  & 0x00ff00ff00ff00ffULL;
+    a = (a ^ (a >> 8))  & 0x0000ffff0000ffffULL;
+    a = (a ^ (a >> 16)) & 0x00000000ffffffffULL;
+
+    return static_cast<uint32_t>(a);
+}
+
+/*!Spreads the low 21 bits of the value out to every third bit of the result*/
+inline uint64_t spreadBits3(uint32_t a) {
+
+    uint64_t r = a & 0x1fffff;
+    r = (r | (r << 32)) & 0x001f00000000ffffULL;
+    r = (r | (r << 16)) & 0x001f0000ff0000ffULL;
+    r = (r | (r << 8))  & 0x100f00f00f00f00fULL;
+    r = (r | (r << 4))  & 0x10c30c30c30c30c3ULL;
+    r = (r | (r << 2))  & 0x1249249249249249ULL;
+
+    return r;
+}
+
+/*!Gathers every third bit of the value, the inverse of spreadBits3()*/
+inline uint32_t compactBits3(uint64_t a) {
+
+    a &= 0x1249249249249249ULL;
+    a = (a ^ (a >> 2))  & 0x10c30c30c30c30c3ULL;
+    a = (a ^ (a >> 4))  & 0x100f00f00f00f00fULL;
+    a = (a ^ (a >> 8))  & 0x001f0000ff0000ffULL;
+    a = (a ^ (a >> 16)) & 0x001f00000000ffffULL;
+    a = (a ^ (a >> 32)) & 0x00000000001fffffULL;
+
+    return static_cast<uint32_t>(a);
+}
+
+/*!Returns a 64 bit morton code from the two given 32 bit integers by
+interleaving their bits, a takes the even bits and b the odd bits*/
+inline uint64_t computeDMC64(uint32_t a, uint32_t b) {
+
+#if defined(UTIL_MATH_PDEP) && defined(__BMI2__)
+
+    return _pdep_u64(a, 0x5555555555555555ULL) |
+           _pdep_u64(b, 0xaaaaaaaaaaaaaaaaULL);
+#else
+
+    return spreadBits2(a) | (spreadBits2(b) << 1);
+#endif
+}
+
+/*!Decomposes the given 64 bit morton code and places the 2 indexes into
+variables a and b*/
+inline void decomposeDMC64(uint64_t dmc, uint32_t& a, uint32_t& b) {
+
+#if defined(UTIL_MATH_PDEP) && defined(__BMI2__)
+
+    a = static_cast<uint32_t>(_pext_u64(dmc, 0x5555555555555555ULL));
+    b = static_cast<uint32_t>(_pext_u64(dmc, 0xaaaaaaaaaaaaaaaaULL));
+#else
+
+    a = compactBits2(dmc);
+    b = compactBits2(dmc >> 1);
+#endif
+}
+
+/*!Returns a 3D morton code from the three given integers by interleaving the
+low 21 bits of each, a takes bits 0, 3, 6... b takes bits 1, 4, 7... and c
+takes bits 2, 5, 8...*/
+inline uint64_t computeDMC3(uint32_t a, uint32_t b, uint32_t c) {
+
+#if defined(UTIL_MATH_PDEP) && defined(__BMI2__)
+
+    return _pdep_u64(a, 0x1249249249249249ULL) |
+           _pdep_u64(b, 0x2492492492492492ULL) |
+           _pdep_u64(c, 0x4924924924924924ULL);
+#else
+
+    return spreadBits3(a) | (spreadBits3(b) << 1) | (spreadBits3(c) << 2);
+#endif
+}
+
+/*!Decomposes the given 3D morton code and places the 3 indexes into
+variables a, b and c*/
+inline void decomposeDMC3(uint64_t dmc, uint32_t& a, uint32_t& b,
+    uint32_t& c) {
+
+#if defined(UTIL_MATH_PDEP) && defined(__BMI2__)
+
+    a = static_cast<uint32_t>(_pext_u64(dmc, 0x1249249249249249ULL));
+    b = static_cast<uint32_t>(_pext_u64(dmc, 0x2492492492492492ULL));
+    c = static_cast<uint32_t>(_pext_u64(dmc, 0x4924924924924924ULL));
+#else
+
+    a = compactBits3(dmc);
+    b = compactBits3(dmc >> 1);
+    c = compactBits3(dmc >> 2);
+#endif
+}
+
+#if defined(UTIL_MATH_PDEP)
+
+/*!Computes 64 bit morton codes with pdep, see computeDMC64()*/
+UTIL_SIMD_TARGET("bmi2")
+inline void computeDMC64Bmi2(const uint32_t* a, const uint32_t* b,
+    uint64_t* out, unsigned count) {
+
+    for (unsigned i = 0; i < count; ++i) {
+
+        out[i] = _pdep_u64(a[i], 0x5555555555555555ULL) |
+                 _pdep_u64(b[i], 0xaaaaaaaaaaaaaaaaULL);
+    }
+}
+
+/*!Decomposes 64 bit morton codes with pext, see decomposeDMC64()*/
+UTIL_SIMD_TARGET("bmi2")
+inline void decomposeDMC64Bmi2(const uint64_t* dmc, uint32_t* a, uint32_t* b,
+    unsigned count) {
+
+    for (unsigned i = 0; i < count; ++i) {
+
+        a[i] = static_cast<uint32_t>(_pext_u64(dmc[i], 0x5555555555555555ULL));
+        b[i] = static_cast<uint32_t>(_pext_u64(dmc[i], 0xaaaaaaaaaaaaaaaaULL));
+    }
+}
+
+/*!Computes 3D morton codes with pdep, see computeDMC3()*/
+UTIL_SIMD_TARGET("bmi2")
+inline void computeDMC3Bmi2(const uint32_t* a, const uint32_t* b,
+    const uint32_t* c, uint64_t* out, unsigned count) {
+
+    for (unsigned i = 0; i < count; ++i) {
+
+        out[i] = _pdep_u64(a[i], 0x1249249249249249ULL) |
+                 _pdep_u64(b[i], 0x2492492492492492ULL) |
+                 _pdep_u64(c[i], 0x4924924924924924ULL);
+    }
+}
+
+/*!Decomposes 3D morton codes with pext, see decomposeDMC3()*/
+UTIL_SIMD_TARGET("bmi2")
+inline void decomposeDMC3Bmi2(const uint64_t* dmc, uint32_t* a, uint32_t* b,
+    uint32_t* c, unsigned count) {
+
+    for (unsigned i = 0; i < count; ++i) {
+
+        a[i] = static_cast<uint32_t>(_pext_u64(dmc[i], 0x1249249249249249ULL));
+        b[i] = static_cast<uint32_t>(_pext_u64(dmc[i], 0x2492492492492492ULL));
+        c[i] = static_cast<uint32_t>(_pext_u64(dmc[i], 0x4924924924924924ULL));
+    }
+}
+#endif
+
+/*!Computes the 64 bit morton code of each pair of values, pdep is used when
+the processor supports BMI2
+@a the values that take the even bits
+@b the values that take the odd bits
+@out must have room for count codes
+@count the number of codes to compute*/
+inline void computeDMC64(const uint32_t* a, const uint32_t* b, uint64_t* out,
+    unsigned count) {
+
+#if defined(UTIL_MATH_PDEP)
+
+    if (util::simd::hasBmi2()) {
+
+        computeDMC64Bmi2(a, b, out, count);
+        return;
+    }
+#endif
+
+    for (unsigned i = 0; i < count; ++i) {
+
+        out[i] = spreadBits2(a[i]) | (spreadBits2(b[i]) << 1);
+    }
+}
+
+/*!Decomposes each 64 bit morton code into its pair of values, pext is used
+when the processor supports BMI2
+@dmc the codes to decompose
+@a must have room for count values, receives the even bits
+@b must have room for count values, receives the odd bits
+@count the number of codes to decompose*/
+inline void decomposeDMC64(const uint64_t* dmc, uint32_t* a, uint32_t* b,
+    unsigned count) {
+
+#if defined(UTIL_MATH_PDEP)
+
+    if (util::simd::hasBmi2()) {
+
+        decomposeDMC64Bmi2(dmc, a, b, count);
+        return;
+    }
+#endif
+
+    for (unsigned i = 0; i < count; ++i) {
+
+        a[i] = compactBits2(dmc[i]);
+        b[i] = compactBits2(dmc[i] >> 1);
+    }
+}
+
+/*!Computes the 3D morton code of each group of three values, pdep is used
+when the processor supports BMI2
+@a the values that take bits 0, 3, 6...
+@b the values that take bits 1, 4, 7...
+@c the values that take bits 2, 5, 8...
+@out must have room for count codes
+@count the number of codes to compute*/
+inline void computeDMC3(const uint32_t* a, const uint32_t* b,
+    const uint32_t* c, uint64_t* out, unsigned count) {
+
+#if defined(UTIL_MATH_PDEP)
+
+    if (util::simd::hasBmi2()) {
+
+        computeDMC3Bmi2(a, b, c, out, count);
+        return;
+    }
+#endif
+
+    for (unsigned i = 0; i < count; ++i) {
+
+        out[i] = spreadBits3(a[i]) | (spreadBits3(b[i]) << 1) |
+                 (spreadBits3(c[i]) << 2);
+    }
+}
+
+/*!Decomposes each 3D morton code into its three values, pext is used when
+the processor supports BMI2
+@dmc the codes to decompose
+@a must have room for count values, receives bits 0, 3, 6...
+@b must have room for count values, receives bits 1, 4, 7...
+@c must have room for count values, receives bits 2, 5, 8...
+@count the number of codes to decompose*/
+inline void decomposeDMC3(const uint64_t* dmc, uint32_t* a, uint32_t* b,
+    uint32_t* c, unsigned count) {
+
+#if defined(UTIL_MATH_PDEP)
+
+    if (util::simd::hasBmi2()) {
+
+        decomposeDMC3Bmi2(dmc, a, b, c, count);
+        return;
+    }
+#endif
+
+    for (unsigned i = 0; i < count; ++i) {
+
+        a[i] = compactBits3(dmc[i]);
+        b[i] = compactBits3(dmc[i] >> 1);
+        c[i] = compactBits3(dmc[i] >> 2);
+    }
+}
+
+/*!Prefix xor of the bits of a from the most significant bit down*/
+inline uint32_t prefixXor(uint32_t a) {
+
+    a ^= a >> 16;
+    a ^= a >> 8;
+    a ^= a >> 4;
+    a ^= a >> 2;
+    a ^= a >> 1;
+    return a;
+}
+
+/*!Returns the 64 bit index of the two given 32 bit integers along a 2D
+Hilbert curve, unlike a morton code consecutive indices are always adjacent
+cells so ranges of indices cover compact areas. The rotation of every level
+is resolved at once by a parallel prefix scan over the bits rather than a loop
+over the levels*/
+inline uint64_t computeHilbert2(uint32_t a, uint32_t b) {
+
+    const uint32_t ones = 0xFFFFFFFF;
+
+    //the first round of the scan is primed from the coordinates
+    uint32_t pa = a ^ b;
+    uint32_t pb = ones ^ pa;
+    uint32_t pc = ones ^ (a | b);
+    uint32_t pd = a & (b ^ ones);
+
+    uint32_t sa = pa | (pb >> 1);
+    uint32_t sb = (pa >> 1) ^ pa;
+    uint32_t sc = ((pc >> 1) ^ (pb & (pd >> 1))) ^ pc;
+    uint32_t sd = ((pa & (pc >> 1)) ^ (pd >> 1)) ^ pd;
+
+    for (unsigned shift = 2; shift < 32; shift <<= 1) {
+
+        pa = sa;
+        pb = sb;
+        pc = sc;
+        pd = sd;
+
+        sc ^= (pa & (pc >> shift)) ^ (pb & (pd >> shift));
+        sd ^= (pb & (pc >> shift)) ^ ((pa ^ pb) & (pd >> shift));
+
+        //the last round only needs the transform
+        if (shift < 16) {
+
+            sa = (pa & (pa >> shift)) ^ (pb & (pb >> shift));
+            sb = (pa & (pb >> shift)) ^ (pb & ((pa ^ pb) >> shift));
+        }
+    }
+
+    //undo the prefix scan of the transform and recover the index bits
+    uint32_t ta = sc ^ (sc >> 1);
+    uint32_t tb = sd ^ (sd >> 1);
+    uint32_t low = a ^ b;
+    uint32_t high = tb | (ones ^ (low | ta));
+
+    return (spreadBits2(high) << 1) | spreadBits2(low);
+}
+
+/*!Decomposes the given 2D Hilbert index and places the 2 coordinates into
+variables a and b*/
+inline void decomposeHilbert2(uint64_t index, uint32_t& a, uint32_t& b) {
+
+    uint32_t low = compactBits2(index);
+    uint32_t high = compactBits2(index >> 1);
+
+    uint32_t swapped = prefixXor(~(low | high));
+    uint32_t inverted = prefixXor(low & high);
+    uint32_t t = (~low & inverted) | (low & swapped);
+
+    a = t ^ high;
+    b = t ^ low ^ high;
+}
+
+/*!@return the table that walks a 3D morton code along the Hilbert curve,
+indexed by orientation * 8 + octant each entry is the next orientation * 8 +
+the digit of the octant along the curve. The curve has 24 orientations*/
+inline const uint8_t* hilbert3EncodeTable() {
+
+    static const uint8_t table[192] = {
+     96, 137, 187,   2,  79, 134,  60,   5,
+     10,  13, 153, 174,  43,  20, 120, 167,
+     12,  21,  95, 142, 147,  18, 176, 129,
+      0, 123,  23,  84,  57,  26, 150,  29,
+    118,  63,  41, 144,  37,  92,  34,  99,
+     42,  11,  33,  88,  45, 148,  70, 183,
+    164, 119, 107,  40,  53,  62,  50, 145,
+     80, 111, 115,   4,  25,  54,  58,  61,
+     66, 179,  69,  76, 113, 184,  46,  15,
+     68, 131,  77,  74, 159, 168,  86, 105,
+    136, 155,  97,  82, 135,  28,  78,  85,
+    126, 161,  31,  48,  93,  90,  36, 139,
+     24,  55,  81, 110,  35, 140,  98, 101,
+    172,  39, 109, 102,  51,  64, 106,  73,
+     38, 103, 117, 188,  65,  72, 114,  59,
+     94, 125, 143, 156, 177, 122, 128,  27,
+    180, 133,  75, 130, 191,   6,   8,  17,
+     56,   1, 151,  22,  91, 138, 100, 141,
+     44,  19, 127, 160, 149, 146,  30,  49,
+    190, 157,   9, 154,   7, 124,  16,  83,
+    162,  89, 171,  32, 165, 182,  52,  71,
+    170, 185, 173,  14, 163, 112, 108,  47,
+    178, 181,  67, 132, 121, 166, 152, 175,
+    158, 169, 189, 186,  87, 104, 116,   3
+    };
+    return table;
+}
+
+/*!@return the inverse of hilbert3EncodeTable(), indexed by orientation * 8 +
+digit each entry is the next orientation * 8 + the octant of the digit*/
+inline const uint8_t* hilbert3DecodeTable() {
+
+    static const uint8_t table[192] = {
+     96, 137,   3, 186,  62,   7, 133,  76,
+    126, 154,   8,  44,  21,   9, 171, 167,
+    182, 135,  21, 148,   8,  17, 139,  90,
+      0,  60,  29, 121,  83,  31, 150,  18,
+    147,  42,  38, 103,  93,  36, 112,  57,
+     91,  34,  40,   9, 149,  44,  70, 183,
+     43, 151,  54, 106, 160,  52,  61, 113,
+     80,  28,  62, 114,   3,  63,  53, 105,
+    189, 116,  64, 177,  75,  66,  46,  15,
+    173, 111,  75, 129,  64,  74,  86, 156,
+    136,  98,  83, 153,  29,  87,  78, 132,
+     51, 161,  93, 143,  38,  92, 120,  26,
+     24,  82, 102,  36, 141, 103, 107,  49,
+     69,  79, 110,  52, 168, 106,  99,  33,
+     77,  68, 118,  63, 187, 114,  32,  97,
+    134, 180, 125,  31, 155, 121,  88, 138,
+     14,  23, 131,  74, 176, 129,   5, 188,
+     56,   1, 141,  92, 102, 143,  19, 146,
+    163,  55, 149,  17,  40, 148,  30, 122,
+     22,  10, 155,  87, 125, 153, 184,   4,
+     35,  89, 160, 170,  54, 164, 181,  71,
+    117, 185, 168, 164, 110, 170,  11,  47,
+    158, 124, 176,  66, 131, 177, 165, 175,
+    109, 169, 187,   7, 118, 186, 152,  84
+    };
+    return table;
+}
+
+/*!Walks N codes from their top 3 bits down through an orientation table,
+replacing each 3 bit digit with the table's. The codes are walked in lock step
+so that their lookups overlap
+@table hilbert3EncodeTable() or hilbert3DecodeTable()
+@codes the N codes to walk in place*/
+template <unsigned N>
+inline void walkHilbert3(const uint8_t* table, uint64_t* codes) {
+
+    uint64_t walked[N];
+    unsigned state[N];
+    for (unsigned i = 0; i < N; ++i) {
+
+        walked[i] = 0;
+        state[i] = 0;
+    }
+
+    for (int shift = 60; shift >= 0; shift -= 3) {
+
+        for (unsigned i = 0; i < N; ++i) {
+
+            unsigned entry = table[state[i] + ((codes[i] >> shift) & 7)];
+            walked[i] = (walked[i] << 3) | (entry & 7);
+            state[i] = entry & ~7u;
+        }
+    }
+
+    for (unsigned i = 0; i < N; ++i) {
+
+        codes[i] = walked[i];
+    }
+}
+
+/*!Returns the 3D Hilbert index of the three given integers, only the low 21
+bits of each are used. The octants of each level are read from the morton code
+of the integers and walked along the curve a level at a time with a table of
+the curve's orientations*/
+inline uint64_t computeHilbert3(uint32_t a, uint32_t b, uint32_t c) {
+
+    uint64_t index = computeDMC3(c, b, a);
+    walkHilbert3<1>(hilbert3EncodeTable(), &index);
+    return index;
+}
+
+/*!Decomposes the given 3D Hilbert index and places the 3 coordinates into
+variables a, b and c*/
+inline void decomposeHilbert3(uint64_t index, uint32_t& a, uint32_t& b,
+    uint32_t& c) {
+
+    walkHilbert3<1>(hilbert3DecodeTable(), &index);
+    decomposeDMC3(index, c, b, a);
+}
+
+/*!Computes the 2D Hilbert index of each pair of values
+@a the first coordinates
+@b the second coordinates
+@out must have room for count indices
+@count the number of indices to compute*/
+inline void computeHilbert2(const uint32_t* a, const uint32_t* b,
+    uint64_t* out, unsigned count) {
+
+    for (unsigned i = 0; i < count; ++i) {
+
+        out[i] = computeHilbert2(a[i], b[i]);
+    }
+}
+
+/*!Decomposes each 2D Hilbert index into its pair of coordinates
+@index the indices to decompose
+@a must have room for count values, receives the first coordinates
+@b must have room for count values, receives the second coordinates
+@count the number of indices to decompose*/
+inline void decomposeHilbert2(const uint64_t* index, uint32_t* a, uint32_t* b,
+    unsigned count) {
+
+    for (unsigned i = 0; i < count; ++i) {
+
+        decomposeHilbert2(index[i], a[i], b[i]);
+    }
+}
+
+/*!Computes the 3D Hilbert index of each group of three values, the morton
+codes are computed first and then walked along the curve four at a time
+@a the first coordinates
+@b the second coordinates
+@c the third coordinates
+@out must have room for count indices
+@count the number of indices to compute*/
+inline void computeHilbert3(const uint32_t* a, const uint32_t* b,
+    const uint32_t* c, uint64_t* out, unsigned count) {
+
+    computeDMC3(c, b, a, out, count);
+
+    const uint8_t* table = hilbert3EncodeTable();
+    unsigned i = 0;
+    for (; i + 4 <= count; i += 4) {
+
+        walkHilbert3<4>(table, out + i);
+    }
+    for (; i < count; ++i) {
+
+        walkHilbert3<1>(table, out + i);
+    }
+}
+
+/*!Decomposes each 3D Hilbert index into its three coordinates, the indices
+are walked back to morton codes four at a time
+@index the indices to decompose
+@a must have room for count values, receives the first coordinates
+@b must have room for count values, receives the second coordinates
+@c must have room for count values, receives the third coordinates
+@count the number of indices to decompose*/
+inline void decomposeHilbert3(const uint64_t* index, uint32_t* a, uint32_t* b,
+    uint32_t* c, unsigned count) {
+
+    const uint8_t* table = hilbert3DecodeTable();
+    for (unsigned i = 0; i < count; i += 4) {
+
+        uint64_t dmc[4];
+        unsigned n = std::min(count - i, 4u);
+        std::copy(index + i, index + i + n, dmc);
+        if (n == 4) {
+
+            walkHilbert3<4>(table, dmc);
+        }
+        else {
+
+            for (unsigned j = 0; j < n; ++j) {
+
+                walkHilbert3<1>(table, dmc + j);
+            }
+        }
+        decomposeDMC3(dmc, c + i, b + i, a + i, n);
+    }
+}
+
+/*!Sorts morton codes into ascending order with a stable least significant
+digit radix sort of 11 bits per pass. Passes over digits that are the same in
+every code are skipped, so codes that only use their low bits sort in fewer
+passes
+@codes the codes to sort
+@values may be NULL, otherwise the values are moved with their codes, such as
+the indices of the points the codes were computed from
+@count the number of codes*/
+inline void radixSortDMC(uint64_t* codes, uint32_t* values, unsigned count) {
+
+    const unsigned BITS = 11;
+    const unsigned DIGITS = 1 << BITS;
+    const unsigned PASSES = (64 + BITS - 1) / BITS;
+
+    if (count < 2) {
+
+        return;
+    }
+
+    //count every digit of every code in a single read
+    std::vector<unsigned> histograms(PASSES * DIGITS, 0);
+    unsigned* h = &histograms[0];
+    for (unsigned i = 0; i < count; ++i) {
+
+        uint64_t code = codes[i];
+        for (unsigned pass = 0; pass < PASSES; ++pass) {
+
+            ++h[(pass * DIGITS) + ((code >> (pass * BITS)) & (DIGITS - 1))];
+        }
+    }
+
+    std::vector<uint64_t> codeBuffer(count);
+    std::vector<uint32_t> valueBuffer(values != NULL ? count : 0);
+
+    uint64_t* codesIn = codes;
+    uint64_t* codesOut = &codeBuffer[0];
+    uint32_t* valuesIn = values;
+    uint32_t* valuesOut = values != NULL ? &valueBuffer[0] : NULL;
+
+    for (unsigned pass = 0; pass < PASSES; ++pass) {
+
+        unsigned* histogram = h + (pass * DIGITS);
+        unsigned shift = pass * BITS;
+
+        //every code has the same digit so the order would not change
+        if (histogram[(codesIn[0] >> shift) & (DIGITS - 1)] == count) {
+
+            continue;
+        }
+
+        //turn the counts into the offset each digit starts at
+        unsigned offset = 0;
+        for (unsigned digit = 0; digit < DIGITS; ++digit) {
+
+            unsigned digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        if (valuesIn != NULL) {
+
+            for (unsigned i = 0; i < count; ++i) {
+
+                uint64_t code = codesIn[i];
+                unsigned slot = histogram[(code >> shift) & (DIGITS - 1)]++;
+                codesOut[slot] = code;
+                valuesOut[slot] = valuesIn[i];
+            }
+        }
+        else {
+
+            for (unsigned i = 0; i < count; ++i) {
+
+                uint64_t code = codesIn[i];
+                codesOut[histogram[(code >> shift) & (DIGITS - 1)]++] = code;
+            }
+        }
+
+        std::swap(codesIn, codesOut);
+        std::swap(valuesIn, valuesOut);
+    }
+
+    //an odd number of passes leaves the result in the buffers
+    if (codesIn != codes) {
+
+        std::copy(codesIn, codesIn + count, codes);
+        if (values != NULL) {
+
+            std::copy(valuesIn, valuesIn + count, values);
+        }
+    }
+}
+
 }} //util //math
 
 #endif
\ No newline at end of file
@@ -0,0 +1,746 @@
+/******************************************\
+| Portable 4 wide floating point SIMD ops. |
+|                                          |
+| @author David Saxon                      |
+\******************************************/
+#ifndef UTILITIES_SIMDUTIL_H_
+#   define UTILITIES_SIMDUTIL_H_
+
+#include <cmath>
+#include <cstring>
+
+//select the instruction set the vector types are built on, define
+//UTIL_NO_SIMD before including to force the scalar fallback
+#if !defined(UTIL_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+
+#   define UTIL_SIMD_SSE
+#   include <xmmintrin.h>
+
+//256 bit registers are used where a kernel can fill them
+#   if defined(__AVX__)
+
+#       define UTIL_SIMD_AVX
+#       include <immintrin.h>
+#   endif
+
+#elif !defined(UTIL_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+
+#   define UTIL_SIMD_NEON
+#   include <arm_neon.h>
+#endif
+
+//aligns the following declaration to the width of a SIMD register
+#if defined(_MSC_VER)
+
+#   define UTIL_SIMD_ALIGN __declspec(align(16))
+#else
+
+#   define UTIL_SIMD_ALIGN __attribute__((aligned(16)))
+#endif
+
+//x86 builds also carry wider kernels that are chosen at run time from the
+//instructions the processor supports, see level(). UTIL_SIMD_TARGET enables
+//an instruction set for a single function without building the whole binary
+//for it
+#if defined(UTIL_SIMD_SSE) && !defined(UTIL_NO_SIMD_DISPATCH) && \
+    (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86))
+
+#   if defined(_MSC_VER) && !defined(__clang__)
+
+#       define UTIL_SIMD_DISPATCH
+#       define UTIL_SIMD_TARGET(isa)
+#       include <intrin.h>
+#       include <immintrin.h>
+#   elif defined(__GNUC__) && (__GNUC__ > 4 || \
+        (__GNUC__ == 4 && __GNUC_MINOR__ >= 9) || defined(__clang__))
+
+#       define UTIL_SIMD_DISPATCH
+#       define UTIL_SIMD_TARGET(isa) __attribute__((target(isa)))
+#       include <cpuid.h>
+#       include <immintrin.h>
+#   endif
+#endif
+
+namespace util { namespace simd {
+
+//TYPEDEFS
+#if defined(UTIL_SIMD_SSE)
+
+//!A register of four floats
+typedef __m128 Float4;
+#elif defined(UTIL_SIMD_NEON)
+
+//!A register of four floats
+typedef float32x4_t Float4;
+#else
+
+//!Four floats operated on one at a time when there is no SIMD support
+struct Float4 {
+
+    float v[4];
+};
+#endif
+
+//FUNCTIONS
+/*!Loads four floats into a register, the memory does not need to be aligned
+@_p the four floats to load
+@return the register*/
+inline Float4 load(const float* _p) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_loadu_ps(_p);
+#elif defined(UTIL_SIMD_NEON)
+
+    return vld1q_f32(_p);
+#else
+
+    Float4 r = {{_p[0], _p[1], _p[2], _p[3]}};
+    return r;
+#endif
+}
+
+/*!Stores the register into four floats, the memory does not need to be
+aligned
+@_p the memory to write to
+@_a the register to store*/
+inline void store(float* _p, Float4 _a) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    _mm_storeu_ps(_p, _a);
+#elif defined(UTIL_SIMD_NEON)
+
+    vst1q_f32(_p, _a);
+#else
+
+    _p[0] = _a.v[0];
+    _p[1] = _a.v[1];
+    _p[2] = _a.v[2];
+    _p[3] = _a.v[3];
+#endif
+}
+
+/*!@return a register with the four given values*/
+inline Float4 set(float _x, float _y, float _z, float _w) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_setr_ps(_x, _y, _z, _w);
+#else
+
+    const float p[4] = {_x, _y, _z, _w};
+    return load(p);
+#endif
+}
+
+/*!@return a register with all four values set to the scalar*/
+inline Float4 splat(float _scalar) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_set1_ps(_scalar);
+#elif defined(UTIL_SIMD_NEON)
+
+    return vdupq_n_f32(_scalar);
+#else
+
+    Float4 r = {{_scalar, _scalar, _scalar, _scalar}};
+    return r;
+#endif
+}
+
+/*!@return a register with all four values set to the value in the given
+lane of the other register*/
+template <int Lane>
+inline Float4 splatLane(Float4 _a) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_shuffle_ps(_a, _a, _MM_SHUFFLE(Lane, Lane, Lane, Lane));
+#elif defined(UTIL_SIMD_NEON) && defined(__aarch64__)
+
+    return vdupq_laneq_f32(_a, Lane);
+#elif defined(UTIL_SIMD_NEON)
+
+    return vdupq_n_f32(vgetq_lane_f32(_a, Lane));
+#else
+
+    return splat(_a.v[Lane]);
+#endif
+}
+
+/*!@return the register with the sign of every value flipped*/
+inline Float4 negate(Float4 _a) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_xor_ps(_a, _mm_set1_ps(-0.0f));
+#elif defined(UTIL_SIMD_NEON)
+
+    return vnegq_f32(_a);
+#else
+
+    Float4 r = {{-_a.v[0], -_a.v[1], -_a.v[2], -_a.v[3]}};
+    return r;
+#endif
+}
+
+/*!@return a register holding only the sign bits of the given register*/
+inline Float4 signBits(Float4 _a) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_and_ps(_a, _mm_set1_ps(-0.0f));
+#elif defined(UTIL_SIMD_NEON)
+
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(_a),
+        vdupq_n_u32(0x80000000)));
+#else
+
+    Float4 r;
+    for (unsigned i = 0; i < 4; ++i) {
+
+        unsigned bits;
+        std::memcpy(&bits, &_a.v[i], sizeof(bits));
+        bits &= 0x80000000;
+        std::memcpy(&r.v[i], &bits, sizeof(bits));
+    }
+    return r;
+#endif
+}
+
+/*!Flips the sign of the values in the first register wherever the sign bit
+is set in the second register
+@_a the values to flip
+@_signs the sign bits to flip by, see signBits()
+@return the flipped values*/
+inline Float4 flipSign(Float4 _a, Float4 _signs) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_xor_ps(_a, _signs);
+#elif defined(UTIL_SIMD_NEON)
+
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(_a),
+        vreinterpretq_u32_f32(_signs)));
+#else
+
+    Float4 r;
+    for (unsigned i = 0; i < 4; ++i) {
+
+        unsigned bits;
+        unsigned signs;
+        std::memcpy(&bits, &_a.v[i], sizeof(bits));
+        std::memcpy(&signs, &_signs.v[i], sizeof(signs));
+        bits ^= signs;
+        std::memcpy(&r.v[i], &bits, sizeof(bits));
+    }
+    return r;
+#endif
+}
+
+/*!@return the element wise addition of the two registers*/
+inline Float4 add(Float4 _a, Float4 _b) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_add_ps(_a, _b);
+#elif defined(UTIL_SIMD_NEON)
+
+    return vaddq_f32(_a, _b);
+#else
+
+    Float4 r = {{_a.v[0] + _b.v[0], _a.v[1] + _b.v[1],
+        _a.v[2] + _b.v[2], _a.v[3] + _b.v[3]}};
+    return r;
+#endif
+}
+
+/*!@return the element wise subtraction of the two registers*/
+inline Float4 sub(Float4 _a, Float4 _b) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_sub_ps(_a, _b);
+#elif defined(UTIL_SIMD_NEON)
+
+    return vsubq_f32(_a, _b);
+#else
+
+    Float4 r = {{_a.v[0] - _b.v[0], _a.v[1] - _b.v[1],
+        _a.v[2] - _b.v[2], _a.v[3] - _b.v[3]}};
+    return r;
+#endif
+}
+
+/*!@return the element wise multiplication of the two registers*/
+inline Float4 mul(Float4 _a, Float4 _b) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_mul_ps(_a, _b);
+#elif defined(UTIL_SIMD_NEON)
+
+    return vmulq_f32(_a, _b);
+#else
+
+    Float4 r = {{_a.v[0] * _b.v[0], _a.v[1] * _b.v[1],
+        _a.v[2] * _b.v[2], _a.v[3] * _b.v[3]}};
+    return r;
+#endif
+}
+
+/*!@return the element wise division of the two registers*/
+inline Float4 div(Float4 _a, Float4 _b) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_div_ps(_a, _b);
+#elif defined(UTIL_SIMD_NEON) && defined(__aarch64__)
+
+    return vdivq_f32(_a, _b);
+#else
+
+    //without an exact SIMD division each element is divided on its own
+    float a[4];
+    float b[4];
+    store(a, _a);
+    store(b, _b);
+
+    return set(a[0] / b[0], a[1] / b[1], a[2] / b[2], a[3] / b[3]);
+#endif
+}
+
+/*!@return the element wise minimum of the two registers*/
+inline Float4 min(Float4 _a, Float4 _b) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_min_ps(_a, _b);
+#elif defined(UTIL_SIMD_NEON)
+
+    return vminq_f32(_a, _b);
+#else
+
+    Float4 r;
+    for (unsigned i = 0; i < 4; ++i) {
+
+        r.v[i] = _b.v[i] < _a.v[i] ? _b.v[i] : _a.v[i];
+    }
+    return r;
+#endif
+}
+
+/*!@return the element wise maximum of the two registers*/
+inline Float4 max(Float4 _a, Float4 _b) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_max_ps(_a, _b);
+#elif defined(UTIL_SIMD_NEON)
+
+    return vmaxq_f32(_a, _b);
+#else
+
+    Float4 r;
+    for (unsigned i = 0; i < 4; ++i) {
+
+        r.v[i] = _b.v[i] > _a.v[i] ? _b.v[i] : _a.v[i];
+    }
+    return r;
+#endif
+}
+
+/*!@return the element wise square root of the register*/
+inline Float4 sqrt(Float4 _a) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return _mm_sqrt_ps(_a);
+#elif defined(UTIL_SIMD_NEON) && defined(__aarch64__)
+
+    return vsqrtq_f32(_a);
+#else
+
+    float a[4];
+    store(a, _a);
+
+    return set(std::sqrt(a[0]), std::sqrt(a[1]), std::sqrt(a[2]),
+        std::sqrt(a[3]));
+#endif
+}
+
+/*!Approximates the element wise reciprocal square root of the register, the
+hardware estimate is refined with one Newton-Raphson step which gives about 22
+bits of precision
+@_a the register, every value must be greater than zero
+@return the approximate reciprocal square roots*/
+inline Float4 rsqrt(Float4 _a) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    Float4 r = _mm_rsqrt_ps(_a);
+    Float4 rr = _mm_mul_ps(_mm_mul_ps(_a, r), r);
+
+    return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), r),
+        _mm_sub_ps(_mm_set1_ps(3.0f), rr));
+#elif defined(UTIL_SIMD_NEON)
+
+    Float4 r = vrsqrteq_f32(_a);
+
+    return vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(_a, r), r));
+#else
+
+    float a[4];
+    store(a, _a);
+
+    return set(1.0f / std::sqrt(a[0]), 1.0f / std::sqrt(a[1]),
+        1.0f / std::sqrt(a[2]), 1.0f / std::sqrt(a[3]));
+#endif
+}
+
+/*!Approximates the reciprocal square root of the scalar, the hardware estimate
+is refined with one Newton-Raphson step which gives about 22 bits of precision
+@_a the scalar, must be greater than zero
+@return the approximate reciprocal square root*/
+inline float rsqrt(float _a) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    float r = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(_a)));
+
+    return (0.5f * r) * (3.0f - ((_a * r) * r));
+#elif defined(UTIL_SIMD_NEON)
+
+    float32x2_t a = vdup_n_f32(_a);
+    float32x2_t r = vrsqrte_f32(a);
+    r = vmul_f32(r, vrsqrts_f32(vmul_f32(a, r), r));
+
+    return vget_lane_f32(r, 0);
+#else
+
+    return 1.0f / std::sqrt(_a);
+#endif
+}
+
+/*!Transposes the 4x4 matrix held in the four registers in place
+@_r0 the first row, becomes the first column
+@_r1 the second row, becomes the second column
+@_r2 the third row, becomes the third column
+@_r3 the fourth row, becomes the fourth column*/
+inline void transpose(Float4& _r0, Float4& _r1, Float4& _r2, Float4& _r3) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    _MM_TRANSPOSE4_PS(_r0, _r1, _r2, _r3);
+#elif defined(UTIL_SIMD_NEON)
+
+    float32x4x2_t t01 = vtrnq_f32(_r0, _r1);
+    float32x4x2_t t23 = vtrnq_f32(_r2, _r3);
+
+    _r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    _r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    _r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    _r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+#else
+
+    Float4 r[4] = {_r0, _r1, _r2, _r3};
+    for (unsigned i = 0; i < 4; ++i) {
+
+        _r0.v[i] = r[i].v[0];
+        _r1.v[i] = r[i].v[1];
+        _r2.v[i] = r[i].v[2];
+        _r3.v[i] = r[i].v[3];
+    }
+#endif
+}
+
+/*!@return the sum of the four values in the register*/
+inline float sum(Float4 _a) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    Float4 shuf = _mm_shuffle_ps(_a, _a, _MM_SHUFFLE(2, 3, 0, 1));
+    Float4 sums = _mm_add_ps(_a, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+
+    return _mm_cvtss_f32(sums);
+#elif defined(UTIL_SIMD_NEON) && defined(__aarch64__)
+
+    return vaddvq_f32(_a);
+#elif defined(UTIL_SIMD_NEON)
+
+    float32x2_t s = vadd_f32(vget_low_f32(_a), vget_high_f32(_a));
+    s = vpadd_f32(s, s);
+
+    return vget_lane_f32(s, 0);
+#else
+
+    return (_a.v[0] + _a.v[1]) + (_a.v[2] + _a.v[3]);
+#endif
+}
+
+/*!@return the dot product of the two registers*/
+inline float dot(Float4 _a, Float4 _b) {
+
+    return sum(mul(_a, _b));
+}
+
+/*!Compares the two registers element wise
+@return a mask with bit i set where element i of the first register is less
+than element i of the second*/
+inline unsigned lessThan(Float4 _a, Float4 _b) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_cmplt_ps(_a, _b)));
+#elif defined(UTIL_SIMD_NEON)
+
+    static const uint32_t lanes[4] = {1, 2, 4, 8};
+    uint32x4_t bits = vandq_u32(vcltq_f32(_a, _b), vld1q_u32(lanes));
+#   if defined(__aarch64__)
+
+    return vaddvq_u32(bits);
+#   else
+
+    uint32x2_t s = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    return vget_lane_u32(vpadd_u32(s, s), 0);
+#   endif
+#else
+
+    unsigned r = 0;
+    for (unsigned i = 0; i < 4; ++i) {
+
+        r |= static_cast<unsigned>(_a.v[i] < _b.v[i]) << i;
+    }
+    return r;
+#endif
+}
+
+/*!Picks each element from one of two registers
+@_lanes a mask with bit i set where element i should come from the first
+register, see lessThan()
+@_a the register to take the set lanes from
+@_b the register to take the other lanes from
+@return the picked elements*/
+inline Float4 select(unsigned _lanes, Float4 _a, Float4 _b) {
+
+#if defined(UTIL_SIMD_SSE)
+
+    __m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+    __m128 mask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(
+        _mm_set1_epi32(static_cast<int>(_lanes)), bits), bits));
+    return _mm_or_ps(_mm_and_ps(mask, _a), _mm_andnot_ps(mask, _b));
+#elif defined(UTIL_SIMD_NEON)
+
+    static const uint32_t lanes[4] = {1, 2, 4, 8};
+    uint32x4_t mask = vtstq_u32(vdupq_n_u32(_lanes), vld1q_u32(lanes));
+    return vbslq_f32(mask, _a, _b);
+#else
+
+    Float4 r;
+    for (unsigned i = 0; i < 4; ++i) {
+
+        r.v[i] = ((_lanes >> i) & 1) != 0 ? _a.v[i] : _b.v[i];
+    }
+    return r;
+#endif
+}
+
+namespace cpu {
+
+//ENUMERATORS
+//!The instruction sets kernels can be dispatched to, from the narrowest to the
+//!widest
+enum Level {
+
+    //!one float at a time
+    SCALAR = 0,
+    //!the 4 wide instruction set the build targets, SSE or NEON
+    SIMD4,
+    //!8 wide AVX2 with fused multiply add
+    AVX2,
+    //!16 wide AVX-512
+    AVX512
+};
+
+} //cpu
+
+/*!Queries the processor for the widest instruction set it and the operating
+system support
+@return the widest supported level*/
+inline cpu::Level detectLevel() {
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+    unsigned regs[4] = {0, 0, 0, 0};
+#   if defined(_MSC_VER) && !defined(__clang__)
+
+    int info[4];
+    __cpuidex(info, 0, 0);
+    unsigned maxLeaf = static_cast<unsigned>(info[0]);
+    __cpuidex(info, 1, 0);
+    regs[2] = static_cast<unsigned>(info[2]);
+#   else
+
+    unsigned maxLeaf = __get_cpuid_max(0, 0);
+    __cpuid_count(1, 0, regs[0], regs[1], regs[2], regs[3]);
+#   endif
+
+    //the wider registers are only usable once the operating system saves
+    //them on a context switch
+    bool osxsave = (regs[2] & (1u << 27)) != 0;
+    bool avx     = (regs[2] & (1u << 28)) != 0;
+    bool fma     = (regs[2] & (1u << 12)) != 0;
+    if (!osxsave || !avx || maxLeaf < 7) {
+
+        return cpu::SIMD4;
+    }
+
+    unsigned long long xcr0 = 0;
+#   if defined(_MSC_VER) && !defined(__clang__)
+
+    xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    regs[1] = static_cast<unsigned>(info[1]);
+#   else
+
+    unsigned lo = 0;
+    unsigned hi = 0;
+    __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    xcr0 = (static_cast<unsigned long long>(hi) << 32) | lo;
+    __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#   endif
+
+    bool ymm     = (xcr0 & 0x06) == 0x06;
+    bool zmm     = (xcr0 & 0xE6) == 0xE6;
+    bool avx2    = (regs[1] & (1u << 5)) != 0;
+    bool avx512f = (regs[1] & (1u << 16)) != 0;
+
+    if (zmm && avx512f && avx2 && fma) {
+
+        return cpu::AVX512;
+    }
+    if (ymm && avx2 && fma) {
+
+        return cpu::AVX2;
+    }
+    return cpu::SIMD4;
+#elif defined(UTIL_SIMD_SSE) || defined(UTIL_SIMD_NEON)
+
+    return cpu::SIMD4;
+#else
+
+    return cpu::SCALAR;
+#endif
+}
+
+/*!Queries the processor for the BMI2 bit manipulation instructions, such as
+pdep and pext
+@return whether BMI2 is supported*/
+inline bool detectBmi2() {
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+    unsigned regs[4] = {0, 0, 0, 0};
+#   if defined(_MSC_VER) && !defined(__clang__)
+
+    int info[4];
+    __cpuidex(info, 0, 0);
+    if (info[0] < 7) {
+
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    regs[1] = static_cast<unsigned>(info[1]);
+#   else
+
+    if (__get_cpuid_max(0, 0) < 7) {
+
+        return false;
+    }
+    __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#   endif
+
+    return (regs[1] & (1u << 8)) != 0;
+#else
+
+    return false;
+#endif
+}
+
+/*!Queries the processor for the F16C half precision conversion instructions
+@return whether F16C is supported*/
+inline bool detectF16c() {
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+    unsigned regs[4] = {0, 0, 0, 0};
+#   if defined(_MSC_VER) && !defined(__clang__)
+
+    int info[4];
+    __cpuidex(info, 1, 0);
+    regs[2] = static_cast<unsigned>(info[2]);
+#   else
+
+    __cpuid_count(1, 0, regs[0], regs[1], regs[2], regs[3]);
+#   endif
+
+    return (regs[2] & (1u << 29)) != 0;
+#else
+
+    return false;
+#endif
+}
+
+/*!@return the level setting shared by every kernel, detected the first time it
+is used*/
+inline cpu::Level& levelSetting() {
+
+    static cpu::Level setting = detectLevel();
+    return setting;
+}
+
+/*!@return the instruction set level the dispatched kernels currently use*/
+inline cpu::Level level() {
+
+    return levelSetting();
+}
+
+/*!Forces the dispatched kernels to a specific level so every path can be
+tested on one machine, the level is capped at the one the processor supports
+@_level the level to use
+@return the level that is now in use*/
+inline cpu::Level setLevel(cpu::Level _level) {
+
+    cpu::Level supported = detectLevel();
+    levelSetting() = _level < supported ? _level : supported;
+
+    return levelSetting();
+}
+
+/*!@return whether the BMI2 instructions can be used, false when the level has
+been forced to SCALAR*/
+inline bool hasBmi2() {
+
+    static bool supported = detectBmi2();
+    return supported && level() != cpu::SCALAR;
+}
+
+/*!@return whether the F16C instructions can be used, they are only used
+alongside AVX2 whose detection already checks that the operating system saves
+the wider registers, so this is false when the level has been forced below
+AVX2*/
+inline bool hasF16c() {
+
+    static bool supported = detectF16c();
+    return supported && level() >= cpu::AVX2;
+}
+
+}} //util //simd
+
+#endif
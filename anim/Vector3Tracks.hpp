@@ -0,0 +1,467 @@
+/***************************************\
+| Keyframed 3D vector animation tracks. |
+|                                       |
+| @author David Saxon                   |
+\***************************************/
+
+#ifndef UTILITIES_ANIM_VECTOR3TRACKS_H_
+#   define UTILITIES_ANIM_VECTOR3TRACKS_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "../SimdUtil.hpp"
+#include "../exceptions/ArrayException.hpp"
+#include "../exceptions/FunctionCallException.hpp"
+#include "../vector/Vector3.hpp"
+#include "../vector/Vector3Batch.hpp"
+
+namespace util { namespace anim {
+
+/**********************************************************************\
+| Holds many tracks of 3D vector keyframes that are linearly           |
+| interpolated. The keys of every track are stored one after the other |
+| as separate arrays of times and x, y and z values, along with the    |
+| change to the next key so sampling is one multiply add per element.  |
+| Each track remembers the key it was last sampled at and starts its   |
+| search there, so playback that moves forward a little each frame     |
+| rarely needs to search. Times before the first key or after the last |
+| key hold the value of that key.                                      |
+|                                                                      |
+| @author David Saxon                                                  |
+\**********************************************************************/
+class Vector3Tracks {
+public:
+
+    //CONSTRUCTORS
+    /*!Creates a new set with no tracks*/
+    Vector3Tracks() :
+        starts(1, 0) {
+    }
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!Adds a track
+    @_times the time of each key, must be in increasing order though keys may
+    share a time to make a jump
+    @_values the value of each key
+    @_count the number of keys, must be at least one
+    @return the index of the new track*/
+    unsigned add(const float* _times, const util::vec::Vector3* _values,
+        unsigned _count);
+
+    /*!Samples one track at one time
+    @_track the index of the track
+    @_time the time to sample at
+    @return the interpolated value*/
+    util::vec::Vector3 sample(unsigned _track, float _time);
+
+    /*!Samples every track at the same time
+    @_time the time to sample at
+    @_out is resized to the number of tracks and filled with the value of
+    each track
+    @_parallel whether the tracks are split across threads, only when built
+    with OpenMP*/
+    void sample(float _time, util::vec::Vector3Batch& _out,
+        bool _parallel = false);
+
+    /*!Samples one track at many times, times in increasing order are
+    quickest
+    @_track the index of the track
+    @_times the times to sample at
+    @_count the number of times
+    @_out is resized to _count and filled with the value at each time*/
+    void sample(unsigned _track, const float* _times, unsigned _count,
+        util::vec::Vector3Batch& _out);
+
+    /*!@return the number of tracks*/
+    unsigned size() const;
+
+    /*!@return the number of keys in the track*/
+    unsigned getKeyCount(unsigned _track) const;
+
+    /*!@return the times of the track's keys*/
+    const float* getTimes(unsigned _track) const;
+
+    /*!@return the value of a key of the track*/
+    util::vec::Vector3 getValue(unsigned _track, unsigned _key) const;
+
+    /*!Moves every track's remembered key back to its first key, for when
+    playback jumps*/
+    void resetCursors();
+
+    /*!Removes all tracks*/
+    void clear();
+
+private:
+
+    //VARIABLES
+    //the number of tracks sampled together by each thread
+    static const unsigned BLOCK_SIZE = 1024;
+
+    //the time and value of every key of every track
+    std::vector<float> times;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    //the change in value and the reciprocal of the change in time to the
+    //next key, zero for the last key of a track
+    std::vector<float> dx;
+    std::vector<float> dy;
+    std::vector<float> dz;
+    std::vector<float> inverseSpans;
+    //the first key of each track followed by the total number of keys
+    std::vector<unsigned> starts;
+    //the key each track was last sampled at
+    std::vector<unsigned> cursors;
+    //the key and how far past it each sample is, kept between samples to
+    //save allocating
+    std::vector<unsigned> sampleKeys;
+    std::vector<float> sampleFactors;
+
+    //PRIVATE MEMBER FUNCTIONS
+    /*!Finds the key a time falls after and updates the track's cursor
+    @_track the index of the track
+    @_time the time to find
+    @_factor receives how far the time is towards the next key
+    @return the index of the key in the key arrays*/
+    unsigned findKey(unsigned _track, float _time, float& _factor);
+
+    /*!Interpolates from the given keys
+    @_keys the index of the key for each output
+    @_factors how far towards the next key each output is
+    @_count the number of outputs
+    @_ox receives the x values
+    @_oy receives the y values
+    @_oz receives the z values*/
+    void interpolate(const unsigned* _keys, const float* _factors,
+        unsigned _count, float* _ox, float* _oy, float* _oz) const;
+
+    /*!Checks that the index is within the tracks*/
+    void checkTrack(unsigned _track) const;
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+    /*!Interpolates as many outputs as fit in groups of eight, see
+    interpolate()
+    @return the number of outputs done, the rest are left to the caller*/
+    UTIL_SIMD_TARGET("avx2,fma")
+    unsigned interpolateAvx2(const unsigned* _keys, const float* _factors,
+        unsigned _count, float* _ox, float* _oy, float* _oz) const;
+#endif
+};
+
+//INLINE
+//PUBLIC MEMBER FUNCTIONS
+inline unsigned Vector3Tracks::add(const float* _times,
+    const util::vec::Vector3* _values, unsigned _count) {
+
+    if (_count == 0) {
+
+        throw util::ex::IllegalArgumentException(
+            "a track must have at least one key.");
+    }
+    for (unsigned i = 1; i < _count; ++i) {
+
+        if (_times[i] < _times[i - 1]) {
+
+            throw util::ex::IllegalArgumentException(
+                "track keys must be in increasing time order.");
+        }
+    }
+
+    unsigned first = starts.back();
+    for (unsigned i = 0; i < _count; ++i) {
+
+        times.push_back(_times[i]);
+        x.push_back(_values[i].getX());
+        y.push_back(_values[i].getY());
+        z.push_back(_values[i].getZ());
+
+        //the last key has nothing to move towards
+        if (i + 1 == _count) {
+
+            dx.push_back(0.0f);
+            dy.push_back(0.0f);
+            dz.push_back(0.0f);
+            inverseSpans.push_back(0.0f);
+            continue;
+        }
+        dx.push_back(_values[i + 1].getX() - _values[i].getX());
+        dy.push_back(_values[i + 1].getY() - _values[i].getY());
+        dz.push_back(_values[i + 1].getZ() - _values[i].getZ());
+        float span = _times[i + 1] - _times[i];
+        inverseSpans.push_back(span > 0.0f ? 1.0f / span : 0.0f);
+    }
+    starts.push_back(first + _count);
+    cursors.push_back(first);
+
+    return size() - 1;
+}
+
+inline util::vec::Vector3 Vector3Tracks::sample(unsigned _track,
+    float _time) {
+
+    checkTrack(_track);
+
+    float factor = 0.0f;
+    unsigned key = findKey(_track, _time, factor);
+
+    return util::vec::Vector3(
+        x[key] + (dx[key] * factor),
+        y[key] + (dy[key] * factor),
+        z[key] + (dz[key] * factor));
+}
+
+inline void Vector3Tracks::sample(float _time, util::vec::Vector3Batch& _out,
+    bool _parallel) {
+
+    unsigned count = size();
+    _out.resize(count);
+    sampleKeys.resize(count);
+    sampleFactors.resize(count);
+
+    float* ox = _out.getX();
+    float* oy = _out.getY();
+    float* oz = _out.getZ();
+    int blocks = static_cast<int>((count + BLOCK_SIZE - 1) / BLOCK_SIZE);
+#if !defined(_OPENMP)
+
+    (void) _parallel;
+#endif
+
+    //each block finds its keys then interpolates them while they are still
+    //in cache, a track's cursor is only touched by the block holding it
+#if defined(_OPENMP)
+#   pragma omp parallel for schedule(static) if (_parallel && blocks > 1)
+#endif
+    for (int b = 0; b < blocks; ++b) {
+
+        unsigned begin = static_cast<unsigned>(b) * BLOCK_SIZE;
+        unsigned end = begin + BLOCK_SIZE < count ? begin + BLOCK_SIZE : count;
+        for (unsigned i = begin; i < end; ++i) {
+
+            sampleKeys[i] = findKey(i, _time, sampleFactors[i]);
+        }
+        interpolate(&sampleKeys[begin], &sampleFactors[begin], end - begin,
+            ox + begin, oy + begin, oz + begin);
+    }
+}
+
+inline void Vector3Tracks::sample(unsigned _track, const float* _times,
+    unsigned _count, util::vec::Vector3Batch& _out) {
+
+    checkTrack(_track);
+
+    _out.resize(_count);
+    sampleKeys.resize(_count);
+    sampleFactors.resize(_count);
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        sampleKeys[i] = findKey(_track, _times[i], sampleFactors[i]);
+    }
+    if (_count > 0) {
+
+        interpolate(&sampleKeys[0], &sampleFactors[0], _count,
+            _out.getX(), _out.getY(), _out.getZ());
+    }
+}
+
+inline unsigned Vector3Tracks::size() const {
+
+    return static_cast<unsigned>(cursors.size());
+}
+
+inline unsigned Vector3Tracks::getKeyCount(unsigned _track) const {
+
+    checkTrack(_track);
+
+    return starts[_track + 1] - starts[_track];
+}
+
+inline const float* Vector3Tracks::getTimes(unsigned _track) const {
+
+    checkTrack(_track);
+
+    return &times[starts[_track]];
+}
+
+inline util::vec::Vector3 Vector3Tracks::getValue(unsigned _track,
+    unsigned _key) const {
+
+    if (_key >= getKeyCount(_track)) {
+
+        throw util::ex::IndexOutOfBoundsException(
+            "key index is greater than the number of keys in the track.");
+    }
+
+    unsigned key = starts[_track] + _key;
+    return util::vec::Vector3(x[key], y[key], z[key]);
+}
+
+inline void Vector3Tracks::resetCursors() {
+
+    for (unsigned i = 0; i < size(); ++i) {
+
+        cursors[i] = starts[i];
+    }
+}
+
+inline void Vector3Tracks::clear() {
+
+    times.clear();
+    x.clear();
+    y.clear();
+    z.clear();
+    dx.clear();
+    dy.clear();
+    dz.clear();
+    inverseSpans.clear();
+    starts.assign(1, 0);
+    cursors.clear();
+}
+
+//PRIVATE MEMBER FUNCTIONS
+inline unsigned Vector3Tracks::findKey(unsigned _track, float _time,
+    float& _factor) {
+
+    unsigned first = starts[_track];
+    unsigned last = starts[_track + 1] - 1;
+    _factor = 0.0f;
+
+    //the last key's changes are zero so clamping needs no special case when
+    //interpolating
+    if (_time <= times[first]) {
+
+        cursors[_track] = first;
+        return first;
+    }
+    if (_time >= times[last]) {
+
+        cursors[_track] = last;
+        return last;
+    }
+
+    //the time is now strictly between the first and last keys, so the key
+    //found is always before the last one
+    const float* t = &times[0];
+    unsigned key = cursors[_track];
+    if (t[key] <= _time) {
+
+        //coherent playback moves at most a few keys a sample
+        unsigned stop = key + 4 < last ? key + 4 : last;
+        while (key < stop && t[key + 1] <= _time) {
+
+            ++key;
+        }
+        if (t[key + 1] <= _time) {
+
+            key = static_cast<unsigned>(
+                std::upper_bound(t + key + 1, t + last, _time) - t) - 1;
+        }
+    }
+    else {
+
+        key = static_cast<unsigned>(
+            std::upper_bound(t + first, t + key, _time) - t) - 1;
+    }
+
+    cursors[_track] = key;
+    _factor = (_time - t[key]) * inverseSpans[key];
+    return key;
+}
+
+inline void Vector3Tracks::interpolate(const unsigned* _keys,
+    const float* _factors, unsigned _count, float* _ox, float* _oy,
+    float* _oz) const {
+
+    util::simd::cpu::Level level = util::simd::level();
+
+    unsigned i = 0;
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (level >= util::simd::cpu::AVX2) {
+
+        i = interpolateAvx2(_keys, _factors, _count, _ox, _oy, _oz);
+    }
+#endif
+    if (level != util::simd::cpu::SCALAR) {
+
+        //the keys are scattered so the values are gathered one at a time,
+        //the arithmetic is then four wide
+        for (; i + 4 <= _count; i += 4) {
+
+            unsigned k0 = _keys[i];
+            unsigned k1 = _keys[i + 1];
+            unsigned k2 = _keys[i + 2];
+            unsigned k3 = _keys[i + 3];
+            util::simd::Float4 f = util::simd::load(_factors + i);
+
+            util::simd::store(_ox + i, util::simd::add(
+                util::simd::set(x[k0], x[k1], x[k2], x[k3]), util::simd::mul(
+                util::simd::set(dx[k0], dx[k1], dx[k2], dx[k3]), f)));
+            util::simd::store(_oy + i, util::simd::add(
+                util::simd::set(y[k0], y[k1], y[k2], y[k3]), util::simd::mul(
+                util::simd::set(dy[k0], dy[k1], dy[k2], dy[k3]), f)));
+            util::simd::store(_oz + i, util::simd::add(
+                util::simd::set(z[k0], z[k1], z[k2], z[k3]), util::simd::mul(
+                util::simd::set(dz[k0], dz[k1], dz[k2], dz[k3]), f)));
+        }
+    }
+    for (; i < _count; ++i) {
+
+        unsigned k = _keys[i];
+        _ox[i] = x[k] + (dx[k] * _factors[i]);
+        _oy[i] = y[k] + (dy[k] * _factors[i]);
+        _oz[i] = z[k] + (dz[k] * _factors[i]);
+    }
+}
+
+inline void Vector3Tracks::checkTrack(unsigned _track) const {
+
+    if (_track >= size()) {
+
+        throw util::ex::IndexOutOfBoundsException(
+            "track index is greater than the number of tracks.");
+    }
+}
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline unsigned Vector3Tracks::interpolateAvx2(const unsigned* _keys,
+    const float* _factors, unsigned _count, float* _ox, float* _oy,
+    float* _oz) const {
+
+    const float* px = &x[0];
+    const float* py = &y[0];
+    const float* pz = &z[0];
+    const float* pdx = &dx[0];
+    const float* pdy = &dy[0];
+    const float* pdz = &dz[0];
+
+    unsigned i = 0;
+    for (; i + 8 <= _count; i += 8) {
+
+        __m256i k = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(_keys + i));
+        __m256 f = _mm256_loadu_ps(_factors + i);
+
+        _mm256_storeu_ps(_ox + i, _mm256_fmadd_ps(
+            _mm256_i32gather_ps(pdx, k, 4), f,
+            _mm256_i32gather_ps(px, k, 4)));
+        _mm256_storeu_ps(_oy + i, _mm256_fmadd_ps(
+            _mm256_i32gather_ps(pdy, k, 4), f,
+            _mm256_i32gather_ps(py, k, 4)));
+        _mm256_storeu_ps(_oz + i, _mm256_fmadd_ps(
+            _mm256_i32gather_ps(pdz, k, 4), f,
+            _mm256_i32gather_ps(pz, k, 4)));
+    }
+
+    return i;
+}
+#endif
+
+} } //util //anim
+
+#endif
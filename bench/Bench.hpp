@@ -0,0 +1,59 @@
+/******************************************\
+| Minimal timing shared by the benchmarks. |
+|                                          |
+| @author David Saxon                      |
+\******************************************/
+
+#ifndef UTILITIES_BENCH_BENCH_H_
+#   define UTILITIES_BENCH_BENCH_H_
+
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+
+namespace util { namespace bench {
+
+//FUNCTIONS
+/*!@return somewhere to write results that the compiler cannot skip*/
+inline volatile char& sink() {
+
+    static volatile char s = 0;
+    return s;
+}
+
+/*!@return the processor time used so far in milliseconds*/
+inline double milliseconds() {
+
+    return (static_cast<double>(std::clock()) * 1000.0) / CLOCKS_PER_SEC;
+}
+
+/*!Stops the compiler from removing work whose result is never used
+@_value the result to keep*/
+template<typename T>
+inline void keep(const T& _value) {
+
+    sink() = *reinterpret_cast<const volatile char*>(&_value);
+}
+
+/*!Prints one result line of a benchmark
+@_name what was measured
+@_milliseconds how long it took
+@_baseline how long the thing it is compared to took, or zero to leave out
+the speedup*/
+inline void report(const char* _name, double _milliseconds,
+    double _baseline = 0.0) {
+
+    std::cout << std::left << std::setw(32) << _name << std::right <<
+        std::fixed << std::setprecision(1) << std::setw(10) << _milliseconds <<
+        " ms";
+    if (_baseline > 0.0 && _milliseconds > 0.0) {
+
+        std::cout << std::setprecision(2) << std::setw(8) <<
+            (_baseline / _milliseconds) << "x";
+    }
+    std::cout << std::endl;
+}
+
+}} //util //bench
+
+#endif
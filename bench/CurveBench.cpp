@@ -0,0 +1,184 @@
+/***************************************************\
+| Compares Hilbert and morton order for the pages a |
+| range query touches and for encoding speed.       |
+|                                                   |
+| @author David Saxon                               |
+\***************************************************/
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "../MathUtil.hpp"
+#include "Bench.hpp"
+
+namespace {
+
+static const uint32_t GRID_2D = 1024;
+static const uint32_t GRID_3D = 128;
+static const unsigned QUERIES = 2000;
+
+/*!The number of pages and contiguous runs of indices one query touches*/
+struct Touched {
+
+    unsigned pages;
+    unsigned runs;
+};
+
+/*!Counts what a query touches once its cells have been put in curve order
+@_indices the curve index of every cell in the query, sorted in place
+@_pageSize the number of cells stored in each page
+@return the distinct pages and the contiguous runs of indices*/
+Touched touched(std::vector<uint64_t>& _indices, unsigned _pageSize) {
+
+    std::sort(_indices.begin(), _indices.end());
+
+    Touched t = {0, 0};
+    for (size_t i = 0; i < _indices.size(); ++i) {
+
+        if (i == 0 || _indices[i] / _pageSize != _indices[i - 1] / _pageSize) {
+
+            ++t.pages;
+        }
+        if (i == 0 || _indices[i] != _indices[i - 1] + 1) {
+
+            ++t.runs;
+        }
+    }
+    return t;
+}
+
+/*!Prints the average pages and runs of random box queries in 2D or 3D
+@_dimensions 2 or 3
+@_grid the width of the grid in each dimension
+@_extent the largest width of a query in each dimension
+@_pageSize the number of cells stored in each page*/
+void compare(unsigned _dimensions, uint32_t _grid, uint32_t _extent,
+    unsigned _pageSize) {
+
+    std::srand(7);
+
+    double hilbertPages = 0.0;
+    double mortonPages = 0.0;
+    double hilbertRuns = 0.0;
+    double mortonRuns = 0.0;
+    std::vector<uint64_t> hilbert;
+    std::vector<uint64_t> morton;
+    for (unsigned q = 0; q < QUERIES; ++q) {
+
+        uint32_t lo[3] = {0, 0, 0};
+        uint32_t hi[3] = {1, 1, 1};
+        for (unsigned d = 0; d < _dimensions; ++d) {
+
+            uint32_t width = 1 + (std::rand() % _extent);
+            lo[d] = std::rand() % (_grid - width);
+            hi[d] = lo[d] + width;
+        }
+
+        hilbert.clear();
+        morton.clear();
+        for (uint32_t z = lo[2]; z < hi[2]; ++z) {
+            for (uint32_t y = lo[1]; y < hi[1]; ++y) {
+                for (uint32_t x = lo[0]; x < hi[0]; ++x) {
+
+                    if (_dimensions == 2) {
+
+                        hilbert.push_back(util::math::computeHilbert2(x, y));
+                        morton.push_back(util::math::computeDMC64(x, y));
+                    }
+                    else {
+
+                        hilbert.push_back(
+                            util::math::computeHilbert3(x, y, z));
+                        morton.push_back(util::math::computeDMC3(x, y, z));
+                    }
+                }
+            }
+        }
+
+        Touched h = touched(hilbert, _pageSize);
+        Touched m = touched(morton, _pageSize);
+        hilbertPages += h.pages;
+        mortonPages += m.pages;
+        hilbertRuns += h.runs;
+        mortonRuns += m.runs;
+    }
+
+    std::cout << _dimensions << "D, queries up to " << _extent << " wide, " <<
+        _pageSize << " cells a page" << std::endl;
+    std::cout << "    pages: hilbert " << (hilbertPages / QUERIES) <<
+        ", morton " << (mortonPages / QUERIES) << std::endl;
+    std::cout << "    runs:  hilbert " << (hilbertRuns / QUERIES) <<
+        ", morton " << (mortonRuns / QUERIES) << std::endl;
+}
+
+/*!Times the batch encoders over every cell of a 2D and a 3D grid*/
+void encode() {
+
+    unsigned count = GRID_2D * GRID_2D;
+    std::vector<uint32_t> a(count);
+    std::vector<uint32_t> b(count);
+    std::vector<uint32_t> c(count);
+    for (unsigned i = 0; i < count; ++i) {
+
+        a[i] = i % GRID_2D;
+        b[i] = i / GRID_2D;
+        c[i] = i % GRID_3D;
+    }
+    std::vector<uint64_t> out(count);
+
+    double start = util::bench::milliseconds();
+    for (unsigned pass = 0; pass < 20; ++pass) {
+
+        util::math::computeDMC64(&a[0], &b[0], &out[0], count);
+        util::bench::keep(out[pass]);
+    }
+    double morton2 = util::bench::milliseconds() - start;
+
+    start = util::bench::milliseconds();
+    for (unsigned pass = 0; pass < 20; ++pass) {
+
+        util::math::computeHilbert2(&a[0], &b[0], &out[0], count);
+        util::bench::keep(out[pass]);
+    }
+    double hilbert2 = util::bench::milliseconds() - start;
+
+    start = util::bench::milliseconds();
+    for (unsigned pass = 0; pass < 20; ++pass) {
+
+        util::math::computeDMC3(&a[0], &b[0], &c[0], &out[0], count);
+        util::bench::keep(out[pass]);
+    }
+    double morton3 = util::bench::milliseconds() - start;
+
+    start = util::bench::milliseconds();
+    for (unsigned pass = 0; pass < 20; ++pass) {
+
+        util::math::computeHilbert3(&a[0], &b[0], &c[0], &out[0], count);
+        util::bench::keep(out[pass]);
+    }
+    double hilbert3 = util::bench::milliseconds() - start;
+
+    //the speedup column is relative to morton, below 1 is slower
+    util::bench::report("2D morton encode", morton2);
+    util::bench::report("2D hilbert encode", hilbert2, morton2);
+    util::bench::report("3D morton encode", morton3);
+    util::bench::report("3D hilbert encode", hilbert3, morton3);
+}
+
+} //anonymous
+
+int main() {
+
+    std::cout << std::fixed << std::setprecision(2);
+    compare(2, GRID_2D, 64, 200);
+    compare(2, GRID_2D, 64, 256);
+    compare(2, GRID_2D, 64, 4096);
+    compare(3, GRID_3D, 16, 200);
+    compare(3, GRID_3D, 16, 512);
+    encode();
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+/*************************************************\
+| Compares the SIMD backed Vector4 with the loose |
+| float members it replaced.                      |
+|                                                 |
+| Build with -DUTIL_NO_SIMD to time the scalar    |
+| fallback instead.                               |
+|                                                 |
+| @author David Saxon                             |
+\*************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "../vector/Vector4.hpp"
+#include "Bench.hpp"
+
+using util::vec::Vector4;
+
+namespace {
+
+/*!The operators Vector4 had before it was backed by a SIMD register*/
+struct LegacyVector4 {
+
+    float x;
+    float y;
+    float z;
+    float w;
+
+    LegacyVector4() :
+        x(0.0f),
+        y(0.0f),
+        z(0.0f),
+        w(0.0f) {
+    }
+
+    LegacyVector4(float _x, float _y, float _z, float _w) :
+        x(_x),
+        y(_y),
+        z(_z),
+        w(_w) {
+    }
+
+    LegacyVector4 operator +(const LegacyVector4& _other) const {
+
+        return LegacyVector4(
+            x + _other.x, y + _other.y, z + _other.z, w + _other.w);
+    }
+
+    LegacyVector4 operator -(const LegacyVector4& _other) const {
+
+        return LegacyVector4(
+            x - _other.x, y - _other.y, z - _other.z, w - _other.w);
+    }
+
+    LegacyVector4 operator *(float _scalar) const {
+
+        return LegacyVector4(x * _scalar, y * _scalar, z * _scalar,
+            w * _scalar);
+    }
+
+    LegacyVector4 operator /(float _scalar) const {
+
+        return LegacyVector4(x / _scalar, y / _scalar, z / _scalar,
+            w / _scalar);
+    }
+
+    float dotProduct(const LegacyVector4& _other) const {
+
+        return (x * _other.x) + (y * _other.y) + (z * _other.z) +
+            (w * _other.w);
+    }
+
+    float distance(const LegacyVector4& _other) const {
+
+        return sqrt(pow(x - _other.x, 2.0f) + pow(y - _other.y, 2.0f) +
+            pow(z - _other.z, 2.0f) + pow(w - _other.w, 2.0f));
+    }
+
+    float magnitude() const {
+
+        return distance(LegacyVector4());
+    }
+
+    void normalise() {
+
+        float mag = magnitude();
+        x /= mag;
+        y /= mag;
+        z /= mag;
+        w /= mag;
+    }
+};
+
+static const unsigned COUNT = 1 << 20;
+static const unsigned PASSES = 20;
+
+float randomValue() {
+
+    return (std::rand() / static_cast<float>(RAND_MAX)) + 0.5f;
+}
+
+/*!Runs the same work over either vector type
+@_a the first vectors, overwritten with the results
+@_b the second vectors
+@return the time taken in milliseconds*/
+template<typename VectorType>
+double run(std::vector<VectorType>& _a, const std::vector<VectorType>& _b) {
+
+    float sum = 0.0f;
+    double start = util::bench::milliseconds();
+    for (unsigned pass = 0; pass < PASSES; ++pass) {
+
+        float s = 1.0f + (pass * 0.01f);
+        for (unsigned i = 0; i < COUNT; ++i) {
+
+            VectorType v = ((_a[i] + _b[i]) * s) - (_b[i] / s);
+            v.normalise();
+            sum += v.dotProduct(_b[i]) + _b[i].magnitude();
+            _a[i] = v;
+        }
+    }
+    double time = util::bench::milliseconds() - start;
+    util::bench::keep(sum);
+    return time;
+}
+
+} //anonymous
+
+int main() {
+
+    std::vector<LegacyVector4> legacyA;
+    std::vector<LegacyVector4> legacyB;
+    std::vector<Vector4> a;
+    std::vector<Vector4> b;
+    for (unsigned i = 0; i < COUNT; ++i) {
+
+        float v[8];
+        for (unsigned j = 0; j < 8; ++j) {
+
+            v[j] = randomValue();
+        }
+        legacyA.push_back(LegacyVector4(v[0], v[1], v[2], v[3]));
+        legacyB.push_back(LegacyVector4(v[4], v[5], v[6], v[7]));
+        a.push_back(Vector4(v[0], v[1], v[2], v[3]));
+        b.push_back(Vector4(v[4], v[5], v[6], v[7]));
+    }
+
+    double legacy = run(legacyA, legacyB);
+    double simd = run(a, b);
+    util::bench::report("loose floats", legacy);
+#ifdef UTIL_NO_SIMD
+    util::bench::report("Vector4 scalar fallback", simd, legacy);
+#else
+    util::bench::report("Vector4 SIMD", simd, legacy);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+/****************************************************\
+| Compares the eager vector operators with the fused |
+| expression templates on a + b * s - c.             |
+|                                                    |
+| @author David Saxon                                |
+\****************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../vector/VectorExpression.hpp"
+#include "Bench.hpp"
+
+using util::vec::Vector3;
+using util::vec::Vector3Batch;
+using util::vec::Vector4;
+namespace expr = util::vec::expr;
+
+namespace {
+
+static const unsigned COUNT = 1 << 12;
+static const unsigned PASSES = 10000;
+static const float S = 1.5f;
+
+float randomValue() {
+
+    return (std::rand() / static_cast<float>(RAND_MAX)) * 2.0f - 1.0f;
+}
+
+/*!@return whether the two sets of values are the same, the fused and eager
+forms do the same operations in the same order so they should match
+exactly unless the compiler contracts them into fused multiply adds*/
+bool same(const float* _a, const float* _b, unsigned _count) {
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        if (std::fabs(_a[i] - _b[i]) > 1e-6f * (1.0f + std::fabs(_a[i]))) {
+
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!Times a + b * s - c on arrays of vectors
+@_eager receives the time of the eager operators
+@_fused receives the time of the expression templates
+@return whether both gave the same results*/
+template<typename VectorType>
+bool runVectors(double& _eager, double& _fused) {
+
+    std::vector<VectorType> a(COUNT);
+    std::vector<VectorType> b(COUNT);
+    std::vector<VectorType> c(COUNT);
+    for (unsigned i = 0; i < COUNT; ++i) {
+
+        for (unsigned j = 0; j < sizeof(VectorType) / sizeof(float); ++j) {
+
+            a[i][j] = randomValue();
+            b[i][j] = randomValue();
+            c[i][j] = randomValue();
+        }
+    }
+    std::vector<VectorType> eager(COUNT);
+    std::vector<VectorType> fused(COUNT);
+
+    double start = util::bench::milliseconds();
+    for (unsigned pass = 0; pass < PASSES; ++pass) {
+
+        for (unsigned i = 0; i < COUNT; ++i) {
+
+            eager[i] = a[i] + b[i] * S - c[i];
+        }
+        util::bench::keep(eager[pass]);
+    }
+    _eager = util::bench::milliseconds() - start;
+
+    start = util::bench::milliseconds();
+    for (unsigned pass = 0; pass < PASSES; ++pass) {
+
+        for (unsigned i = 0; i < COUNT; ++i) {
+
+            expr::assign(fused[i],
+                expr::lazy(a[i]) + expr::lazy(b[i]) * S - expr::lazy(c[i]));
+        }
+        util::bench::keep(fused[pass]);
+    }
+    _fused = util::bench::milliseconds() - start;
+
+    return same(eager[0].data(), fused[0].data(),
+        COUNT * (sizeof(VectorType) / sizeof(float)));
+}
+
+/*!Times a + b * s - c on batches
+@_eager receives the time of the batch functions, which need a temporary
+@_fused receives the time of the expression templates
+@return whether both gave the same results*/
+bool runBatch(double& _eager, double& _fused) {
+
+    Vector3Batch a(COUNT);
+    Vector3Batch b(COUNT);
+    Vector3Batch c(COUNT);
+    for (unsigned i = 0; i < COUNT; ++i) {
+
+        a.set(i, Vector3(randomValue(), randomValue(), randomValue()));
+        b.set(i, Vector3(randomValue(), randomValue(), randomValue()));
+        c.set(i, Vector3(randomValue(), randomValue(), randomValue()));
+    }
+    Vector3Batch temp(COUNT);
+    Vector3Batch eager(COUNT);
+    Vector3Batch fused(COUNT);
+
+    double start = util::bench::milliseconds();
+    for (unsigned pass = 0; pass < PASSES; ++pass) {
+
+        Vector3Batch::scale(b, S, temp);
+        Vector3Batch::add(a, temp, temp);
+        Vector3Batch::subtract(temp, c, eager);
+        util::bench::keep(eager.getX()[pass]);
+    }
+    _eager = util::bench::milliseconds() - start;
+
+    start = util::bench::milliseconds();
+    for (unsigned pass = 0; pass < PASSES; ++pass) {
+
+        expr::assign(fused,
+            expr::lazy(a) + expr::lazy(b) * S - expr::lazy(c));
+        util::bench::keep(fused.getX()[pass]);
+    }
+    _fused = util::bench::milliseconds() - start;
+
+    return same(eager.getX(), fused.getX(), COUNT) &&
+           same(eager.getY(), fused.getY(), COUNT) &&
+           same(eager.getZ(), fused.getZ(), COUNT);
+}
+
+} //anonymous
+
+int main() {
+
+    bool same = true;
+    double eager = 0.0;
+    double fused = 0.0;
+
+    same = runVectors<Vector3>(eager, fused) && same;
+    util::bench::report("Vector3 operators", eager);
+    util::bench::report("Vector3 expression", fused, eager);
+
+    same = runVectors<Vector4>(eager, fused) && same;
+    util::bench::report("Vector4 operators", eager);
+    util::bench::report("Vector4 expression", fused, eager);
+
+    same = runBatch(eager, fused) && same;
+    util::bench::report("Vector3Batch functions", eager);
+    util::bench::report("Vector3Batch expression", fused, eager);
+
+    if (!same) {
+
+        std::cerr << "the expressions gave different results" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -7,16 +7,37 @@
 #ifndef UTILITIES_MATRIX_MATRIX4_H_
 #   define UTILITIES_MATRIX_MATRIX4_H_
 
+#include <cassert>
 #include <iostream>
 #include <math.h>
 
+#include "../MacroUtil.hpp"
+#include "../SimdUtil.hpp"
 #include "../ValuesUtil.hpp"
 #include "../exceptions/ArrayException.hpp"
+#include "../vector/Quaternion.hpp"
 #include "../vector/Vector3.hpp"
 #include "../vector/Vector4.hpp"
 
 namespace util { namespace mat {
 
+namespace m4 {
+
+//ENUMERATORS
+//!The kinds of transform a matrix can hold, from the cheapest to invert to
+//!the most expensive
+enum Type {
+
+    //!an orthonormal rotation followed by a translation
+    RIGID = 0,
+    //!any 3x3 transform followed by a translation, the bottom row is 0 0 0 1
+    AFFINE,
+    //!any invertible 4x4 matrix
+    GENERAL
+};
+
+} //m4
+
 class Matrix4 {
 
     //FRIEND FUNCTIONS
@@ -31,7 +52,8 @@ public:
 
     //CONSTRUCTORS
     /*!Creates a new zero 4x4 matrix*/
-    Matrix4() {
+    UTIL_CONSTEXPR Matrix4() :
+        cols() {
     }
 
     /*!Creates a new 4x4 matrix from the three columns given
@@ -39,31 +61,39 @@ public:
     @_col1 the second column
     @_col2 the third column
     @_col3 the fourth column*/
-    Matrix4(const util::vec::Vector4& _col0, const util::vec::Vector4& _col1,
-        const util::vec::Vector4& _col2, const util::vec::Vector4& _col3) :
-        col0(_col0),
-        col1(_col1),
-        col2(_col2),
-        col3(_col3) {
+    UTIL_CONSTEXPR Matrix4(const util::vec::Vector4& _col0,
+        const util::vec::Vector4& _col1, const util::vec::Vector4& _col2,
+        const util::vec::Vector4& _col3) :
+        cols() {
+
+        cols[0] = _col0;
+        cols[1] = _col1;
+        cols[2] = _col2;
+        cols[3] = _col3;
     }
 
     /*!Creates a new 4x4 matrix with the smae scale values
     @_scalar the scalar to set the matrix to*/
-    explicit Matrix4(float _scalar) :
-        col0(_scalar, _scalar, _scalar, _scalar),
-        col1(_scalar, _scalar, _scalar, _scalar),
-        col2(_scalar, _scalar, _scalar, _scalar),
-        col3(_scalar, _scalar, _scalar, _scalar) {
-    } 
+    UTIL_CONSTEXPR explicit Matrix4(float _scalar) :
+        cols() {
+
+        util::vec::Vector4 col(_scalar, _scalar, _scalar, _scalar);
+        cols[0] = col;
+        cols[1] = col;
+        cols[2] = col;
+        cols[3] = col;
+    }
 
     /*!Creates a new 4x4 matrix by copying the other matrix
     @_other the matrix to copy*/
-    Matrix4(const Matrix4& _other) :
-        col0(_other.col0),
-        col1(_other.col1),
-        col2(_other.col2),
-        col3(_other.col3) {
-    }  
+    UTIL_CONSTEXPR Matrix4(const Matrix4& _other) :
+        cols() {
+
+        cols[0] = _other.cols[0];
+        cols[1] = _other.cols[1];
+        cols[2] = _other.cols[2];
+        cols[3] = _other.cols[3];
+    }
 
     //OPERATORS
     /*!Copies the values from the other matrix to this matrix
@@ -76,12 +106,27 @@ public:
     /*!Gets the column at the specified index
     @_index the column index
     @return the given column*/
-    util::vec::Vector4& operator [](unsigned _index);
+    UTIL_CONSTEXPR util::vec::Vector4& operator [](unsigned _index);
 
     /*!Gets the column at the specified index
     @_index the column index
     @return the given column*/
-    const util::vec::Vector4& operator [](unsigned _index) const;
+    UTIL_CONSTEXPR const util::vec::Vector4& operator [](unsigned _index)
+        const;
+
+    /*!Gets the element at the given position without bounds checking
+    #NOTE: the indices are only checked by an assertion in debug builds
+    @_col the column index
+    @_row the row index
+    @return the element*/
+    float& operator ()(unsigned _col, unsigned _row);
+
+    /*!Gets the element at the given position without bounds checking
+    #NOTE: the indices are only checked by an assertion in debug builds
+    @_col the column index
+    @_row the row index
+    @return the element*/
+    const float& operator ()(unsigned _col, unsigned _row) const;
 
     /*!@return this matrix with all elements negated*/
     Matrix4 operator -() const;
@@ -134,7 +179,7 @@ public:
 
     //PUBLIC MEMBER FUNCTIONS
     /*!@return the 4x4 identity matrix*/
-    static Matrix4 identity();
+    static UTIL_CONSTEXPR Matrix4 identity();
 
     /*!Creates a 4x4 matrix to rotate around the x axis
     @_degrees the amount in degrees to rotate around the x axis
@@ -162,17 +207,51 @@ public:
     @return the rotation matrix*/
     static Matrix4 rotation(float _degrees, const util::vec::Vector3& _unitVec);
 
-    //TODO: rotation around quaternion
+    /*!Creates a 4x4 matrix to rotate by a quaternion
+    #WARNING: the quaternion should be unit length
+    @_quat the quaternion to rotate by
+    @return the rotation matrix*/
+    static Matrix4 rotation(const util::vec::Quaternion& _quat);
+
+    /*!Creates the quaternion for the rotation of the given matrix
+    #WARNING: the 3x3 part of the matrix must be a rotation with no scale
+    @_other the matrix to convert
+    @return the rotation quaternion*/
+    static util::vec::Quaternion toQuaternion(const Matrix4& _other);
+
+    /*!Creates the matrix that scales, then rotates, then translates, this is
+    translation * rotation * scale without multiplying
+    #WARNING: the quaternion should be unit length
+    @_translation the amount to translate
+    @_rotation the quaternion to rotate by
+    @_scale the amount to scale by
+    @return the transform matrix*/
+    static Matrix4 compose(const util::vec::Vector3& _translation,
+        const util::vec::Quaternion& _rotation,
+        const util::vec::Vector3& _scale);
+
+    /*!Takes an affine matrix with no shear apart into the translation,
+    rotation and scale that compose() would build it from, a mirrored matrix
+    gets a negative x scale
+    #WARNING: a zero scale leaves the rotation undefined
+    @_other the matrix to take apart
+    @_translation receives the translation
+    @_rotation receives the rotation
+    @_scale receives the scale*/
+    static void decompose(const Matrix4& _other,
+        util::vec::Vector3& _translation, util::vec::Quaternion& _rotation,
+        util::vec::Vector3& _scale);
 
     /*!Creates a 4x4 matrix for scaling
     @_scale the amount to scale by
     @return the scale matrix*/
-    static Matrix4 scale(const util::vec::Vector3& _scale);
+    static UTIL_CONSTEXPR Matrix4 scale(const util::vec::Vector3& _scale);
 
     /*!Creates a 4x4 for translation
     @_translation the amount to translate
     @return the translation matrix*/
-    static Matrix4 translation(const util::vec::Vector3& _translation);
+    static UTIL_CONSTEXPR Matrix4 translation(
+        const util::vec::Vector3& _translation);
 
     /*!Create a matrix based on eye position, position looked at,
     and up direction
@@ -191,7 +270,8 @@ public:
     static Matrix4 perspective(float _fov, float _aspectRatio,
         float _zNear, float _zFar);
 
-    /*!Creates a perspective projection matrix based on frustum
+    /*!Creates a perspective projection matrix based on frustum, the same as
+    glFrustum, the dimensions are of the near plane
     @_left the left dimension of the frustum
     @_right the right dimension of the frustum
     @_bottom the bottom dimension of the frustum
@@ -201,7 +281,7 @@ public:
     static Matrix4 frustum(float _left, float _right, float _bottom, float _top,
         float _zNear, float _zFar);
 
-    /*!Creates an orthographic projection matrix
+    /*!Creates an orthographic projection matrix, the same as glOrtho
     @_left the left dimension 
     @_right the right dimension 
     @_bottom the bottom dimension 
@@ -214,18 +294,108 @@ public:
     /*!Creates the transpose of the given matrix
     @_other the matrix to transpose
     @return the matrix transposed as a new matrix*/
-    static Matrix4 transpose(const Matrix4& _other);
+    static UTIL_CONSTEXPR Matrix4 transpose(const Matrix4& _other);
+
+    /*!Multiplies two 4x4 matrices one element at a time, unlike the SIMD
+    operator * this can be evaluated at compile time so constant transforms
+    can be combined into a single constant
+    @_a the left hand matrix
+    @_b the right hand matrix
+    @return the result of the multiplication*/
+    static UTIL_CONSTEXPR Matrix4 multiply(const Matrix4& _a,
+        const Matrix4& _b);
 
     /*!Creates the inverse of the given matrix
     @_other the matrix to inverse
     @return the matrix inversed as a new matrix*/
     static Matrix4 inverse(const Matrix4& _other);
 
+    /*!Creates the inverse of the given matrix using the cheapest method that
+    is correct for the type of the matrix
+    @_other the matrix to inverse
+    @_type the type of the matrix, see classify()
+    @return the matrix inversed as a new matrix*/
+    static Matrix4 inverse(const Matrix4& _other, m4::Type _type);
+
+    /*!Inverses an array of matrices, each matrix is classified and inversed
+    with the cheapest method that is correct for it
+    @_in the matrices to inverse
+    @_out receives the inversed matrices, may be the same array as _in
+    @_count the number of matrices*/
+    static void inverse(const Matrix4* _in, Matrix4* _out, unsigned _count);
+
+    /*!Inverses an array of matrices that are all of the given type, general
+    and affine matrices are inversed four or eight at a time with each
+    register holding the same element of every matrix in the group, so the
+    cofactor expansion runs once per group rather than once per matrix
+    @_in the matrices to inverse
+    @_out receives the inversed matrices, may be the same array as _in
+    @_count the number of matrices
+    @_type the type of every matrix, see classify()*/
+    static void inverse(const Matrix4* _in, Matrix4* _out, unsigned _count,
+        m4::Type _type);
+
+    /*!Creates the inverse of an affine matrix, the 3x3 part is inversed and
+    the translation is moved back through it
+    #WARNING: the bottom row of the matrix must be 0 0 0 1
+    @_other the matrix to inverse
+    @return the matrix inversed as a new matrix*/
+    static Matrix4 inverseAffine(const Matrix4& _other);
+
+    /*!Creates the inverse of a rigid body matrix, the 3x3 part is transposed
+    and the translation is rotated by it and negated
+    #WARNING: the 3x3 part of the matrix must be orthonormal and the bottom row
+    must be 0 0 0 1
+    @_other the matrix to inverse
+    @return the matrix inversed as a new matrix*/
+    static Matrix4 inverseRigid(const Matrix4& _other);
+
+    /*!Finds the cheapest type the matrix can be inversed as
+    @_other the matrix to classify
+    @_tolerance how far elements may be from the exact values
+    @return the type of the matrix*/
+    static m4::Type classify(const Matrix4& _other, float _tolerance = 0.0001f);
+
     /*!Creates the determinant of the given matrix
     @_other the matrix to calculate the the determinant for
     @return the the determinant*/
     static float determinant(const Matrix4& _other);
 
+    /*!Creates the determinants of an array of matrices four or eight at a
+    time, see inverse()
+    @_in the matrices to calculate the determinants for
+    @_out receives the determinants
+    @_count the number of matrices*/
+    static void determinant(const Matrix4* _in, float* _out, unsigned _count);
+
+    /*!Transforms an array of 4d vectors by the matrix, four at a time
+    @_m the matrix to transform by
+    @_in the vectors to transform
+    @_out receives the transformed vectors, may be the same array as _in
+    @_count the number of vectors to transform*/
+    static void transform(const Matrix4& _m, const util::vec::Vector4* _in,
+        util::vec::Vector4* _out, unsigned _count);
+
+    /*!Transforms an array of 3d points (w = 1) by the matrix, four at a time
+    #NOTE: the w value of the result is dropped, there is no perspective divide
+    @_m the matrix to transform by
+    @_in the points to transform
+    @_out receives the transformed points, may be the same array as _in
+    @_count the number of points to transform*/
+    static void transformPoints(const Matrix4& _m,
+        const util::vec::Vector3* _in, util::vec::Vector3* _out,
+        unsigned _count);
+
+    /*!Transforms an array of 3d directions (w = 0) by the matrix, four at a
+    time, so the translation of the matrix is ignored
+    @_m the matrix to transform by
+    @_in the directions to transform
+    @_out receives the transformed directions, may be the same array as _in
+    @_count the number of directions to transform*/
+    static void transformDirections(const Matrix4& _m,
+        const util::vec::Vector3* _in, util::vec::Vector3* _out,
+        unsigned _count);
+
     /*!Sets the the column at the given index
     @_index the column index to set
     @_col the new column*/
@@ -289,29 +459,119 @@ public:
     /*!@return the translation component of the matrix*/
     util::vec::Vector3 getTranslation() const;
 
+    /*!@return the 16 elements of the matrix in column-major order, an array of
+    matrices is an unbroken array of floats so it can be copied straight
+    into an upload buffer*/
+    float* data();
+
+    /*!@return the 16 elements of the matrix in column-major order, an array of
+    matrices is an unbroken array of floats so it can be copied straight
+    into an upload buffer*/
+    const float* data() const;
+
 private:
 
     //VARIABLES
-    //the columns of the matrix
-    util::vec::Vector4 col0;
-    util::vec::Vector4 col1;
-    util::vec::Vector4 col2;
-    util::vec::Vector4 col3;
+    //the columns of the matrix, each is an aligned group of four floats so
+    //together they are one contiguous, aligned, column-major float[16]
+    util::vec::Vector4 cols[4];
+
+    //PRIVATE MEMBER FUNCTIONS
+    /*!Transforms an array of 3d vectors with the given w value
+    @_m the matrix to transform by
+    @_in the vectors to transform
+    @_out receives the transformed vectors
+    @_count the number of vectors to transform
+    @_w the w value of every input vector*/
+    static void transformVector3(const Matrix4& _m,
+        const util::vec::Vector3* _in, util::vec::Vector3* _out,
+        unsigned _count, float _w);
+
+    /*!Inverses or finds the determinants of an array of general matrices a
+    group at a time
+    @_in the matrices
+    @_out receives the inversed matrices or NULL, may be the same array as _in
+    @_determinants receives the determinants or NULL
+    @_count the number of matrices*/
+    static void cofactorBatch(const Matrix4* _in, Matrix4* _out,
+        float* _determinants, unsigned _count);
+
+    /*!Computes the adjugates of four matrices, each register holds the same
+    element of the four matrices
+    @_m the 16 elements in column-major order
+    @_r receives the 16 elements of the adjugates in column-major order, only
+    the first column when _full is false
+    @_full whether to compute the whole adjugate or only what the
+    determinant needs
+    @return the determinants of the matrices*/
+    static util::simd::Float4 adjugate(const util::simd::Float4* _m,
+        util::simd::Float4* _r, bool _full);
+
+    /*!@return _a * _b - _c * _d*/
+    static util::simd::Float4 mulSub(util::simd::Float4 _a,
+        util::simd::Float4 _b, util::simd::Float4 _c, util::simd::Float4 _d);
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+    /*!Inverses or finds the determinants of as many general matrices as fit
+    in groups of eight, see cofactorBatch()
+    @return the number of matrices done, the rest are left to the caller*/
+    UTIL_SIMD_TARGET("avx2,fma")
+    static unsigned cofactorBatchAvx2(const Matrix4* _in, Matrix4* _out,
+        float* _determinants, unsigned _count);
+
+    /*!Computes the adjugates of eight matrices, see adjugate()*/
+    UTIL_SIMD_TARGET("avx2,fma")
+    static __m256 adjugateAvx2(const __m256* _m, __m256* _r, bool _full);
+
+    /*!@return the four floats at _low in the low half and the four at _high
+    in the high half*/
+    UTIL_SIMD_TARGET("avx2,fma")
+    static __m256 loadPairAvx2(const float* _low, const float* _high);
+
+    /*!Transposes the four 4x4 blocks held in the low halves and the four held
+    in the high halves of the registers*/
+    UTIL_SIMD_TARGET("avx2,fma")
+    static void transposeAvx2(__m256& _r0, __m256& _r1, __m256& _r2,
+        __m256& _r3);
+
+    /*!Transforms as many 4d vectors as fit in pairs of 8 wide AVX2 registers
+    @return the number of vectors transformed, the rest are left to the
+    caller*/
+    UTIL_SIMD_TARGET("avx2,fma")
+    static unsigned transformAvx2(const Matrix4& _m,
+        const util::vec::Vector4* _in, util::vec::Vector4* _out,
+        unsigned _count);
+
+    /*!Transforms as many 4d vectors as fit in pairs of 16 wide AVX-512
+    registers
+    @return the number of vectors transformed, the rest are left to the
+    caller*/
+    UTIL_SIMD_TARGET("avx512f")
+    static unsigned transformAvx512(const Matrix4& _m,
+        const util::vec::Vector4* _in, util::vec::Vector4* _out,
+        unsigned _count);
+#endif
 };
 
+//an array of matrices has to be an unbroken array of floats for data()
+typedef char Matrix4IsPacked[
+    (sizeof(Matrix4) == (16 * sizeof(float))) ? 1 : -1];
+
 //INLINE
 //OPERATORS
 inline const Matrix4 Matrix4::operator =(const Matrix4& _other) {
 
-    col0 = _other.col0;
-    col1 = _other.col1;
-    col2 = _other.col2;
-    col3 = _other.col3;
+    cols[0] = _other.cols[0];
+    cols[1] = _other.cols[1];
+    cols[2] = _other.cols[2];
+    cols[3] = _other.cols[3];
 
     return *this;
 }
 
-inline util::vec::Vector4& Matrix4::operator [](unsigned _index) {
+inline UTIL_CONSTEXPR util::vec::Vector4& Matrix4::operator [](
+    unsigned _index) {
 
     //check that the index is within bounds
     if (_index > 3) {
@@ -319,28 +579,11 @@ inline util::vec::Vector4& Matrix4::operator [](unsigned _index) {
         throw util::ex::IndexOutOfBoundsException("index is greater than 3.");
     }
 
-    switch (_index) {
-
-        case 0: {
-
-            return col0;
-        }
-        case 1: {
-
-            return col1;
-        }
-        case 2: {
-
-            return col2;
-        }
-        default: {
-
-            return col3;
-        }
-    }
+    return cols[_index];
 }
 
-inline const util::vec::Vector4& Matrix4::operator [](unsigned _index) const {
+inline UTIL_CONSTEXPR const util::vec::Vector4& Matrix4::operator [](
+    unsigned _index) const {
 
     //check that the index is within bounds
     if (_index > 3) {
@@ -348,43 +591,39 @@ inline const util::vec::Vector4& Matrix4::operator [](unsigned _index) const {
         throw util::ex::IndexOutOfBoundsException("index is greater than 3.");
     }
 
-    switch (_index) {
+    return cols[_index];
+}
 
-        case 0: {
+inline float& Matrix4::operator ()(unsigned _col, unsigned _row) {
 
-            return col0;
-        }
-        case 1: {
+    assert(_col < 4 && _row < 4);
 
-            return col1;
-        }
-        case 2: {
+    return data()[(_col * 4) + _row];
+}
 
-            return col2;
-        }
-        default: {
+inline const float& Matrix4::operator ()(unsigned _col, unsigned _row) const {
 
-            return col3;
-        }
-    }
+    assert(_col < 4 && _row < 4);
+
+    return data()[(_col * 4) + _row];
 }
 
 inline Matrix4 Matrix4::operator -() const {
 
     return Matrix4(
-        -col0,
-        -col1,
-        -col2,
-        -col3);
+        -cols[0],
+        -cols[1],
+        -cols[2],
+        -cols[3]);
 }
 
 inline Matrix4 Matrix4::operator +(const Matrix4& _other) const {
 
     return Matrix4(
-        col0 + _other.col0,
-        col1 + _other.col1,
-        col2 + _other.col2,
-        col3 + _other.col3);
+        cols[0] + _other.cols[0],
+        cols[1] + _other.cols[1],
+        cols[2] + _other.cols[2],
+        cols[3] + _other.cols[3]);
 }
 
 inline void Matrix4::operator +=(const Matrix4& _other) {
@@ -395,10 +634,10 @@ inline void Matrix4::operator +=(const Matrix4& _other) {
 inline Matrix4 Matrix4::operator -(const Matrix4& _other) const {
 
     return Matrix4(
-        col0 - _other.col0,
-        col1 - _other.col1,
-        col2 - _other.col2,
-        col3 - _other.col3);
+        cols[0] - _other.cols[0],
+        cols[1] - _other.cols[1],
+        cols[2] - _other.cols[2],
+        cols[3] - _other.cols[3]);
 }
 
 inline void Matrix4::operator -=(const Matrix4& _other) {
@@ -409,10 +648,10 @@ inline void Matrix4::operator -=(const Matrix4& _other) {
 inline Matrix4 Matrix4::operator *(float _scalar) const {
 
     return Matrix4(
-        (col0 * _scalar),
-        (col1 * _scalar),
-        (col2 * _scalar),
-        (col3 * _scalar));
+        (cols[0] * _scalar),
+        (cols[1] * _scalar),
+        (cols[2] * _scalar),
+        (cols[3] * _scalar));
 }
 
 inline void Matrix4::operator *=(float _scalar) {
@@ -423,38 +662,79 @@ inline void Matrix4::operator *=(float _scalar) {
 inline util::vec::Vector4 Matrix4::operator *(
     const util::vec::Vector3& _vec) const {
 
-    return util::vec::Vector4(
-        (((col0.getX() * _vec.getX()) + (col1.getX() * _vec.getY())) +
-            (col2.getX() * _vec.getZ())),
-        (((col0.getY() * _vec.getX()) + (col1.getY() * _vec.getY())) +
-            (col2.getY() * _vec.getZ())),
-        (((col0.getZ() * _vec.getX()) + (col1.getZ() * _vec.getY())) +
-            (col2.getZ() * _vec.getZ())),
-        (((col0.getW() * _vec.getX()) + (col1.getW() * _vec.getY())) +
-            (col2.getW() * _vec.getZ())));    
+    util::simd::Float4 r = util::simd::mul(
+        cols[0].toSimd(), util::simd::splat(_vec.getX()));
+    r = util::simd::add(r, util::simd::mul(
+        cols[1].toSimd(), util::simd::splat(_vec.getY())));
+    r = util::simd::add(r, util::simd::mul(
+        cols[2].toSimd(), util::simd::splat(_vec.getZ())));
+
+    return util::vec::Vector4(r);
 }
 
 inline util::vec::Vector4 Matrix4::operator *(
     const util::vec::Vector4& _vec) const {
 
-    return util::vec::Vector4(
-        ((((col0.getX() * _vec.getX()) + (col1.getX() * _vec.getY())) + 
-            (col2.getX() * _vec.getZ())) + (col3.getX() * _vec.getW())),
-        ((((col0.getY() * _vec.getX()) + (col1.getY() * _vec.getY())) + 
-            (col2.getY() * _vec.getZ())) + (col3.getY() * _vec.getW())),
-        ((((col0.getZ() * _vec.getX()) + (col1.getZ() * _vec.getY())) + 
-            (col2.getZ() * _vec.getZ())) + (col3.getZ() * _vec.getW())),
-        ((((col0.getW() * _vec.getX()) + (col1.getW() * _vec.getY())) + 
-            (col2.getW() * _vec.getZ())) + (col3.getW() * _vec.getW())));
+    util::simd::Float4 v = _vec.toSimd();
+
+    util::simd::Float4 r = util::simd::mul(
+        cols[0].toSimd(), util::simd::splatLane<0>(v));
+    r = util::simd::add(r, util::simd::mul(
+        cols[1].toSimd(), util::simd::splatLane<1>(v)));
+    r = util::simd::add(r, util::simd::mul(
+        cols[2].toSimd(), util::simd::splatLane<2>(v)));
+    r = util::simd::add(r, util::simd::mul(
+        cols[3].toSimd(), util::simd::splatLane<3>(v)));
+
+    return util::vec::Vector4(r);
 }
 
 inline Matrix4 Matrix4::operator *(const Matrix4& _other) const {
 
+#if defined(UTIL_SIMD_AVX)
+
+    //each 256 bit register holds two columns so the result is computed two
+    //columns at a time, the columns of this matrix are duplicated into both
+    //halves of the registers
+    __m128 c0 = cols[0].toSimd();
+    __m128 c1 = cols[1].toSimd();
+    __m128 c2 = cols[2].toSimd();
+    __m128 c3 = cols[3].toSimd();
+    __m256 a0 = _mm256_insertf128_ps(_mm256_castps128_ps256(c0), c0, 1);
+    __m256 a1 = _mm256_insertf128_ps(_mm256_castps128_ps256(c1), c1, 1);
+    __m256 a2 = _mm256_insertf128_ps(_mm256_castps128_ps256(c2), c2, 1);
+    __m256 a3 = _mm256_insertf128_ps(_mm256_castps128_ps256(c3), c3, 1);
+
+    __m256 pairs[2] = {
+        _mm256_insertf128_ps(_mm256_castps128_ps256(_other.cols[0].toSimd()),
+            _other.cols[1].toSimd(), 1),
+        _mm256_insertf128_ps(_mm256_castps128_ps256(_other.cols[2].toSimd()),
+            _other.cols[3].toSimd(), 1)
+    };
+
+    for (unsigned i = 0; i < 2; ++i) {
+
+        __m256 b = pairs[i];
+        __m256 r = _mm256_mul_ps(a0, _mm256_shuffle_ps(b, b, 0x00));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_shuffle_ps(b, b, 0x55)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_shuffle_ps(b, b, 0xAA)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_shuffle_ps(b, b, 0xFF)));
+        pairs[i] = r;
+    }
+
     return Matrix4(
-        (*this * _other.col0),
-        (*this * _other.col1),
-        (*this * _other.col2),
-        (*this * _other.col3));
+        util::vec::Vector4(_mm256_castps256_ps128(pairs[0])),
+        util::vec::Vector4(_mm256_extractf128_ps(pairs[0], 1)),
+        util::vec::Vector4(_mm256_castps256_ps128(pairs[1])),
+        util::vec::Vector4(_mm256_extractf128_ps(pairs[1], 1)));
+#else
+
+    return Matrix4(
+        (*this * _other.cols[0]),
+        (*this * _other.cols[1]),
+        (*this * _other.cols[2]),
+        (*this * _other.cols[3]));
+#endif
 }
 
 inline void Matrix4::operator *=(const Matrix4& _other) {
@@ -464,7 +744,7 @@ inline void Matrix4::operator *=(const Matrix4& _other) {
 
 
 //PUBLIC MEMBER FUNCTIONS
-inline Matrix4 Matrix4::identity() {
+inline UTIL_CONSTEXPR Matrix4 Matrix4::identity() {
 
     return Matrix4(
         util::vec::Vector4::xVector(),
@@ -556,7 +836,130 @@ inline Matrix4 Matrix4::rotation(float _degrees,
         util::vec::Vector4(0.0f,   0.0f,   0.0f, 1.0f));
 }
 
-inline Matrix4 Matrix4::scale(const util::vec::Vector3& _scale) {
+inline Matrix4 Matrix4::rotation(const util::vec::Quaternion& _quat) {
+
+    float x = _quat.getX();
+    float y = _quat.getY();
+    float z = _quat.getZ();
+    float w = _quat.getW();
+
+    float x2 = x + x;
+    float y2 = y + y;
+    float z2 = z + z;
+
+    float xx = x * x2;
+    float yy = y * y2;
+    float zz = z * z2;
+    float xy = x * y2;
+    float xz = x * z2;
+    float yz = y * z2;
+    float wx = w * x2;
+    float wy = w * y2;
+    float wz = w * z2;
+
+    return Matrix4(
+        util::vec::Vector4(1.0f - (yy + zz), xy + wz, xz - wy, 0.0f),
+        util::vec::Vector4(xy - wz, 1.0f - (xx + zz), yz + wx, 0.0f),
+        util::vec::Vector4(xz + wy, yz - wx, 1.0f - (xx + yy), 0.0f),
+        util::vec::Vector4(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+inline util::vec::Quaternion Matrix4::toQuaternion(const Matrix4& _other) {
+
+    float m00 = _other(0, 0);
+    float m11 = _other(1, 1);
+    float m22 = _other(2, 2);
+    float trace = (m00 + m11) + m22;
+
+    //divide by the largest of the four possible pivots to stay stable
+    if (trace > 0.0f) {
+
+        float s = sqrtf(trace + 1.0f) * 2.0f;
+
+        return util::vec::Quaternion(
+            (_other(1, 2) - _other(2, 1)) / s,
+            (_other(2, 0) - _other(0, 2)) / s,
+            (_other(0, 1) - _other(1, 0)) / s,
+            0.25f * s);
+    }
+    if (m00 > m11 && m00 > m22) {
+
+        float s = sqrtf(((1.0f + m00) - m11) - m22) * 2.0f;
+
+        return util::vec::Quaternion(
+            0.25f * s,
+            (_other(1, 0) + _other(0, 1)) / s,
+            (_other(2, 0) + _other(0, 2)) / s,
+            (_other(1, 2) - _other(2, 1)) / s);
+    }
+    if (m11 > m22) {
+
+        float s = sqrtf(((1.0f + m11) - m00) - m22) * 2.0f;
+
+        return util::vec::Quaternion(
+            (_other(1, 0) + _other(0, 1)) / s,
+            0.25f * s,
+            (_other(2, 1) + _other(1, 2)) / s,
+            (_other(2, 0) - _other(0, 2)) / s);
+    }
+
+    float s = sqrtf(((1.0f + m22) - m00) - m11) * 2.0f;
+
+    return util::vec::Quaternion(
+        (_other(2, 0) + _other(0, 2)) / s,
+        (_other(2, 1) + _other(1, 2)) / s,
+        0.25f * s,
+        (_other(0, 1) - _other(1, 0)) / s);
+}
+
+inline Matrix4 Matrix4::compose(const util::vec::Vector3& _translation,
+    const util::vec::Quaternion& _rotation,
+    const util::vec::Vector3& _scale) {
+
+    //the columns of the rotation are scaled and the translation is the last
+    //column
+    Matrix4 m = rotation(_rotation);
+    m.cols[0] *= _scale.getX();
+    m.cols[1] *= _scale.getY();
+    m.cols[2] *= _scale.getZ();
+    m.cols[3] = util::vec::Vector4(_translation.getX(), _translation.getY(),
+        _translation.getZ(), 1.0f);
+
+    return m;
+}
+
+inline void Matrix4::decompose(const Matrix4& _other,
+    util::vec::Vector3& _translation, util::vec::Quaternion& _rotation,
+    util::vec::Vector3& _scale) {
+
+    const float* m = _other.data();
+
+    _translation = util::vec::Vector3(m[12], m[13], m[14]);
+
+    float sx = sqrtf((m[0] * m[0]) + (m[1] * m[1]) + (m[2] * m[2]));
+    float sy = sqrtf((m[4] * m[4]) + (m[5] * m[5]) + (m[6] * m[6]));
+    float sz = sqrtf((m[8] * m[8]) + (m[9] * m[9]) + (m[10] * m[10]));
+
+    //a negative determinant means the matrix mirrors, which a rotation
+    //cannot do so one axis takes a negative scale
+    float det =
+        (m[0] * ((m[5] * m[10]) - (m[9] * m[6]))) -
+        (m[4] * ((m[1] * m[10]) - (m[9] * m[2]))) +
+        (m[8] * ((m[1] * m[6]) - (m[5] * m[2])));
+    if (det < 0.0f) {
+
+        sx = -sx;
+    }
+    _scale = util::vec::Vector3(sx, sy, sz);
+
+    Matrix4 r;
+    r.cols[0] = _other.cols[0] * (1.0f / sx);
+    r.cols[1] = _other.cols[1] * (1.0f / sy);
+    r.cols[2] = _other.cols[2] * (1.0f / sz);
+    _rotation = toQuaternion(r);
+}
+
+inline UTIL_CONSTEXPR Matrix4 Matrix4::scale(const util::vec::Vector3& _scale) {
 
     return Matrix4(
         util::vec::Vector4(_scale.getX(), 0.0f,          0.0f,         0.0f),
@@ -565,7 +968,8 @@ inline Matrix4 Matrix4::scale(const util::vec::Vector3& _scale) {
         util::vec::Vector4::wVector());
 }
 
-inline Matrix4 Matrix4::translation(const util::vec::Vector3& _translation) {
+inline UTIL_CONSTEXPR Matrix4 Matrix4::translation(
+    const util::vec::Vector3& _translation) {
 
     return Matrix4(
         util::vec::Vector4::xVector(),
@@ -600,46 +1004,95 @@ inline Matrix4 Matrix4::perspective(float _fov, float _aspectRatio,
 inline Matrix4 Matrix4::frustum(float _left, float _right, float _bottom,
     float _top, float _zNear, float _zFar) {
 
-    //TODO:
+    float width = _right - _left;
+    float height = _top - _bottom;
+    float depth = _zFar - _zNear;
+
+    return Matrix4(
+        util::vec::Vector4(((2.0f * _zNear) / width), 0.0f, 0.0f, 0.0f),
+        util::vec::Vector4(0.0f, ((2.0f * _zNear) / height), 0.0f, 0.0f),
+        util::vec::Vector4(((_right + _left) / width),
+            ((_top + _bottom) / height), (-(_zFar + _zNear) / depth), -1.0f),
+        util::vec::Vector4(0.0f, 0.0f,
+            (-((2.0f * _zFar) * _zNear) / depth), 0.0f));
 }
 
 inline Matrix4 Matrix4::orthographic(float _left, float _right, float _bottom,
     float _top, float _zNear, float _zFar) {
 
-    //TODO:
+    float width = _right - _left;
+    float height = _top - _bottom;
+    float depth = _zFar - _zNear;
+
+    return Matrix4(
+        util::vec::Vector4((2.0f / width), 0.0f, 0.0f, 0.0f),
+        util::vec::Vector4(0.0f, (2.0f / height), 0.0f, 0.0f),
+        util::vec::Vector4(0.0f, 0.0f, (-2.0f / depth), 0.0f),
+        util::vec::Vector4((-(_right + _left) / width),
+            (-(_top + _bottom) / height), (-(_zFar + _zNear) / depth),
+            1.0f));
 }
 
-inline Matrix4 Matrix4::transpose(const Matrix4& _other) {
+inline UTIL_CONSTEXPR Matrix4 Matrix4::transpose(const Matrix4& _other) {
+
+    //the getters are used rather than data() so this can be evaluated at
+    //compile time
+    const util::vec::Vector4* c = _other.cols;
 
     return Matrix4(
-        util::vec::Vector4(_other[0][0], _other[1][0],
-            _other[2][0], _other[3][0]),
-        util::vec::Vector4(_other[0][1], _other[1][1],
-            _other[2][1], _other[3][1]),
-        util::vec::Vector4(_other[0][2], _other[1][2],
-            _other[2][2], _other[3][2]),
-        util::vec::Vector4(_other[0][3], _other[1][3],
-            _other[2][3], _other[3][3]));
+        util::vec::Vector4(c[0].getX(), c[1].getX(),
+            c[2].getX(), c[3].getX()),
+        util::vec::Vector4(c[0].getY(), c[1].getY(),
+            c[2].getY(), c[3].getY()),
+        util::vec::Vector4(c[0].getZ(), c[1].getZ(),
+            c[2].getZ(), c[3].getZ()),
+        util::vec::Vector4(c[0].getW(), c[1].getW(),
+            c[2].getW(), c[3].getW()));
+}
+
+inline UTIL_CONSTEXPR Matrix4 Matrix4::multiply(const Matrix4& _a,
+    const Matrix4& _b) {
+
+    const util::vec::Vector4* a = _a.cols;
+
+    Matrix4 r;
+    for (unsigned i = 0; i < 4; ++i) {
+
+        //each column of the result is the columns of a weighted by the
+        //values of the matching column of b
+        const util::vec::Vector4& b = _b.cols[i];
+        r.cols[i] = util::vec::Vector4(
+            (a[0].getX() * b.getX()) + (a[1].getX() * b.getY()) +
+            (a[2].getX() * b.getZ()) + (a[3].getX() * b.getW()),
+            (a[0].getY() * b.getX()) + (a[1].getY() * b.getY()) +
+            (a[2].getY() * b.getZ()) + (a[3].getY() * b.getW()),
+            (a[0].getZ() * b.getX()) + (a[1].getZ() * b.getY()) +
+            (a[2].getZ() * b.getZ()) + (a[3].getZ() * b.getW()),
+            (a[0].getW() * b.getX()) + (a[1].getW() * b.getY()) +
+            (a[2].getW() * b.getZ()) + (a[3].getW() * b.getW()));
+    }
+
+    return r;
 }
 
 inline Matrix4 Matrix4::inverse(const Matrix4& _other) {
 
-    float mA = _other[0][0];
-    float mB = _other[0][1];
-    float mC = _other[0][2];
-    float mD = _other[0][3];
-    float mE = _other[0][0];
-    float mF = _other[0][1];
-    float mG = _other[0][2];
-    float mH = _other[0][3];
-    float mI = _other[0][0];
-    float mJ = _other[0][1];
-    float mK = _other[0][2];
-    float mL = _other[0][3];
-    float mM = _other[0][0];
-    float mN = _other[0][1];
-    float mO = _other[0][2];
-    float mP = _other[0][3];
+    float mA = _other(0, 0);
+    float mB = _other(0, 1);
+    float mC = _other(0, 2);
+    float mD = _other(0, 3);
+    float mE = _other(1, 0);
+    float mF = _other(1, 1);
+    float mG = _other(1, 2);
+    float mH = _other(1, 3);
+    float mI = _other(2, 0);
+    float mJ = _other(2, 1);
+    float mK = _other(2, 2);
+    float mL = _other(2, 3);
+    float mM = _other(3, 0);
+    float mN = _other(3, 1);
+    float mO = _other(3, 2);
+    float mP = _other(3, 3);
 
     float temp0 = ((mK * mD) - (mC * mL));
     float temp1 = ((mO * mH) - (mG * mP));
@@ -702,24 +1155,164 @@ inline Matrix4 Matrix4::inverse(const Matrix4& _other) {
         (res3 * detInv));
 }
 
+inline Matrix4 Matrix4::inverse(const Matrix4& _other, m4::Type _type) {
+
+    switch (_type) {
+
+        case m4::RIGID: {
+
+            return inverseRigid(_other);
+        }
+        case m4::AFFINE: {
+
+            return inverseAffine(_other);
+        }
+        default: {
+
+            return inverse(_other);
+        }
+    }
+}
+
+inline void Matrix4::inverse(const Matrix4* _in, Matrix4* _out,
+    unsigned _count) {
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        _out[i] = inverse(_in[i], classify(_in[i]));
+    }
+}
+
+inline void Matrix4::inverse(const Matrix4* _in, Matrix4* _out,
+    unsigned _count, m4::Type _type) {
+
+    //a rigid inverse is only a transpose so it is already cheaper than the
+    //cofactor expansion, affine matrices are general matrices with a known
+    //bottom row
+    if (_type == m4::RIGID) {
+
+        for (unsigned i = 0; i < _count; ++i) {
+
+            _out[i] = inverseRigid(_in[i]);
+        }
+        return;
+    }
+
+    cofactorBatch(_in, _out, NULL, _count);
+}
+
+inline Matrix4 Matrix4::inverseAffine(const Matrix4& _other) {
+
+    //the columns of the 3x3 part
+    float aX = _other(0, 0);
+    float aY = _other(0, 1);
+    float aZ = _other(0, 2);
+    float bX = _other(1, 0);
+    float bY = _other(1, 1);
+    float bZ = _other(1, 2);
+    float cX = _other(2, 0);
+    float cY = _other(2, 1);
+    float cZ = _other(2, 2);
+
+    //the rows of the inverse are the cross products of the columns
+    float r0X = (bY * cZ) - (bZ * cY);
+    float r0Y = (bZ * cX) - (bX * cZ);
+    float r0Z = (bX * cY) - (bY * cX);
+    float r1X = (cY * aZ) - (cZ * aY);
+    float r1Y = (cZ * aX) - (cX * aZ);
+    float r1Z = (cX * aY) - (cY * aX);
+    float r2X = (aY * bZ) - (aZ * bY);
+    float r2Y = (aZ * bX) - (aX * bZ);
+    float r2Z = (aX * bY) - (aY * bX);
+
+    float detInv = 1.0f / (((aX * r0X) + (aY * r0Y)) + (aZ * r0Z));
+
+    util::vec::Vector4 res0(r0X * detInv, r1X * detInv, r2X * detInv, 0.0f);
+    util::vec::Vector4 res1(r0Y * detInv, r1Y * detInv, r2Y * detInv, 0.0f);
+    util::vec::Vector4 res2(r0Z * detInv, r1Z * detInv, r2Z * detInv, 0.0f);
+
+    //move the translation back through the inversed 3x3 part
+    util::vec::Vector4 res3 = -(
+        ((res0 * _other(3, 0)) + (res1 * _other(3, 1))) +
+        (res2 * _other(3, 2)));
+    res3.setW(1.0f);
+
+    return Matrix4(res0, res1, res2, res3);
+}
+
+inline Matrix4 Matrix4::inverseRigid(const Matrix4& _other) {
+
+    //transposing the 3x3 part with a zero fourth column leaves zeroes in the
+    //w values of the new columns
+    util::simd::Float4 res0 = _other.cols[0].toSimd();
+    util::simd::Float4 res1 = _other.cols[1].toSimd();
+    util::simd::Float4 res2 = _other.cols[2].toSimd();
+    util::simd::Float4 res3 = util::simd::splat(0.0f);
+    util::simd::transpose(res0, res1, res2, res3);
+
+    //rotate the translation by the transpose and negate it
+    util::simd::Float4 t = _other.cols[3].toSimd();
+    res3 = util::simd::negate(util::simd::add(util::simd::add(
+        util::simd::mul(res0, util::simd::splatLane<0>(t)),
+        util::simd::mul(res1, util::simd::splatLane<1>(t))),
+        util::simd::mul(res2, util::simd::splatLane<2>(t))));
+    res3 = util::simd::add(res3, util::simd::set(0.0f, 0.0f, 0.0f, 1.0f));
+
+    return Matrix4(
+        util::vec::Vector4(res0),
+        util::vec::Vector4(res1),
+        util::vec::Vector4(res2),
+        util::vec::Vector4(res3));
+}
+
+inline m4::Type Matrix4::classify(const Matrix4& _other, float _tolerance) {
+
+    //the bottom row has to be 0 0 0 1 for any of the cheaper paths
+    if (fabs(_other(0, 3)) > _tolerance ||
+        fabs(_other(1, 3)) > _tolerance ||
+        fabs(_other(2, 3)) > _tolerance ||
+        fabs(_other(3, 3) - 1.0f) > _tolerance) {
+
+        return m4::GENERAL;
+    }
+
+    //the 3x3 part is orthonormal if the dot products of its columns with
+    //each other form the identity matrix
+    for (unsigned i = 0; i < 3; ++i) {
+
+        for (unsigned j = i; j < 3; ++j) {
+
+            float d = ((_other(i, 0) * _other(j, 0)) +
+                (_other(i, 1) * _other(j, 1))) + (_other(i, 2) * _other(j, 2));
+
+            if (fabs(d - ((i == j) ? 1.0f : 0.0f)) > _tolerance) {
+
+                return m4::AFFINE;
+            }
+        }
+    }
+
+    return m4::RIGID;
+}
+
 inline float Matrix4::determinant(const Matrix4& _other) {
 
-    float mA = _other[0][0];
-    float mB = _other[0][1];
-    float mC = _other[0][2];
-    float mD = _other[0][3];
-    float mE = _other[0][0];
-    float mF = _other[0][1];
-    float mG = _other[0][2];
-    float mH = _other[0][3];
-    float mI = _other[0][0];
-    float mJ = _other[0][1];
-    float mK = _other[0][2];
-    float mL = _other[0][3];
-    float mM = _other[0][0];
-    float mN = _other[0][1];
-    float mO = _other[0][2];
-    float mP = _other[0][3];
+    float mA = _other(0, 0);
+    float mB = _other(0, 1);
+    float mC = _other(0, 2);
+    float mD = _other(0, 3);
+    float mE = _other(1, 0);
+    float mF = _other(1, 1);
+    float mG = _other(1, 2);
+    float mH = _other(1, 3);
+    float mI = _other(2, 0);
+    float mJ = _other(2, 1);
+    float mK = _other(2, 2);
+    float mL = _other(2, 3);
+    float mM = _other(3, 0);
+    float mN = _other(3, 1);
+    float mO = _other(3, 2);
+    float mP = _other(3, 3);
 
     float temp0 = ((mK * mD) - (mC * mL));
     float temp1 = ((mO * mH) - (mG * mP));
@@ -736,37 +1329,87 @@ inline float Matrix4::determinant(const Matrix4& _other) {
     return ((((mA * dx) + (mE * dy)) + (mI * dz)) + (mM * dw));
 }
 
-inline void Matrix4::setCol(unsigned _index, const util::vec::Vector4& _col) {
+inline void Matrix4::determinant(const Matrix4* _in, float* _out,
+    unsigned _count) {
 
-    //check that the index is within bounds
-    if (_index > 3) {
+    cofactorBatch(_in, NULL, _out, _count);
+}
 
-        throw util::ex::IndexOutOfBoundsException("index is greater than 3.");
-    }
+inline void Matrix4::transform(const Matrix4& _m,
+    const util::vec::Vector4* _in, util::vec::Vector4* _out,
+    unsigned _count) {
 
-    switch (_index) {
+    util::simd::Float4 c0 = _m.cols[0].toSimd();
+    util::simd::Float4 c1 = _m.cols[1].toSimd();
+    util::simd::Float4 c2 = _m.cols[2].toSimd();
+    util::simd::Float4 c3 = _m.cols[3].toSimd();
+    util::simd::cpu::Level level = util::simd::level();
 
-        case 0: {
+    //the widest kernel the processor supports takes as many vectors as it
+    //can and the rest fall through to the narrower loops
+    unsigned i = 0;
+#if defined(UTIL_SIMD_DISPATCH)
 
-            col0 = _col;
-            break;
-        }
-        case 1: {
+    if (level == util::simd::cpu::AVX512) {
 
-            col1 = _col;
-            break;
-        }
-        case 2: {
+        i = transformAvx512(_m, _in, _out, _count);
+    }
+    else if (level == util::simd::cpu::AVX2) {
 
-            col2 = _col;
-            break;
+        i = transformAvx2(_m, _in, _out, _count);
+    }
+#endif
+
+    //four independent vectors are transformed per iteration so their
+    //multiplies and adds can be interleaved
+    for (; level != util::simd::cpu::SCALAR && i + 4 <= _count; i += 4) {
+
+        util::simd::Float4 r[4];
+        for (unsigned j = 0; j < 4; ++j) {
+
+            util::simd::Float4 v = _in[i + j].toSimd();
+            r[j] = util::simd::add(
+                util::simd::add(
+                    util::simd::mul(c0, util::simd::splatLane<0>(v)),
+                    util::simd::mul(c1, util::simd::splatLane<1>(v))),
+                util::simd::add(
+                    util::simd::mul(c2, util::simd::splatLane<2>(v)),
+                    util::simd::mul(c3, util::simd::splatLane<3>(v))));
         }
-        default: {
+        for (unsigned j = 0; j < 4; ++j) {
 
-            col3 = _col;
-            break;
+            _out[i + j] = util::vec::Vector4(r[j]);
         }
     }
+    for (; i < _count; ++i) {
+
+        _out[i] = _m * _in[i];
+    }
+}
+
+inline void Matrix4::transformPoints(const Matrix4& _m,
+    const util::vec::Vector3* _in, util::vec::Vector3* _out,
+    unsigned _count) {
+
+    transformVector3(_m, _in, _out, _count, 1.0f);
+}
+
+inline void Matrix4::transformDirections(const Matrix4& _m,
+    const util::vec::Vector3* _in, util::vec::Vector3* _out,
+    unsigned _count) {
+
+    transformVector3(_m, _in, _out, _count, 0.0f);
+}
+
+inline void Matrix4::setCol(unsigned _index, const util::vec::Vector4& _col) {
+
+    //check that the index is within bounds
+    if (_index > 3) {
+
+        throw util::ex::IndexOutOfBoundsException("index is greater than 3.");
+    }
+
+    cols[_index] = _col;
 }
 
 inline void Matrix4::setRow(unsigned _index, const util::vec::Vector4& _row) {
@@ -777,30 +1420,30 @@ inline void Matrix4::setRow(unsigned _index, const util::vec::Vector4& _row) {
         throw util::ex::IndexOutOfBoundsException("index is greater than 3.");
     }
 
-    col0[_index] = _row.getX();
-    col1[_index] = _row.getY();
-    col2[_index] = _row.getZ();
-    col3[_index] = _row.getW();
+    cols[0][_index] = _row.getX();
+    cols[1][_index] = _row.getY();
+    cols[2][_index] = _row.getZ();
+    cols[3][_index] = _row.getW();
 }
 
 inline void Matrix4::setCol0(const util::vec::Vector4& _col) {
 
-    col0 = _col;
+    cols[0] = _col;
 }
 
 inline void Matrix4::setCol1(const util::vec::Vector4& _col) {
 
-    col1 = _col;
+    cols[1] = _col;
 }
 
 inline void Matrix4::setCol2(const util::vec::Vector4& _col) {
 
-    col2 = _col;
+    cols[2] = _col;
 }
 
 inline void Matrix4::setCol3(const util::vec::Vector4& _col) {
 
-    col3 = _col;
+    cols[3] = _col;
 }
 
 inline void Matrix4::setElement(unsigned _col, unsigned _row, float _value) {
@@ -817,36 +1460,14 @@ inline void Matrix4::setElement(unsigned _col, unsigned _row, float _value) {
             "row index is greater than 3.");
     }
 
-    switch (_col) {
-
-        case 0: {
-
-            col0[_row] = _value;
-            break;
-        }
-        case 1: {
-
-            col1[_row] = _value;
-            break;
-        }
-        case 2: {
-
-            col2[_row] = _value;
-            break;
-        }
-        default: {
-
-            col3[_row] = _value;
-            break;
-        }
-    }
+    cols[_col][_row] = _value;
 }
 
 inline void Matrix4::setTranslation(const util::vec::Vector3& _translateVec) {
 
-    col3.setX(_translateVec.getX());
-    col3.setY(_translateVec.getY());
-    col3.setZ(_translateVec.getZ());
+    cols[3].setX(_translateVec.getX());
+    cols[3].setY(_translateVec.getY());
+    cols[3].setZ(_translateVec.getZ());
 }
 
 inline const util::vec::Vector4& Matrix4::getCol(unsigned _index) const {
@@ -857,51 +1478,33 @@ inline const util::vec::Vector4& Matrix4::getCol(unsigned _index) const {
         throw util::ex::IndexOutOfBoundsException("index is greater than 3.");
     }
 
-    switch (_index) {
-
-        case 0: {
-
-            return col0;
-        }
-        case 1: {
-
-            return col1;
-        }
-        case 2: {
-
-            return col2;
-        }
-        default: {
-
-            return col3;
-        }
-    }
+    return cols[_index];
 }
 
 inline util::vec::Vector4 Matrix4::getRow(unsigned _index) const {
 
-    return util::vec::Vector4(col0[_index], col1[_index],
-        col2[_index], col3[_index]);
+    return util::vec::Vector4(cols[0][_index], cols[1][_index],
+        cols[2][_index], cols[3][_index]);
 }
 
 inline const util::vec::Vector4& Matrix4::getCol0() const {
 
-    return col0;
+    return cols[0];
 }
 
 inline const util::vec::Vector4& Matrix4::getCol1() const {
 
-    return col1;
+    return cols[1];
 }
 
 inline const util::vec::Vector4& Matrix4::getCol2() const {
 
-    return col2;
+    return cols[2];
 }
 
 inline const util::vec::Vector4& Matrix4::getCol3() const {
 
-    return col3;
+    return cols[3];
 }
 
 inline float Matrix4::getElement(unsigned _row, unsigned _col) const {
@@ -918,31 +1521,546 @@ inline float Matrix4::getElement(unsigned _row, unsigned _col) const {
             "row index is greater than 3.");
     }
 
-    switch (_col) {
+    return cols[_col][_row];
+}
+
+inline util::vec::Vector3 Matrix4::getTranslation() const {
+
+    return util::vec::Vector3(cols[3].getX(), cols[3].getY(), cols[3].getZ());
+}
+
+inline float* Matrix4::data() {
+
+    return reinterpret_cast<float*>(cols);
+}
+
+inline const float* Matrix4::data() const {
+
+    return reinterpret_cast<const float*>(cols);
+}
+
+//PRIVATE MEMBER FUNCTIONS
+inline void Matrix4::transformVector3(const Matrix4& _m,
+    const util::vec::Vector3* _in, util::vec::Vector3* _out,
+    unsigned _count, float _w) {
+
+    //the top three rows of the matrix, the translation is pre-multiplied by w
+    float e[3][4];
+    for (unsigned row = 0; row < 3; ++row) {
+
+        e[row][0] = _m(0, row);
+        e[row][1] = _m(1, row);
+        e[row][2] = _m(2, row);
+        e[row][3] = _m(3, row) * _w;
+    }
+
+    unsigned i = 0;
+#if defined(UTIL_SIMD_SSE) || defined(UTIL_SIMD_NEON)
+
+    //a Vector3 is three packed floats so four of them are twelve floats that
+    //are loaded and split into separate x, y and z registers
+    const float* in = reinterpret_cast<const float*>(_in);
+    float* out = reinterpret_cast<float*>(_out);
+
+    util::simd::Float4 m[3][4];
+    for (unsigned row = 0; row < 3; ++row) {
+
+        for (unsigned col = 0; col < 4; ++col) {
+
+            m[row][col] = util::simd::splat(e[row][col]);
+        }
+    }
+
+    for (; i + 4 <= _count; i += 4) {
+
+        util::simd::Float4 v[3];
+#   if defined(UTIL_SIMD_SSE)
+
+        __m128 a = _mm_loadu_ps(in + (i * 3));
+        __m128 b = _mm_loadu_ps(in + (i * 3) + 4);
+        __m128 c = _mm_loadu_ps(in + (i * 3) + 8);
+
+        v[0] = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)),
+            _MM_SHUFFLE(2, 0, 3, 0));
+        v[1] = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+            _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)),
+            _MM_SHUFFLE(2, 0, 2, 0));
+        v[2] = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c,
+            _MM_SHUFFLE(3, 0, 2, 0));
+#   else
+
+        float32x4x3_t xyz = vld3q_f32(in + (i * 3));
+        v[0] = xyz.val[0];
+        v[1] = xyz.val[1];
+        v[2] = xyz.val[2];
+#   endif
+
+        util::simd::Float4 r[3];
+        for (unsigned row = 0; row < 3; ++row) {
+
+            r[row] = util::simd::add(
+                util::simd::add(util::simd::mul(m[row][0], v[0]),
+                    util::simd::mul(m[row][1], v[1])),
+                util::simd::add(util::simd::mul(m[row][2], v[2]),
+                    m[row][3]));
+        }
+
+#   if defined(UTIL_SIMD_SSE)
+
+        _mm_storeu_ps(out + (i * 3), _mm_shuffle_ps(
+            _mm_shuffle_ps(r[0], r[1], _MM_SHUFFLE(0, 0, 0, 0)),
+            _mm_shuffle_ps(r[2], r[0], _MM_SHUFFLE(1, 1, 0, 0)),
+            _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(out + (i * 3) + 4, _mm_shuffle_ps(
+            _mm_shuffle_ps(r[1], r[2], _MM_SHUFFLE(1, 1, 1, 1)),
+            _mm_shuffle_ps(r[0], r[1], _MM_SHUFFLE(2, 2, 2, 2)),
+            _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(out + (i * 3) + 8, _mm_shuffle_ps(
+            _mm_shuffle_ps(r[2], r[0], _MM_SHUFFLE(3, 3, 2, 2)),
+            _mm_shuffle_ps(r[1], r[2], _MM_SHUFFLE(3, 3, 3, 3)),
+            _MM_SHUFFLE(2, 0, 2, 0)));
+#   else
+
+        xyz.val[0] = r[0];
+        xyz.val[1] = r[1];
+        xyz.val[2] = r[2];
+        vst3q_f32(out + (i * 3), xyz);
+#   endif
+    }
+#endif
+
+    for (; i < _count; ++i) {
+
+        float x = _in[i].getX();
+        float y = _in[i].getY();
+        float z = _in[i].getZ();
 
-        case 0: {
+        float r[3];
+        for (unsigned row = 0; row < 3; ++row) {
 
-            return col0[_row];
+            r[row] = (((e[row][0] * x) + (e[row][1] * y)) +
+                (e[row][2] * z)) + e[row][3];
         }
-        case 1: {
 
-            return col1[_row];
+        _out[i].set(r[0], r[1], r[2]);
+    }
+}
+
+inline void Matrix4::cofactorBatch(const Matrix4* _in, Matrix4* _out,
+    float* _determinants, unsigned _count) {
+
+    util::simd::cpu::Level level = util::simd::level();
+
+    unsigned i = 0;
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (level >= util::simd::cpu::AVX2) {
+
+        i = cofactorBatchAvx2(_in, _out, _determinants, _count);
+    }
+#endif
+    if (level != util::simd::cpu::SCALAR) {
+
+        util::simd::Float4 one = util::simd::splat(1.0f);
+
+        for (; i + 4 <= _count; i += 4) {
+
+            //transposing a column of the four matrices gives one register
+            //per element of the column
+            util::simd::Float4 m[16];
+            for (unsigned col = 0; col < 4; ++col) {
+
+                util::simd::Float4* e = m + (col * 4);
+                e[0] = _in[i].cols[col].toSimd();
+                e[1] = _in[i + 1].cols[col].toSimd();
+                e[2] = _in[i + 2].cols[col].toSimd();
+                e[3] = _in[i + 3].cols[col].toSimd();
+                util::simd::transpose(e[0], e[1], e[2], e[3]);
+            }
+
+            util::simd::Float4 r[16];
+            util::simd::Float4 det = adjugate(m, r, _out != NULL);
+
+            if (_determinants != NULL) {
+
+                util::simd::store(_determinants + i, det);
+            }
+            if (_out != NULL) {
+
+                util::simd::Float4 detInv = util::simd::div(one, det);
+                for (unsigned col = 0; col < 4; ++col) {
+
+                    util::simd::Float4 e0 = util::simd::mul(r[col * 4], detInv);
+                    util::simd::Float4 e1 =
+                        util::simd::mul(r[(col * 4) + 1], detInv);
+                    util::simd::Float4 e2 =
+                        util::simd::mul(r[(col * 4) + 2], detInv);
+                    util::simd::Float4 e3 =
+                        util::simd::mul(r[(col * 4) + 3], detInv);
+                    util::simd::transpose(e0, e1, e2, e3);
+                    util::simd::store(_out[i].data() + (col * 4), e0);
+                    util::simd::store(_out[i + 1].data() + (col * 4), e1);
+                    util::simd::store(_out[i + 2].data() + (col * 4), e2);
+                    util::simd::store(_out[i + 3].data() + (col * 4), e3);
+                }
+            }
         }
-        case 2: {
+    }
+    for (; i < _count; ++i) {
 
-            return col2[_row];
+        if (_determinants != NULL) {
+
+            _determinants[i] = determinant(_in[i]);
         }
-        default: {
+        if (_out != NULL) {
 
-            return col3[_row];
+            _out[i] = inverse(_in[i]);
         }
     }
 }
 
-inline util::vec::Vector3 Matrix4::getTranslation() const {
+inline util::simd::Float4 Matrix4::adjugate(const util::simd::Float4* _m,
+    util::simd::Float4* _r, bool _full) {
+
+    //the same expansion as inverse() with each element of one matrix
+    //replaced by a register of the element of four matrices
+    const util::simd::Float4& mA = _m[0];
+    const util::simd::Float4& mB = _m[1];
+    const util::simd::Float4& mC = _m[2];
+    const util::simd::Float4& mD = _m[3];
+    const util::simd::Float4& mE = _m[4];
+    const util::simd::Float4& mF = _m[5];
+    const util::simd::Float4& mG = _m[6];
+    const util::simd::Float4& mH = _m[7];
+    const util::simd::Float4& mI = _m[8];
+    const util::simd::Float4& mJ = _m[9];
+    const util::simd::Float4& mK = _m[10];
+    const util::simd::Float4& mL = _m[11];
+    const util::simd::Float4& mM = _m[12];
+    const util::simd::Float4& mN = _m[13];
+    const util::simd::Float4& mO = _m[14];
+    const util::simd::Float4& mP = _m[15];
+
+    util::simd::Float4 temp0 = mulSub(mK, mD, mC, mL);
+    util::simd::Float4 temp1 = mulSub(mO, mH, mG, mP);
+    util::simd::Float4 temp2 = mulSub(mB, mK, mJ, mC);
+    util::simd::Float4 temp3 = mulSub(mF, mO, mN, mG);
+    util::simd::Float4 temp4 = mulSub(mJ, mD, mB, mL);
+    util::simd::Float4 temp5 = mulSub(mN, mH, mF, mP);
+
+    _r[0] = util::simd::sub(mulSub(mJ, temp1, mL, temp3),
+        util::simd::mul(mK, temp5));
+    _r[1] = util::simd::sub(mulSub(mN, temp0, mP, temp2),
+        util::simd::mul(mO, temp4));
+    _r[2] = util::simd::sub(util::simd::add(util::simd::mul(mD, temp3),
+        util::simd::mul(mC, temp5)), util::simd::mul(mB, temp1));
+    _r[3] = util::simd::sub(util::simd::add(util::simd::mul(mH, temp2),
+        util::simd::mul(mG, temp4)), util::simd::mul(mF, temp0));
+
+    util::simd::Float4 det = util::simd::add(util::simd::add(
+        util::simd::mul(mA, _r[0]), util::simd::mul(mE, _r[1])),
+        util::simd::add(util::simd::mul(mI, _r[2]),
+        util::simd::mul(mM, _r[3])));
+
+    if (!_full) {
+
+        return det;
+    }
+
+    util::simd::Float4 temp6 = mulSub(mI, mB, mA, mJ);
+    util::simd::Float4 temp7 = mulSub(mM, mF, mE, mN);
+    util::simd::Float4 temp8 = mulSub(mI, mD, mA, mL);
+    util::simd::Float4 temp9 = mulSub(mM, mH, mE, mP);
+    util::simd::Float4 temp10 = mulSub(mI, mC, mA, mK);
+    util::simd::Float4 temp11 = mulSub(mM, mG, mE, mO);
+
+    _r[4] = util::simd::sub(mulSub(mK, temp9, mL, temp11),
+        util::simd::mul(mI, temp1));
+    _r[5] = util::simd::sub(mulSub(mO, temp8, mP, temp10),
+        util::simd::mul(mM, temp0));
+    _r[6] = util::simd::add(mulSub(mD, temp11, mC, temp9),
+        util::simd::mul(mA, temp1));
+    _r[7] = util::simd::add(mulSub(mH, temp10, mG, temp8),
+        util::simd::mul(mE, temp0));
+
+    _r[8] = util::simd::add(mulSub(mL, temp7, mJ, temp9),
+        util::simd::mul(mI, temp5));
+    _r[9] = util::simd::add(mulSub(mP, temp6, mN, temp8),
+        util::simd::mul(mM, temp4));
+    _r[10] = util::simd::sub(mulSub(mB, temp9, mD, temp7),
+        util::simd::mul(mA, temp5));
+    _r[11] = util::simd::sub(mulSub(mF, temp8, mH, temp6),
+        util::simd::mul(mE, temp4));
+
+    _r[12] = util::simd::add(mulSub(mJ, temp11, mK, temp7),
+        util::simd::mul(mI, temp3));
+    _r[13] = util::simd::add(mulSub(mN, temp10, mO, temp6),
+        util::simd::mul(mM, temp2));
+    _r[14] = util::simd::sub(mulSub(mC, temp7, mB, temp11),
+        util::simd::mul(mA, temp3));
+    _r[15] = util::simd::sub(mulSub(mG, temp6, mF, temp10),
+        util::simd::mul(mE, temp2));
+
+    return det;
+}
+
+inline util::simd::Float4 Matrix4::mulSub(util::simd::Float4 _a,
+    util::simd::Float4 _b, util::simd::Float4 _c, util::simd::Float4 _d) {
+
+    return util::simd::sub(util::simd::mul(_a, _b), util::simd::mul(_c, _d));
+}
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline unsigned Matrix4::transformAvx2(const Matrix4& _m,
+    const util::vec::Vector4* _in, util::vec::Vector4* _out,
+    unsigned _count) {
+
+    //each register holds two vectors so every column is repeated in both
+    //halves
+    __m256 c[4];
+    for (unsigned j = 0; j < 4; ++j) {
+
+        __m128 col = _m.cols[j].toSimd();
+        c[j] = _mm256_insertf128_ps(_mm256_castps128_ps256(col), col, 1);
+    }
+
+    const float* in = reinterpret_cast<const float*>(_in);
+    float* out = reinterpret_cast<float*>(_out);
+
+    unsigned i = 0;
+    for (; i + 4 <= _count; i += 4) {
+
+        __m256 v[2] = {_mm256_loadu_ps(in + (i * 4)),
+                       _mm256_loadu_ps(in + (i * 4) + 8)};
+        for (unsigned j = 0; j < 2; ++j) {
+
+            __m256 r = _mm256_mul_ps(c[0],
+                _mm256_permute_ps(v[j], _MM_SHUFFLE(0, 0, 0, 0)));
+            r = _mm256_fmadd_ps(c[1],
+                _mm256_permute_ps(v[j], _MM_SHUFFLE(1, 1, 1, 1)), r);
+            r = _mm256_fmadd_ps(c[2],
+                _mm256_permute_ps(v[j], _MM_SHUFFLE(2, 2, 2, 2)), r);
+            r = _mm256_fmadd_ps(c[3],
+                _mm256_permute_ps(v[j], _MM_SHUFFLE(3, 3, 3, 3)), r);
+
+            _mm256_storeu_ps(out + (i * 4) + (j * 8), r);
+        }
+    }
+
+    return i;
+}
+
+UTIL_SIMD_TARGET("avx512f")
+inline unsigned Matrix4::transformAvx512(const Matrix4& _m,
+    const util::vec::Vector4* _in, util::vec::Vector4* _out,
+    unsigned _count) {
+
+    //each register holds four vectors so every column is repeated in all
+    //four quarters
+    __m512 c[4];
+    for (unsigned j = 0; j < 4; ++j) {
+
+        c[j] = _mm512_broadcast_f32x4(_m.cols[j].toSimd());
+    }
+
+    const float* in = reinterpret_cast<const float*>(_in);
+    float* out = reinterpret_cast<float*>(_out);
+
+    unsigned i = 0;
+    for (; i + 8 <= _count; i += 8) {
+
+        __m512 v[2] = {_mm512_loadu_ps(in + (i * 4)),
+                       _mm512_loadu_ps(in + (i * 4) + 16)};
+        for (unsigned j = 0; j < 2; ++j) {
+
+            __m512 r = _mm512_mul_ps(c[0],
+                _mm512_permute_ps(v[j], _MM_SHUFFLE(0, 0, 0, 0)));
+            r = _mm512_fmadd_ps(c[1],
+                _mm512_permute_ps(v[j], _MM_SHUFFLE(1, 1, 1, 1)), r);
+            r = _mm512_fmadd_ps(c[2],
+                _mm512_permute_ps(v[j], _MM_SHUFFLE(2, 2, 2, 2)), r);
+            r = _mm512_fmadd_ps(c[3],
+                _mm512_permute_ps(v[j], _MM_SHUFFLE(3, 3, 3, 3)), r);
+
+            _mm512_storeu_ps(out + (i * 4) + (j * 16), r);
+        }
+    }
+
+    return i;
+}
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline unsigned Matrix4::cofactorBatchAvx2(const Matrix4* _in, Matrix4* _out,
+    float* _determinants, unsigned _count) {
+
+    __m256 one = _mm256_set1_ps(1.0f);
+
+    unsigned i = 0;
+    for (; i + 8 <= _count; i += 8) {
+
+        //the low halves hold the first four matrices and the high halves the
+        //last four
+        __m256 m[16];
+        for (unsigned col = 0; col < 4; ++col) {
+
+            __m256* e = m + (col * 4);
+            e[0] = loadPairAvx2(_in[i].data() + (col * 4),
+                _in[i + 4].data() + (col * 4));
+            e[1] = loadPairAvx2(_in[i + 1].data() + (col * 4),
+                _in[i + 5].data() + (col * 4));
+            e[2] = loadPairAvx2(_in[i + 2].data() + (col * 4),
+                _in[i + 6].data() + (col * 4));
+            e[3] = loadPairAvx2(_in[i + 3].data() + (col * 4),
+                _in[i + 7].data() + (col * 4));
+            transposeAvx2(e[0], e[1], e[2], e[3]);
+        }
+
+        __m256 r[16];
+        __m256 det = adjugateAvx2(m, r, _out != NULL);
+
+        if (_determinants != NULL) {
+
+            _mm256_storeu_ps(_determinants + i, det);
+        }
+        if (_out != NULL) {
+
+            __m256 detInv = _mm256_div_ps(one, det);
+            for (unsigned col = 0; col < 4; ++col) {
+
+                __m256 e0 = _mm256_mul_ps(r[col * 4], detInv);
+                __m256 e1 = _mm256_mul_ps(r[(col * 4) + 1], detInv);
+                __m256 e2 = _mm256_mul_ps(r[(col * 4) + 2], detInv);
+                __m256 e3 = _mm256_mul_ps(r[(col * 4) + 3], detInv);
+                transposeAvx2(e0, e1, e2, e3);
+                _mm_store_ps(_out[i].data() + (col * 4),
+                    _mm256_castps256_ps128(e0));
+                _mm_store_ps(_out[i + 4].data() + (col * 4),
+                    _mm256_extractf128_ps(e0, 1));
+                _mm_store_ps(_out[i + 1].data() + (col * 4),
+                    _mm256_castps256_ps128(e1));
+                _mm_store_ps(_out[i + 5].data() + (col * 4),
+                    _mm256_extractf128_ps(e1, 1));
+                _mm_store_ps(_out[i + 2].data() + (col * 4),
+                    _mm256_castps256_ps128(e2));
+                _mm_store_ps(_out[i + 6].data() + (col * 4),
+                    _mm256_extractf128_ps(e2, 1));
+                _mm_store_ps(_out[i + 3].data() + (col * 4),
+                    _mm256_castps256_ps128(e3));
+                _mm_store_ps(_out[i + 7].data() + (col * 4),
+                    _mm256_extractf128_ps(e3, 1));
+            }
+        }
+    }
+
+    return i;
+}
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline __m256 Matrix4::adjugateAvx2(const __m256* _m, __m256* _r,
+    bool _full) {
+
+    const __m256& mA = _m[0];
+    const __m256& mB = _m[1];
+    const __m256& mC = _m[2];
+    const __m256& mD = _m[3];
+    const __m256& mE = _m[4];
+    const __m256& mF = _m[5];
+    const __m256& mG = _m[6];
+    const __m256& mH = _m[7];
+    const __m256& mI = _m[8];
+    const __m256& mJ = _m[9];
+    const __m256& mK = _m[10];
+    const __m256& mL = _m[11];
+    const __m256& mM = _m[12];
+    const __m256& mN = _m[13];
+    const __m256& mO = _m[14];
+    const __m256& mP = _m[15];
+
+    __m256 temp0 = _mm256_fmsub_ps(mK, mD, _mm256_mul_ps(mC, mL));
+    __m256 temp1 = _mm256_fmsub_ps(mO, mH, _mm256_mul_ps(mG, mP));
+    __m256 temp2 = _mm256_fmsub_ps(mB, mK, _mm256_mul_ps(mJ, mC));
+    __m256 temp3 = _mm256_fmsub_ps(mF, mO, _mm256_mul_ps(mN, mG));
+    __m256 temp4 = _mm256_fmsub_ps(mJ, mD, _mm256_mul_ps(mB, mL));
+    __m256 temp5 = _mm256_fmsub_ps(mN, mH, _mm256_mul_ps(mF, mP));
+
+    _r[0] = _mm256_fnmadd_ps(mK, temp5,
+        _mm256_fmsub_ps(mJ, temp1, _mm256_mul_ps(mL, temp3)));
+    _r[1] = _mm256_fnmadd_ps(mO, temp4,
+        _mm256_fmsub_ps(mN, temp0, _mm256_mul_ps(mP, temp2)));
+    _r[2] = _mm256_fnmadd_ps(mB, temp1,
+        _mm256_fmadd_ps(mD, temp3, _mm256_mul_ps(mC, temp5)));
+    _r[3] = _mm256_fnmadd_ps(mF, temp0,
+        _mm256_fmadd_ps(mH, temp2, _mm256_mul_ps(mG, temp4)));
+
+    __m256 det = _mm256_fmadd_ps(mM, _r[3], _mm256_fmadd_ps(mI, _r[2],
+        _mm256_fmadd_ps(mE, _r[1], _mm256_mul_ps(mA, _r[0]))));
+
+    if (!_full) {
+
+        return det;
+    }
+
+    __m256 temp6 = _mm256_fmsub_ps(mI, mB, _mm256_mul_ps(mA, mJ));
+    __m256 temp7 = _mm256_fmsub_ps(mM, mF, _mm256_mul_ps(mE, mN));
+    __m256 temp8 = _mm256_fmsub_ps(mI, mD, _mm256_mul_ps(mA, mL));
+    __m256 temp9 = _mm256_fmsub_ps(mM, mH, _mm256_mul_ps(mE, mP));
+    __m256 temp10 = _mm256_fmsub_ps(mI, mC, _mm256_mul_ps(mA, mK));
+    __m256 temp11 = _mm256_fmsub_ps(mM, mG, _mm256_mul_ps(mE, mO));
+
+    _r[4] = _mm256_fnmadd_ps(mI, temp1,
+        _mm256_fmsub_ps(mK, temp9, _mm256_mul_ps(mL, temp11)));
+    _r[5] = _mm256_fnmadd_ps(mM, temp0,
+        _mm256_fmsub_ps(mO, temp8, _mm256_mul_ps(mP, temp10)));
+    _r[6] = _mm256_fmadd_ps(mA, temp1,
+        _mm256_fmsub_ps(mD, temp11, _mm256_mul_ps(mC, temp9)));
+    _r[7] = _mm256_fmadd_ps(mE, temp0,
+        _mm256_fmsub_ps(mH, temp10, _mm256_mul_ps(mG, temp8)));
+
+    _r[8] = _mm256_fmadd_ps(mI, temp5,
+        _mm256_fmsub_ps(mL, temp7, _mm256_mul_ps(mJ, temp9)));
+    _r[9] = _mm256_fmadd_ps(mM, temp4,
+        _mm256_fmsub_ps(mP, temp6, _mm256_mul_ps(mN, temp8)));
+    _r[10] = _mm256_fnmadd_ps(mA, temp5,
+        _mm256_fmsub_ps(mB, temp9, _mm256_mul_ps(mD, temp7)));
+    _r[11] = _mm256_fnmadd_ps(mE, temp4,
+        _mm256_fmsub_ps(mF, temp8, _mm256_mul_ps(mH, temp6)));
+
+    _r[12] = _mm256_fmadd_ps(mI, temp3,
+        _mm256_fmsub_ps(mJ, temp11, _mm256_mul_ps(mK, temp7)));
+    _r[13] = _mm256_fmadd_ps(mM, temp2,
+        _mm256_fmsub_ps(mN, temp10, _mm256_mul_ps(mO, temp6)));
+    _r[14] = _mm256_fnmadd_ps(mA, temp3,
+        _mm256_fmsub_ps(mC, temp7, _mm256_mul_ps(mB, temp11)));
+    _r[15] = _mm256_fnmadd_ps(mE, temp2,
+        _mm256_fmsub_ps(mG, temp6, _mm256_mul_ps(mF, temp10)));
+
+    return det;
+}
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline __m256 Matrix4::loadPairAvx2(const float* _low, const float* _high) {
+
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(_low)),
+        _mm_load_ps(_high), 1);
+}
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline void Matrix4::transposeAvx2(__m256& _r0, __m256& _r1, __m256& _r2,
+    __m256& _r3) {
+
+    __m256 t0 = _mm256_unpacklo_ps(_r0, _r1);
+    __m256 t1 = _mm256_unpackhi_ps(_r0, _r1);
+    __m256 t2 = _mm256_unpacklo_ps(_r2, _r3);
+    __m256 t3 = _mm256_unpackhi_ps(_r2, _r3);
 
-    return util::vec::Vector3(col3.getX(), col3.getY(), col3.getZ());
+    _r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    _r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    _r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    _r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
 }
+#endif
 
 }} //util //mat
 
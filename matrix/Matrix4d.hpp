@@ -0,0 +1,562 @@
+/**********************************\
+| A double precision 4 x 4 matrix. |
+|                                  |
+| @author David Saxon              |
+\**********************************/
+
+#ifndef UTILITIES_MATRIX_MATRIX4D_H_
+#   define UTILITIES_MATRIX_MATRIX4D_H_
+
+#include <cassert>
+#include <iostream>
+
+#include "../SimdUtil.hpp"
+#include "../vector/Quaternion.hpp"
+#include "../vector/Vector.hpp"
+#include "../vector/Vector3.hpp"
+#include "Matrix4.hpp"
+
+namespace util { namespace mat {
+
+/**********************************************************************\
+| A column-major 4 x 4 matrix of doubles for placing objects in worlds |
+| too large for float coordinates. Rendering and batch work stay in    |
+| float by moving to a nearby origin first, usually the camera:        |
+|                                                                      |
+|     Matrix4 model = Matrix4d::toRelative(world, cameraPosition);     |
+|     Matrix4::transformPoints(view * model, points, out, count);      |
+|                                                                      |
+| The view matrix then only holds the camera's rotation. The large     |
+| translations cancel while still in double so every float that is     |
+| left is small.                                                       |
+|                                                                      |
+| @author David Saxon                                                  |
+\**********************************************************************/
+class Matrix4d {
+
+    //FRIEND FUNCTIONS
+    /*!Prints the matrix to the output stream
+    @_output the output stream to print to
+    @_m the matrix to print
+    @return the changed output stream*/
+    friend std::ostream& operator <<(std::ostream& _output,
+        const Matrix4d& _m);
+
+public:
+
+    //CONSTRUCTORS
+    /*!Creates a new zero 4x4 matrix*/
+    Matrix4d();
+
+    /*!Creates a new matrix by widening the float matrix
+    @_m the float matrix to widen*/
+    explicit Matrix4d(const Matrix4& _m);
+
+    //OPERATORS
+    /*!Gets the element at the given column and row without bounds checking,
+    as Matrix4 does
+    #NOTE: the indices are only checked by an assertion in debug builds
+    @_col the column index
+    @_row the row index
+    @return a reference to the element*/
+    double& operator ()(unsigned _col, unsigned _row);
+
+    /*!Gets the element at the given column and row without bounds checking,
+    as Matrix4 does
+    #NOTE: the indices are only checked by an assertion in debug builds
+    @_col the column index
+    @_row the row index
+    @return a const reference to the element*/
+    const double& operator ()(unsigned _col, unsigned _row) const;
+
+    /*!Multiplies this matrix by the other matrix
+    @_other the right hand matrix
+    @return the result of the multiplication as a new matrix*/
+    Matrix4d operator *(const Matrix4d& _other) const;
+
+    /*!Multiplies this matrix by the other matrix
+    @_other the right hand matrix*/
+    void operator *=(const Matrix4d& _other);
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!@return a new identity matrix*/
+    static Matrix4d identity();
+
+    /*!@return a new matrix that translates by the vector*/
+    static Matrix4d translation(const util::vec::Vector3d& _translation);
+
+    /*!@return a new matrix that scales by the vector*/
+    static Matrix4d scale(const util::vec::Vector3d& _scale);
+
+    /*!@return a new matrix that rotates by the quaternion*/
+    static Matrix4d rotation(const util::vec::Quaternion& _quat);
+
+    /*!Multiplies the two matrices
+    @_a the left hand matrix
+    @_b the right hand matrix
+    @return the result of the multiplication*/
+    static Matrix4d multiply(const Matrix4d& _a, const Matrix4d& _b);
+
+    /*!Creates the inverse of an affine matrix, the 3x3 part is inversed and
+    the translation is moved back through it
+    #WARNING: the bottom row of the matrix must be 0 0 0 1
+    @_other the matrix to inverse
+    @return the matrix inversed as a new matrix*/
+    static Matrix4d inverseAffine(const Matrix4d& _other);
+
+    /*!Transforms an array of points (w = 1) by the matrix
+    #NOTE: the w value of the result is dropped, there is no perspective divide
+    @_m the matrix to transform by
+    @_in the points to transform
+    @_out receives the transformed points, may be the same array as _in
+    @_count the number of points to transform*/
+    static void transformPoints(const Matrix4d& _m,
+        const util::vec::Vector3d* _in, util::vec::Vector3d* _out,
+        unsigned _count);
+
+    /*!Moves the matrix to a new origin and narrows it to float, the result
+    is the translation by -_origin times the matrix with the subtraction done
+    in double
+    @_m the matrix to move
+    @_origin the new origin, usually the camera position
+    @return the float matrix relative to the origin*/
+    static Matrix4 toRelative(const Matrix4d& _m,
+        const util::vec::Vector3d& _origin);
+
+    /*!Moves an array of matrices to a new origin and narrows them to float,
+    see toRelative()
+    @_in the matrices to move
+    @_origin the new origin, usually the camera position
+    @_out receives the float matrices
+    @_count the number of matrices*/
+    static void toRelative(const Matrix4d* _in,
+        const util::vec::Vector3d& _origin, Matrix4* _out, unsigned _count);
+
+    /*!Moves an array of points to a new origin and narrows them to float
+    @_in the points to move
+    @_origin the new origin, usually the camera position
+    @_out receives the float points
+    @_count the number of points*/
+    static void toRelative(const util::vec::Vector3d* _in,
+        const util::vec::Vector3d& _origin, util::vec::Vector3* _out,
+        unsigned _count);
+
+    /*!@return the matrix narrowed to float*/
+    Matrix4 toMatrix4() const;
+
+    /*!@return the translation component of the matrix*/
+    util::vec::Vector3d getTranslation() const;
+
+    /*!@return the 16 elements of the matrix in column-major order*/
+    double* data();
+
+    /*!@return the 16 elements of the matrix in column-major order*/
+    const double* data() const;
+
+private:
+
+    //VARIABLES
+    //the elements of the matrix in column-major order
+    double m[16];
+
+    //PRIVATE MEMBER FUNCTIONS
+#if defined(UTIL_SIMD_DISPATCH)
+
+    //4 wide double kernels, a column of the matrix fills one register
+    UTIL_SIMD_TARGET("avx2,fma")
+    static void multiplyAvx2(const double* _a, const double* _b,
+        double* _out);
+
+    UTIL_SIMD_TARGET("avx2,fma")
+    static void transformPointsAvx2(const double* _m, const double* _in,
+        double* _out, unsigned _count);
+
+    UTIL_SIMD_TARGET("avx2,fma")
+    static void toRelativeAvx2(const double* _m, const double* _origin,
+        float* _out);
+#endif
+};
+
+//INLINE
+//FRIEND FUNCTIONS
+inline std::ostream& operator <<(std::ostream& _output, const Matrix4d& _m) {
+
+    for (unsigned row = 0; row < 4; ++row) {
+
+        _output << "[";
+        for (unsigned col = 0; col < 4; ++col) {
+
+            _output << _m(col, row) << (col < 3 ? ", " : "");
+        }
+        _output << "]" << (row < 3 ? "\n" : "");
+    }
+
+    return _output;
+}
+
+//CONSTRUCTORS
+inline Matrix4d::Matrix4d() {
+
+    for (unsigned i = 0; i < 16; ++i) {
+
+        m[i] = 0.0;
+    }
+}
+
+inline Matrix4d::Matrix4d(const Matrix4& _m) {
+
+    const float* in = _m.data();
+    for (unsigned i = 0; i < 16; ++i) {
+
+        m[i] = in[i];
+    }
+}
+
+//OPERATORS
+inline double& Matrix4d::operator ()(unsigned _col, unsigned _row) {
+
+    assert(_col < 4 && _row < 4);
+
+    return m[(_col * 4) + _row];
+}
+
+inline const double& Matrix4d::operator ()(unsigned _col,
+    unsigned _row) const {
+
+    assert(_col < 4 && _row < 4);
+
+    return m[(_col * 4) + _row];
+}
+
+inline Matrix4d Matrix4d::operator *(const Matrix4d& _other) const {
+
+    return multiply(*this, _other);
+}
+
+inline void Matrix4d::operator *=(const Matrix4d& _other) {
+
+    *this = multiply(*this, _other);
+}
+
+//PUBLIC MEMBER FUNCTIONS
+inline Matrix4d Matrix4d::identity() {
+
+    Matrix4d r;
+    r.m[0] = 1.0;
+    r.m[5] = 1.0;
+    r.m[10] = 1.0;
+    r.m[15] = 1.0;
+
+    return r;
+}
+
+inline Matrix4d Matrix4d::translation(
+    const util::vec::Vector3d& _translation) {
+
+    Matrix4d r = identity();
+    r.m[12] = _translation.data()[0];
+    r.m[13] = _translation.data()[1];
+    r.m[14] = _translation.data()[2];
+
+    return r;
+}
+
+inline Matrix4d Matrix4d::scale(const util::vec::Vector3d& _scale) {
+
+    Matrix4d r;
+    r.m[0] = _scale.data()[0];
+    r.m[5] = _scale.data()[1];
+    r.m[10] = _scale.data()[2];
+    r.m[15] = 1.0;
+
+    return r;
+}
+
+inline Matrix4d Matrix4d::rotation(const util::vec::Quaternion& _quat) {
+
+    double x = _quat.getX();
+    double y = _quat.getY();
+    double z = _quat.getZ();
+    double w = _quat.getW();
+
+    double x2 = x + x;
+    double y2 = y + y;
+    double z2 = z + z;
+
+    double xx = x * x2;
+    double yy = y * y2;
+    double zz = z * z2;
+    double xy = x * y2;
+    double xz = x * z2;
+    double yz = y * z2;
+    double wx = w * x2;
+    double wy = w * y2;
+    double wz = w * z2;
+
+    Matrix4d r;
+    r.m[0] = 1.0 - (yy + zz);
+    r.m[1] = xy + wz;
+    r.m[2] = xz - wy;
+    r.m[4] = xy - wz;
+    r.m[5] = 1.0 - (xx + zz);
+    r.m[6] = yz + wx;
+    r.m[8] = xz + wy;
+    r.m[9] = yz - wx;
+    r.m[10] = 1.0 - (xx + yy);
+    r.m[15] = 1.0;
+
+    return r;
+}
+
+inline Matrix4d Matrix4d::multiply(const Matrix4d& _a, const Matrix4d& _b) {
+
+    Matrix4d r;
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (util::simd::level() >= util::simd::cpu::AVX2) {
+
+        multiplyAvx2(_a.m, _b.m, r.m);
+        return r;
+    }
+#endif
+
+    //each column of the result is the columns of a weighted by the values of
+    //the matching column of b
+    for (unsigned col = 0; col < 4; ++col) {
+
+        const double* b = _b.m + (col * 4);
+        for (unsigned row = 0; row < 4; ++row) {
+
+            r.m[(col * 4) + row] =
+                (_a.m[row] * b[0]) + (_a.m[4 + row] * b[1]) +
+                (_a.m[8 + row] * b[2]) + (_a.m[12 + row] * b[3]);
+        }
+    }
+
+    return r;
+}
+
+inline Matrix4d Matrix4d::inverseAffine(const Matrix4d& _other) {
+
+    //the columns of the 3x3 part
+    const double* a = _other.m;
+    const double* b = _other.m + 4;
+    const double* c = _other.m + 8;
+
+    //the rows of the inverse are the cross products of the columns
+    double r0[3] = {
+        (b[1] * c[2]) - (b[2] * c[1]),
+        (b[2] * c[0]) - (b[0] * c[2]),
+        (b[0] * c[1]) - (b[1] * c[0])
+    };
+    double r1[3] = {
+        (c[1] * a[2]) - (c[2] * a[1]),
+        (c[2] * a[0]) - (c[0] * a[2]),
+        (c[0] * a[1]) - (c[1] * a[0])
+    };
+    double r2[3] = {
+        (a[1] * b[2]) - (a[2] * b[1]),
+        (a[2] * b[0]) - (a[0] * b[2]),
+        (a[0] * b[1]) - (a[1] * b[0])
+    };
+    double detInv = 1.0 / ((a[0] * r0[0]) + (a[1] * r0[1]) + (a[2] * r0[2]));
+
+    Matrix4d r;
+    for (unsigned col = 0; col < 3; ++col) {
+
+        r.m[(col * 4)] = r0[col] * detInv;
+        r.m[(col * 4) + 1] = r1[col] * detInv;
+        r.m[(col * 4) + 2] = r2[col] * detInv;
+    }
+
+    //move the translation back through the inversed 3x3 part
+    const double* t = _other.m + 12;
+    for (unsigned row = 0; row < 3; ++row) {
+
+        r.m[12 + row] = -((r.m[row] * t[0]) + (r.m[4 + row] * t[1]) +
+            (r.m[8 + row] * t[2]));
+    }
+    r.m[15] = 1.0;
+
+    return r;
+}
+
+inline void Matrix4d::transformPoints(const Matrix4d& _m,
+    const util::vec::Vector3d* _in, util::vec::Vector3d* _out,
+    unsigned _count) {
+
+    //a Vector3d is three packed doubles, see Vector3dIsPacked
+    const double* in = reinterpret_cast<const double*>(_in);
+    double* out = reinterpret_cast<double*>(_out);
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (util::simd::level() >= util::simd::cpu::AVX2) {
+
+        transformPointsAvx2(_m.m, in, out, _count);
+        return;
+    }
+#endif
+
+    const double* e = _m.m;
+    for (unsigned i = 0; i < _count; ++i) {
+
+        double x = in[(i * 3)];
+        double y = in[(i * 3) + 1];
+        double z = in[(i * 3) + 2];
+        for (unsigned row = 0; row < 3; ++row) {
+
+            out[(i * 3) + row] = (e[row] * x) + (e[4 + row] * y) +
+                (e[8 + row] * z) + e[12 + row];
+        }
+    }
+}
+
+inline Matrix4 Matrix4d::toRelative(const Matrix4d& _m,
+    const util::vec::Vector3d& _origin) {
+
+    Matrix4 r;
+    toRelative(&_m, _origin, &r, 1);
+
+    return r;
+}
+
+inline void Matrix4d::toRelative(const Matrix4d* _in,
+    const util::vec::Vector3d& _origin, Matrix4* _out, unsigned _count) {
+
+    const double* o = _origin.data();
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (util::simd::level() >= util::simd::cpu::AVX2) {
+
+        for (unsigned i = 0; i < _count; ++i) {
+
+            toRelativeAvx2(_in[i].m, o, _out[i].data());
+        }
+        return;
+    }
+#endif
+
+    //the translation only moves the top three rows, each by the origin
+    //weighted by the bottom row, which is 0 0 0 1 for an affine matrix
+    for (unsigned i = 0; i < _count; ++i) {
+
+        const double* in = _in[i].m;
+        float* out = _out[i].data();
+        for (unsigned col = 0; col < 4; ++col) {
+
+            const double* c = in + (col * 4);
+            out[(col * 4)] = static_cast<float>(c[0] - (o[0] * c[3]));
+            out[(col * 4) + 1] = static_cast<float>(c[1] - (o[1] * c[3]));
+            out[(col * 4) + 2] = static_cast<float>(c[2] - (o[2] * c[3]));
+            out[(col * 4) + 3] = static_cast<float>(c[3]);
+        }
+    }
+}
+
+inline void Matrix4d::toRelative(const util::vec::Vector3d* _in,
+    const util::vec::Vector3d& _origin, util::vec::Vector3* _out,
+    unsigned _count) {
+
+    const double* o = _origin.data();
+    for (unsigned i = 0; i < _count; ++i) {
+
+        const double* p = _in[i].data();
+        _out[i] = util::vec::Vector3(static_cast<float>(p[0] - o[0]),
+            static_cast<float>(p[1] - o[1]), static_cast<float>(p[2] - o[2]));
+    }
+}
+
+inline Matrix4 Matrix4d::toMatrix4() const {
+
+    Matrix4 r;
+    float* out = r.data();
+    for (unsigned i = 0; i < 16; ++i) {
+
+        out[i] = static_cast<float>(m[i]);
+    }
+
+    return r;
+}
+
+inline util::vec::Vector3d Matrix4d::getTranslation() const {
+
+    return util::vec::Vector3d(m[12], m[13], m[14]);
+}
+
+inline double* Matrix4d::data() {
+
+    return m;
+}
+
+inline const double* Matrix4d::data() const {
+
+    return m;
+}
+
+//PRIVATE MEMBER FUNCTIONS
+#if defined(UTIL_SIMD_DISPATCH)
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline void Matrix4d::multiplyAvx2(const double* _a, const double* _b,
+    double* _out) {
+
+    __m256d a0 = _mm256_loadu_pd(_a);
+    __m256d a1 = _mm256_loadu_pd(_a + 4);
+    __m256d a2 = _mm256_loadu_pd(_a + 8);
+    __m256d a3 = _mm256_loadu_pd(_a + 12);
+
+    for (unsigned col = 0; col < 4; ++col) {
+
+        const double* b = _b + (col * 4);
+        __m256d r = _mm256_mul_pd(a0, _mm256_broadcast_sd(b));
+        r = _mm256_fmadd_pd(a1, _mm256_broadcast_sd(b + 1), r);
+        r = _mm256_fmadd_pd(a2, _mm256_broadcast_sd(b + 2), r);
+        r = _mm256_fmadd_pd(a3, _mm256_broadcast_sd(b + 3), r);
+        _mm256_storeu_pd(_out + (col * 4), r);
+    }
+}
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline void Matrix4d::transformPointsAvx2(const double* _m,
+    const double* _in, double* _out, unsigned _count) {
+
+    __m256d c0 = _mm256_loadu_pd(_m);
+    __m256d c1 = _mm256_loadu_pd(_m + 4);
+    __m256d c2 = _mm256_loadu_pd(_m + 8);
+    __m256d c3 = _mm256_loadu_pd(_m + 12);
+
+    //only the first three doubles are written so the next point is left
+    //alone, which lets the points be transformed in place
+    __m256i xyz = _mm256_set_epi64x(0, -1, -1, -1);
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        const double* p = _in + (i * 3);
+        __m256d r = _mm256_fmadd_pd(c0, _mm256_broadcast_sd(p), c3);
+        r = _mm256_fmadd_pd(c1, _mm256_broadcast_sd(p + 1), r);
+        r = _mm256_fmadd_pd(c2, _mm256_broadcast_sd(p + 2), r);
+        _mm256_maskstore_pd(_out + (i * 3), xyz, r);
+    }
+}
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline void Matrix4d::toRelativeAvx2(const double* _m, const double* _origin,
+    float* _out) {
+
+    __m256d o = _mm256_set_pd(0.0, _origin[2], _origin[1], _origin[0]);
+
+    for (unsigned col = 0; col < 4; ++col) {
+
+        __m256d c = _mm256_loadu_pd(_m + (col * 4));
+        __m256d w = _mm256_broadcast_sd(_m + (col * 4) + 3);
+        _mm_storeu_ps(_out + (col * 4),
+            _mm256_cvtpd_ps(_mm256_fnmadd_pd(o, w, c)));
+    }
+}
+#endif
+
+} } //util //mat
+
+#endif
@@ -0,0 +1,547 @@
+/******************************************\
+| Compact translation, rotation and scale. |
+|                                          |
+| @author David Saxon                      |
+\******************************************/
+
+#ifndef UTILITIES_MATRIX_TRANSFORM_H_
+#   define UTILITIES_MATRIX_TRANSFORM_H_
+
+#include <cmath>
+#include <iostream>
+#include <stdint.h>
+
+#include "../SimdUtil.hpp"
+#include "../vector/Quaternion.hpp"
+#include "../vector/Vector3.hpp"
+#include "Matrix4.hpp"
+
+namespace util { namespace mat {
+
+/*~A rigid transform in 16 bytes, the translation is kept exactly and the
+rotation is quantised, see Transform::pack()*/
+struct PackedTransform {
+
+    //VARIABLES
+    //!the translation
+    float translation[3];
+    //!the index of the largest element of the rotation in the low 2 bits
+    //!followed by the other three elements in 10 bits each
+    uint32_t rotation;
+};
+
+typedef char PackedTransformIsPacked[
+    (sizeof(PackedTransform) == 16) ? 1 : -1];
+
+/**********************************************************************\
+| A translation, rotation and scale held as ten floats, 40 bytes in    |
+| place of the 64 of the Matrix4 it stands for. It becomes the matrix  |
+| that scales, then rotates, then translates. Arrays of transforms are |
+| turned into arrays of matrices four or eight at a time.              |
+|                                                                      |
+| @author David Saxon                                                  |
+\**********************************************************************/
+class Transform {
+
+    //FRIEND FUNCTIONS
+    /*!Prints the transform to the output stream
+    @_output the output stream to print to
+    @_transform the transform to print
+    @return the changed output stream*/
+    friend std::ostream& operator <<(std::ostream& _output,
+        const Transform& _transform);
+
+public:
+
+    //CONSTRUCTORS
+    /*!Creates a new identity transform*/
+    Transform();
+
+    /*!Creates a new transform
+    @_translation the translation
+    @_rotation the rotation, should be unit length
+    @_scale the scale*/
+    Transform(const util::vec::Vector3& _translation,
+        const util::vec::Quaternion& _rotation,
+        const util::vec::Vector3& _scale);
+
+    /*!Creates a new transform by taking apart a matrix
+    #WARNING: the matrix must be affine with no shear, see
+    Matrix4::decompose()
+    @_matrix the matrix to take apart*/
+    explicit Transform(const Matrix4& _matrix);
+
+    /*!Creates a new transform from a packed transform, the scale is one
+    @_packed the packed transform*/
+    explicit Transform(const PackedTransform& _packed);
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!Creates the matrices for an array of transforms
+    @_in the transforms
+    @_out receives the matrices
+    @_count the number of transforms*/
+    static void toMatrix(const Transform* _in, Matrix4* _out,
+        unsigned _count);
+
+    /*!Takes apart an array of matrices
+    @_in the matrices, see Transform(const Matrix4&)
+    @_out receives the transforms
+    @_count the number of matrices*/
+    static void fromMatrix(const Matrix4* _in, Transform* _out,
+        unsigned _count);
+
+    /*!Packs an array of transforms, see pack()
+    @_in the transforms
+    @_out receives the packed transforms
+    @_count the number of transforms*/
+    static void pack(const Transform* _in, PackedTransform* _out,
+        unsigned _count);
+
+    /*!Unpacks an array of packed transforms, the scales are one
+    @_in the packed transforms
+    @_out receives the transforms
+    @_count the number of packed transforms*/
+    static void unpack(const PackedTransform* _in, Transform* _out,
+        unsigned _count);
+
+    /*!@return the matrix that scales, then rotates, then translates*/
+    Matrix4 toMatrix() const;
+
+    /*!Packs the transform into 16 bytes, the rotation keeps its three
+    smallest elements in 10 bits each and rebuilds the largest from them
+    #NOTE: the rotation comes back within 0.0014 per element
+    #WARNING: the scale is dropped
+    @return the packed transform*/
+    PackedTransform pack() const;
+
+    /*!@return the translation*/
+    util::vec::Vector3 getTranslation() const;
+
+    /*!@return the rotation*/
+    util::vec::Quaternion getRotation() const;
+
+    /*!@return the scale*/
+    util::vec::Vector3 getScale() const;
+
+    /*!@_translation the new translation*/
+    void setTranslation(const util::vec::Vector3& _translation);
+
+    /*!@_rotation the new rotation, should be unit length*/
+    void setRotation(const util::vec::Quaternion& _rotation);
+
+    /*!@_scale the new scale*/
+    void setScale(const util::vec::Vector3& _scale);
+
+private:
+
+    //VARIABLES
+    //plain float arrays keep the transform at 40 bytes, a Quaternion member
+    //would pad it to 48, the batch kernels rely on this order
+    float translation[3];
+    float rotation[4];
+    float scale[3];
+
+    //PRIVATE MEMBER FUNCTIONS
+    /*!Transposes one column of four matrices into place
+    @_x the first row of the column for each matrix
+    @_y the second row of the column for each matrix
+    @_z the third row of the column for each matrix
+    @_w the fourth row of the column for each matrix
+    @_out the first of the four matrices
+    @_col the index of the column*/
+    static void storeColumn(util::simd::Float4 _x, util::simd::Float4 _y,
+        util::simd::Float4 _z, util::simd::Float4 _w, Matrix4* _out,
+        unsigned _col);
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+    /*!Creates the matrices for as many transforms as fit in groups of eight,
+    see toMatrix()
+    @return the number of transforms done, the rest are left to the caller*/
+    UTIL_SIMD_TARGET("avx2,fma")
+    static unsigned toMatrixAvx2(const Transform* _in, Matrix4* _out,
+        unsigned _count);
+
+    /*!Transposes one column of eight matrices into place, see
+    storeColumn()*/
+    UTIL_SIMD_TARGET("avx2,fma")
+    static void storeColumnAvx2(__m256 _x, __m256 _y, __m256 _z, __m256 _w,
+        Matrix4* _out, unsigned _col);
+#endif
+};
+
+//arrays of transforms are gathered with a stride of ten floats
+typedef char TransformIsPacked[
+    (sizeof(Transform) == (10 * sizeof(float))) ? 1 : -1];
+
+//INLINE
+//FRIEND FUNCTIONS
+inline std::ostream& operator <<(std::ostream& _output,
+    const Transform& _transform) {
+
+    _output << "[" << _transform.getTranslation() << ", " <<
+        _transform.getRotation() << ", " << _transform.getScale() << "]";
+
+    return _output;
+}
+
+//CONSTRUCTORS
+inline Transform::Transform() {
+
+    setTranslation(util::vec::Vector3(0.0f, 0.0f, 0.0f));
+    setRotation(util::vec::Quaternion::identity());
+    setScale(util::vec::Vector3(1.0f, 1.0f, 1.0f));
+}
+
+inline Transform::Transform(const util::vec::Vector3& _translation,
+    const util::vec::Quaternion& _rotation,
+    const util::vec::Vector3& _scale) {
+
+    setTranslation(_translation);
+    setRotation(_rotation);
+    setScale(_scale);
+}
+
+inline Transform::Transform(const Matrix4& _matrix) {
+
+    util::vec::Vector3 t;
+    util::vec::Quaternion r;
+    util::vec::Vector3 s;
+    Matrix4::decompose(_matrix, t, r, s);
+
+    setTranslation(t);
+    setRotation(r);
+    setScale(s);
+}
+
+inline Transform::Transform(const PackedTransform& _packed) {
+
+    translation[0] = _packed.translation[0];
+    translation[1] = _packed.translation[1];
+    translation[2] = _packed.translation[2];
+    setScale(util::vec::Vector3(1.0f, 1.0f, 1.0f));
+
+    //the largest element is rebuilt from the other three since the
+    //rotation is unit length
+    static const float UNSCALE = 1.0f / (1023.0f * 1.41421356f);
+
+    unsigned largest = _packed.rotation & 3;
+    unsigned shift = 2;
+    float sum = 0.0f;
+    for (unsigned i = 0; i < 4; ++i) {
+
+        if (i == largest) {
+
+            continue;
+        }
+        float bits = static_cast<float>((_packed.rotation >> shift) & 1023);
+        float element = ((bits * 2.0f) - 1023.0f) * UNSCALE;
+        rotation[i] = element;
+        sum += element * element;
+        shift += 10;
+    }
+    rotation[largest] = sum < 1.0f ? sqrtf(1.0f - sum) : 0.0f;
+}
+
+//PUBLIC MEMBER FUNCTIONS
+inline void Transform::toMatrix(const Transform* _in, Matrix4* _out,
+    unsigned _count) {
+
+    util::simd::cpu::Level level = util::simd::level();
+
+    unsigned i = 0;
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (level >= util::simd::cpu::AVX2) {
+
+        i = toMatrixAvx2(_in, _out, _count);
+    }
+#endif
+    if (level != util::simd::cpu::SCALAR) {
+
+        util::simd::Float4 zero = util::simd::splat(0.0f);
+        util::simd::Float4 one = util::simd::splat(1.0f);
+
+        for (; i + 4 <= _count; i += 4) {
+
+            const Transform* t = _in + i;
+
+            //the same expansion as Matrix4::rotation() with each register
+            //holding one element of four transforms
+            util::simd::Float4 qx = util::simd::set(t[0].rotation[0],
+                t[1].rotation[0], t[2].rotation[0], t[3].rotation[0]);
+            util::simd::Float4 qy = util::simd::set(t[0].rotation[1],
+                t[1].rotation[1], t[2].rotation[1], t[3].rotation[1]);
+            util::simd::Float4 qz = util::simd::set(t[0].rotation[2],
+                t[1].rotation[2], t[2].rotation[2], t[3].rotation[2]);
+            util::simd::Float4 qw = util::simd::set(t[0].rotation[3],
+                t[1].rotation[3], t[2].rotation[3], t[3].rotation[3]);
+            util::simd::Float4 sx = util::simd::set(t[0].scale[0],
+                t[1].scale[0], t[2].scale[0], t[3].scale[0]);
+            util::simd::Float4 sy = util::simd::set(t[0].scale[1],
+                t[1].scale[1], t[2].scale[1], t[3].scale[1]);
+            util::simd::Float4 sz = util::simd::set(t[0].scale[2],
+                t[1].scale[2], t[2].scale[2], t[3].scale[2]);
+
+            util::simd::Float4 x2 = util::simd::add(qx, qx);
+            util::simd::Float4 y2 = util::simd::add(qy, qy);
+            util::simd::Float4 z2 = util::simd::add(qz, qz);
+            util::simd::Float4 xx = util::simd::mul(qx, x2);
+            util::simd::Float4 yy = util::simd::mul(qy, y2);
+            util::simd::Float4 zz = util::simd::mul(qz, z2);
+            util::simd::Float4 xy = util::simd::mul(qx, y2);
+            util::simd::Float4 xz = util::simd::mul(qx, z2);
+            util::simd::Float4 yz = util::simd::mul(qy, z2);
+            util::simd::Float4 wx = util::simd::mul(qw, x2);
+            util::simd::Float4 wy = util::simd::mul(qw, y2);
+            util::simd::Float4 wz = util::simd::mul(qw, z2);
+
+            storeColumn(
+                util::simd::mul(util::simd::sub(one, util::simd::add(yy, zz)),
+                    sx),
+                util::simd::mul(util::simd::add(xy, wz), sx),
+                util::simd::mul(util::simd::sub(xz, wy), sx),
+                zero, _out + i, 0);
+            storeColumn(
+                util::simd::mul(util::simd::sub(xy, wz), sy),
+                util::simd::mul(util::simd::sub(one, util::simd::add(xx, zz)),
+                    sy),
+                util::simd::mul(util::simd::add(yz, wx), sy),
+                zero, _out + i, 1);
+            storeColumn(
+                util::simd::mul(util::simd::add(xz, wy), sz),
+                util::simd::mul(util::simd::sub(yz, wx), sz),
+                util::simd::mul(util::simd::sub(one, util::simd::add(xx, yy)),
+                    sz),
+                zero, _out + i, 2);
+            storeColumn(
+                util::simd::set(t[0].translation[0], t[1].translation[0],
+                    t[2].translation[0], t[3].translation[0]),
+                util::simd::set(t[0].translation[1], t[1].translation[1],
+                    t[2].translation[1], t[3].translation[1]),
+                util::simd::set(t[0].translation[2], t[1].translation[2],
+                    t[2].translation[2], t[3].translation[2]),
+                one, _out + i, 3);
+        }
+    }
+    for (; i < _count; ++i) {
+
+        _out[i] = _in[i].toMatrix();
+    }
+}
+
+inline void Transform::fromMatrix(const Matrix4* _in, Transform* _out,
+    unsigned _count) {
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        _out[i] = Transform(_in[i]);
+    }
+}
+
+inline void Transform::pack(const Transform* _in, PackedTransform* _out,
+    unsigned _count) {
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        _out[i] = _in[i].pack();
+    }
+}
+
+inline void Transform::unpack(const PackedTransform* _in, Transform* _out,
+    unsigned _count) {
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        _out[i] = Transform(_in[i]);
+    }
+}
+
+inline Matrix4 Transform::toMatrix() const {
+
+    return Matrix4::compose(getTranslation(), getRotation(), getScale());
+}
+
+inline PackedTransform Transform::pack() const {
+
+    PackedTransform packed;
+    packed.translation[0] = translation[0];
+    packed.translation[1] = translation[1];
+    packed.translation[2] = translation[2];
+
+    //the other three elements of a unit quaternion are at most 1/sqrt(2)
+    //when the largest is left out, and q and -q are the same rotation so
+    //the largest can always be taken as positive
+    unsigned largest = 0;
+    for (unsigned i = 1; i < 4; ++i) {
+
+        if (std::fabs(rotation[i]) > std::fabs(rotation[largest])) {
+
+            largest = i;
+        }
+    }
+    float sign = rotation[largest] < 0.0f ? -1.0f : 1.0f;
+    float bitScale = sign * 1023.0f * 1.41421356f;
+
+    packed.rotation = largest;
+    unsigned shift = 2;
+    for (unsigned i = 0; i < 4; ++i) {
+
+        if (i == largest) {
+
+            continue;
+        }
+        float bits = ((rotation[i] * bitScale) + 1023.0f) * 0.5f;
+        bits = bits < 0.0f ? 0.0f : (bits > 1023.0f ? 1023.0f : bits);
+        packed.rotation |= static_cast<uint32_t>(bits + 0.5f) << shift;
+        shift += 10;
+    }
+
+    return packed;
+}
+
+inline util::vec::Vector3 Transform::getTranslation() const {
+
+    return util::vec::Vector3(translation[0], translation[1], translation[2]);
+}
+
+inline util::vec::Quaternion Transform::getRotation() const {
+
+    return util::vec::Quaternion(
+        rotation[0], rotation[1], rotation[2], rotation[3]);
+}
+
+inline util::vec::Vector3 Transform::getScale() const {
+
+    return util::vec::Vector3(scale[0], scale[1], scale[2]);
+}
+
+inline void Transform::setTranslation(const util::vec::Vector3& _translation) {
+
+    translation[0] = _translation.getX();
+    translation[1] = _translation.getY();
+    translation[2] = _translation.getZ();
+}
+
+inline void Transform::setRotation(const util::vec::Quaternion& _rotation) {
+
+    rotation[0] = _rotation.getX();
+    rotation[1] = _rotation.getY();
+    rotation[2] = _rotation.getZ();
+    rotation[3] = _rotation.getW();
+}
+
+inline void Transform::setScale(const util::vec::Vector3& _scale) {
+
+    scale[0] = _scale.getX();
+    scale[1] = _scale.getY();
+    scale[2] = _scale.getZ();
+}
+
+//PRIVATE MEMBER FUNCTIONS
+inline void Transform::storeColumn(util::simd::Float4 _x,
+    util::simd::Float4 _y, util::simd::Float4 _z, util::simd::Float4 _w,
+    Matrix4* _out, unsigned _col) {
+
+    util::simd::transpose(_x, _y, _z, _w);
+    util::simd::store(_out[0].data() + (_col * 4), _x);
+    util::simd::store(_out[1].data() + (_col * 4), _y);
+    util::simd::store(_out[2].data() + (_col * 4), _z);
+    util::simd::store(_out[3].data() + (_col * 4), _w);
+}
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline unsigned Transform::toMatrixAvx2(const Transform* _in, Matrix4* _out,
+    unsigned _count) {
+
+    //each transform is ten floats so one element of eight transforms is
+    //gathered with a stride of ten
+    __m256i stride = _mm256_setr_epi32(0, 10, 20, 30, 40, 50, 60, 70);
+    __m256 zero = _mm256_setzero_ps();
+    __m256 one = _mm256_set1_ps(1.0f);
+
+    unsigned i = 0;
+    for (; i + 8 <= _count; i += 8) {
+
+        const float* t = _in[i].translation;
+        const float* r = _in[i].rotation;
+        const float* s = _in[i].scale;
+
+        __m256 qx = _mm256_i32gather_ps(r, stride, 4);
+        __m256 qy = _mm256_i32gather_ps(r + 1, stride, 4);
+        __m256 qz = _mm256_i32gather_ps(r + 2, stride, 4);
+        __m256 qw = _mm256_i32gather_ps(r + 3, stride, 4);
+        __m256 sx = _mm256_i32gather_ps(s, stride, 4);
+        __m256 sy = _mm256_i32gather_ps(s + 1, stride, 4);
+        __m256 sz = _mm256_i32gather_ps(s + 2, stride, 4);
+
+        __m256 x2 = _mm256_add_ps(qx, qx);
+        __m256 y2 = _mm256_add_ps(qy, qy);
+        __m256 z2 = _mm256_add_ps(qz, qz);
+        __m256 xx = _mm256_mul_ps(qx, x2);
+        __m256 yy = _mm256_mul_ps(qy, y2);
+        __m256 zz = _mm256_mul_ps(qz, z2);
+        __m256 xy = _mm256_mul_ps(qx, y2);
+        __m256 xz = _mm256_mul_ps(qx, z2);
+        __m256 yz = _mm256_mul_ps(qy, z2);
+        __m256 wx = _mm256_mul_ps(qw, x2);
+        __m256 wy = _mm256_mul_ps(qw, y2);
+        __m256 wz = _mm256_mul_ps(qw, z2);
+
+        storeColumnAvx2(
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx),
+            _mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+            _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx),
+            zero, _out + i, 0);
+        storeColumnAvx2(
+            _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy),
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+            _mm256_mul_ps(_mm256_add_ps(yz, wx), sy),
+            zero, _out + i, 1);
+        storeColumnAvx2(
+            _mm256_mul_ps(_mm256_add_ps(xz, wy), sz),
+            _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz),
+            zero, _out + i, 2);
+        storeColumnAvx2(
+            _mm256_i32gather_ps(t, stride, 4),
+            _mm256_i32gather_ps(t + 1, stride, 4),
+            _mm256_i32gather_ps(t + 2, stride, 4),
+            one, _out + i, 3);
+    }
+
+    return i;
+}
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline void Transform::storeColumnAvx2(__m256 _x, __m256 _y, __m256 _z,
+    __m256 _w, Matrix4* _out, unsigned _col) {
+
+    //transposing within each half leaves the column of matrix j in the low
+    //half of register j and the column of matrix j + 4 in its high half
+    __m256 t0 = _mm256_unpacklo_ps(_x, _y);
+    __m256 t1 = _mm256_unpackhi_ps(_x, _y);
+    __m256 t2 = _mm256_unpacklo_ps(_z, _w);
+    __m256 t3 = _mm256_unpackhi_ps(_z, _w);
+
+    __m256 c[4] = {
+        _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)),
+        _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)),
+        _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)),
+        _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2))
+    };
+    for (unsigned j = 0; j < 4; ++j) {
+
+        _mm_store_ps(_out[j].data() + (_col * 4),
+            _mm256_castps256_ps128(c[j]));
+        _mm_store_ps(_out[j + 4].data() + (_col * 4),
+            _mm256_extractf128_ps(c[j], 1));
+    }
+}
+#endif
+
+} } //util //mat
+
+#endif
@@ -0,0 +1,410 @@
+/*********************************************\
+| A hierarchy of parent and child transforms. |
+|                                             |
+| @author David Saxon                         |
+\*********************************************/
+
+#ifndef UTILITIES_MATRIX_TRANSFORMHIERARCHY_H_
+#   define UTILITIES_MATRIX_TRANSFORMHIERARCHY_H_
+
+#include <vector>
+
+#include "../exceptions/ArrayException.hpp"
+#include "../vector/Quaternion.hpp"
+#include "../vector/Vector3.hpp"
+#include "Matrix4.hpp"
+
+namespace util { namespace mat {
+
+/**********************************************************************\
+| Holds a tree of transforms as flat arrays of local translations,     |
+| rotations and scales in parent before child order, a parent always   |
+| has a lower index than its children. Changing a local transform      |
+| marks the node dirty and update() recomputes the world matrices of   |
+| only the dirty nodes and their descendants, so a frame where nothing |
+| moved costs one comparison.                                          |
+|                                                                      |
+| @author David Saxon                                                  |
+\**********************************************************************/
+class TransformHierarchy {
+public:
+
+    //VARIABLES
+    //!the parent of a node at the top of the hierarchy
+    static const unsigned NO_PARENT = 0xFFFFFFFF;
+
+    //CONSTRUCTORS
+    /*!Creates a new empty hierarchy*/
+    TransformHierarchy() :
+        firstDirty(0) {
+    }
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!Adds a node with an identity local transform
+    @_parent the index of the parent or NO_PARENT
+    @return the index of the new node*/
+    unsigned add(unsigned _parent = NO_PARENT);
+
+    /*!Adds a node
+    @_parent the index of the parent or NO_PARENT
+    @_translation the local translation
+    @_rotation the local rotation
+    @_scale the local scale
+    @return the index of the new node*/
+    unsigned add(unsigned _parent, const util::vec::Vector3& _translation,
+        const util::vec::Quaternion& _rotation,
+        const util::vec::Vector3& _scale);
+
+    /*!Recomputes the world matrices of the dirty nodes and their
+    descendants, the nodes are updated one depth at a time so the nodes of a
+    depth can be shared across threads
+    @_parallel whether the nodes of each depth are split across threads,
+    only when built with OpenMP
+    @return the number of world matrices recomputed*/
+    unsigned update(bool _parallel = false);
+
+    /*!@return whether the node's local transform has changed since the last
+    update(), its descendants are only known to be dirty during update()*/
+    bool isDirty(unsigned _index) const;
+
+    /*!@return the number of nodes in the hierarchy*/
+    unsigned size() const;
+
+    /*!Removes all nodes from the hierarchy*/
+    void clear();
+
+    /*!@return the index of the node's parent or NO_PARENT*/
+    unsigned getParent(unsigned _index) const;
+
+    /*!@return the local translation of the node*/
+    const util::vec::Vector3& getTranslation(unsigned _index) const;
+
+    /*!@return the local rotation of the node*/
+    const util::vec::Quaternion& getRotation(unsigned _index) const;
+
+    /*!@return the local scale of the node*/
+    const util::vec::Vector3& getScale(unsigned _index) const;
+
+    /*!@return the local matrix of the node, its scale then its rotation then
+    its translation*/
+    Matrix4 getLocal(unsigned _index) const;
+
+    /*!@return the world matrix of the node as of the last update()*/
+    const Matrix4& getWorld(unsigned _index) const;
+
+    /*!@return the world matrices of all nodes as of the last update()*/
+    const Matrix4* getWorlds() const;
+
+    /*!Sets the local translation of the node and marks it dirty
+    @_index the index of the node
+    @_translation the new local translation*/
+    void setTranslation(unsigned _index,
+        const util::vec::Vector3& _translation);
+
+    /*!Sets the local rotation of the node and marks it dirty
+    @_index the index of the node
+    @_rotation the new local rotation*/
+    void setRotation(unsigned _index, const util::vec::Quaternion& _rotation);
+
+    /*!Sets the local scale of the node and marks it dirty
+    @_index the index of the node
+    @_scale the new local scale*/
+    void setScale(unsigned _index, const util::vec::Vector3& _scale);
+
+private:
+
+    //VARIABLES
+    //the parent of each node
+    std::vector<unsigned> parents;
+    //the number of ancestors of each node
+    std::vector<unsigned> depths;
+    //the local transform of each node
+    std::vector<util::vec::Vector3> translations;
+    std::vector<util::vec::Quaternion> rotations;
+    std::vector<util::vec::Vector3> scales;
+    //the world matrix of each node
+    std::vector<Matrix4> worlds;
+    //whether each node needs its world matrix recomputed
+    std::vector<unsigned char> dirty;
+    //the lowest index that is dirty or size() when none are, nothing below
+    //it needs to be looked at
+    unsigned firstDirty;
+    //the dirty nodes sorted by depth, kept between updates to save
+    //allocating
+    std::vector<unsigned> pending;
+    std::vector<unsigned> order;
+    std::vector<unsigned> depthStarts;
+    std::vector<unsigned> depthNext;
+
+    //PRIVATE MEMBER FUNCTIONS
+    /*!Marks the node as needing its world matrix recomputed*/
+    void markDirty(unsigned _index);
+
+    /*!Recomputes the world matrix of the node from its parent's, does not
+    throw so it can run inside the parallel region*/
+    void updateNode(unsigned _index);
+
+    /*!Checks that the index is within the hierarchy*/
+    void checkIndex(unsigned _index) const;
+};
+
+//INLINE
+//PUBLIC MEMBER FUNCTIONS
+inline unsigned TransformHierarchy::add(unsigned _parent) {
+
+    return add(_parent, util::vec::Vector3(0.0f, 0.0f, 0.0f),
+        util::vec::Quaternion::identity(),
+        util::vec::Vector3(1.0f, 1.0f, 1.0f));
+}
+
+inline unsigned TransformHierarchy::add(unsigned _parent,
+    const util::vec::Vector3& _translation,
+    const util::vec::Quaternion& _rotation,
+    const util::vec::Vector3& _scale) {
+
+    //the parent must already exist which keeps parents before children
+    if (_parent != NO_PARENT) {
+
+        checkIndex(_parent);
+    }
+
+    unsigned index = size();
+    parents.push_back(_parent);
+    depths.push_back(_parent == NO_PARENT ? 0 : depths[_parent] + 1);
+    translations.push_back(_translation);
+    rotations.push_back(_rotation);
+    scales.push_back(_scale);
+    worlds.push_back(Matrix4::identity());
+    dirty.push_back(0);
+    markDirty(index);
+
+    return index;
+}
+
+inline unsigned TransformHierarchy::update(bool _parallel) {
+
+    unsigned count = size();
+    if (firstDirty >= count) {
+
+        return 0;
+    }
+
+    //a parent is always visited before its children so one pass spreads the
+    //dirty flags down every changed subtree, nodes before the first dirty
+    //node cannot have a dirty ancestor
+    pending.clear();
+    unsigned maxDepth = 0;
+    for (unsigned i = firstDirty; i < count; ++i) {
+
+        unsigned parent = parents[i];
+        if (parent != NO_PARENT) {
+
+            dirty[i] |= dirty[parent];
+        }
+        if (dirty[i] != 0) {
+
+            pending.push_back(i);
+            maxDepth = depths[i] > maxDepth ? depths[i] : maxDepth;
+        }
+    }
+    unsigned updated = static_cast<unsigned>(pending.size());
+
+#if defined(_OPENMP)
+
+    if (_parallel) {
+
+        //counting sort the dirty nodes by depth, the nodes of one depth
+        //only read the world matrices of the depth above
+        depthStarts.assign(maxDepth + 2, 0);
+        for (unsigned i = 0; i < updated; ++i) {
+
+            ++depthStarts[depths[pending[i]] + 1];
+        }
+        for (unsigned d = 1; d < depthStarts.size(); ++d) {
+
+            depthStarts[d] += depthStarts[d - 1];
+        }
+        order.resize(updated);
+        depthNext.assign(depthStarts.begin(), depthStarts.end() - 1);
+        for (unsigned i = 0; i < updated; ++i) {
+
+            order[depthNext[depths[pending[i]]]++] = pending[i];
+        }
+
+        for (unsigned d = 0; d <= maxDepth; ++d) {
+
+            int begin = static_cast<int>(depthStarts[d]);
+            int end = static_cast<int>(depthStarts[d + 1]);
+
+            //small depths are not worth waking the other threads for
+#   pragma omp parallel for schedule(static) if (end - begin >= 256)
+            for (int i = begin; i < end; ++i) {
+
+                updateNode(order[static_cast<size_t>(i)]);
+            }
+        }
+    }
+    else {
+
+        for (unsigned i = 0; i < updated; ++i) {
+
+            updateNode(pending[i]);
+        }
+    }
+#else
+
+    (void) _parallel;
+    (void) maxDepth;
+    for (unsigned i = 0; i < updated; ++i) {
+
+        updateNode(pending[i]);
+    }
+#endif
+
+    for (unsigned i = 0; i < updated; ++i) {
+
+        dirty[pending[i]] = 0;
+    }
+    firstDirty = count;
+
+    return updated;
+}
+
+inline bool TransformHierarchy::isDirty(unsigned _index) const {
+
+    checkIndex(_index);
+
+    return dirty[_index] != 0;
+}
+
+inline unsigned TransformHierarchy::size() const {
+
+    return static_cast<unsigned>(parents.size());
+}
+
+inline void TransformHierarchy::clear() {
+
+    parents.clear();
+    depths.clear();
+    translations.clear();
+    rotations.clear();
+    scales.clear();
+    worlds.clear();
+    dirty.clear();
+    firstDirty = 0;
+}
+
+inline unsigned TransformHierarchy::getParent(unsigned _index) const {
+
+    checkIndex(_index);
+
+    return parents[_index];
+}
+
+inline const util::vec::Vector3& TransformHierarchy::getTranslation(
+    unsigned _index) const {
+
+    checkIndex(_index);
+
+    return translations[_index];
+}
+
+inline const util::vec::Quaternion& TransformHierarchy::getRotation(
+    unsigned _index) const {
+
+    checkIndex(_index);
+
+    return rotations[_index];
+}
+
+inline const util::vec::Vector3& TransformHierarchy::getScale(
+    unsigned _index) const {
+
+    checkIndex(_index);
+
+    return scales[_index];
+}
+
+inline Matrix4 TransformHierarchy::getLocal(unsigned _index) const {
+
+    checkIndex(_index);
+
+    return Matrix4::compose(translations[_index], rotations[_index],
+        scales[_index]);
+}
+
+inline const Matrix4& TransformHierarchy::getWorld(unsigned _index) const {
+
+    checkIndex(_index);
+
+    return worlds[_index];
+}
+
+inline const Matrix4* TransformHierarchy::getWorlds() const {
+
+    return worlds.empty() ? NULL : &worlds[0];
+}
+
+inline void TransformHierarchy::setTranslation(unsigned _index,
+    const util::vec::Vector3& _translation) {
+
+    checkIndex(_index);
+
+    translations[_index] = _translation;
+    markDirty(_index);
+}
+
+inline void TransformHierarchy::setRotation(unsigned _index,
+    const util::vec::Quaternion& _rotation) {
+
+    checkIndex(_index);
+
+    rotations[_index] = _rotation;
+    markDirty(_index);
+}
+
+inline void TransformHierarchy::setScale(unsigned _index,
+    const util::vec::Vector3& _scale) {
+
+    checkIndex(_index);
+
+    scales[_index] = _scale;
+    markDirty(_index);
+}
+
+//PRIVATE MEMBER FUNCTIONS
+inline void TransformHierarchy::markDirty(unsigned _index) {
+
+    dirty[_index] = 1;
+    firstDirty = _index < firstDirty ? _index : firstDirty;
+}
+
+inline void TransformHierarchy::updateNode(unsigned _index) {
+
+    //built without getLocal(), whose index check could throw
+    Matrix4 local = Matrix4::compose(translations[_index], rotations[_index],
+        scales[_index]);
+
+    unsigned parent = parents[_index];
+    if (parent == NO_PARENT) {
+
+        worlds[_index] = local;
+    }
+    else {
+
+        worlds[_index] = worlds[parent] * local;
+    }
+}
+
+inline void TransformHierarchy::checkIndex(unsigned _index) const {
+
+    if (_index >= size()) {
+
+        throw util::ex::IndexOutOfBoundsException(
+            "index is greater than the number of nodes.");
+    }
+}
+
+} } //util //mat
+
+#endif
@@ -0,0 +1,338 @@
+/*******************************\
+| An axis aligned bounding box. |
+|                               |
+| @author David Saxon           |
+\*******************************/
+
+#ifndef UTILITIES_SPATIAL_AABB_H_
+#   define UTILITIES_SPATIAL_AABB_H_
+
+#include <iostream>
+#include <limits>
+
+#include "../matrix/Matrix4.hpp"
+#include "../vector/Vector3.hpp"
+
+namespace util { namespace spatial {
+
+/**********************************************************************\
+| A box aligned to the x, y and z axes, held as its minimum and        |
+| maximum corners. A default box is empty, its minimum is greater than |
+| its maximum, so merging points or boxes into it grows it from        |
+| nothing.                                                             |
+|                                                                      |
+| @author David Saxon                                                  |
+\**********************************************************************/
+class AABB {
+
+    //FRIEND FUNCTIONS
+    /*!Prints the box to the output stream
+    @_output the output stream to print to
+    @_box the box to print
+    @return the changed output stream*/
+    friend std::ostream& operator <<(std::ostream& _output,
+        const AABB& _box);
+
+public:
+
+    //CONSTRUCTORS
+    /*!Creates a new empty box*/
+    AABB();
+
+    /*!Creates a new box from its corners
+    @_min the minimum corner
+    @_max the maximum corner*/
+    AABB(const util::vec::Vector3& _min, const util::vec::Vector3& _max);
+
+    //OPERATORS
+    bool operator ==(const AABB& _other) const;
+
+    bool operator !=(const AABB& _other) const;
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!Creates the smallest box containing the points
+    @_points the points to contain
+    @_count the number of points
+    @return the box, empty if there are no points*/
+    static AABB fromPoints(const util::vec::Vector3* _points,
+        unsigned _count);
+
+    /*!Transforms the box by the matrix with Arvo's method, each corner of
+    the new box is built from the smaller and larger product of every matrix
+    element with the old corners so the eight corners are never transformed
+    #WARNING: the bottom row of the matrix must be 0 0 0 1
+    @_box the box to transform
+    @_m the matrix to transform by
+    @return the smallest axis aligned box containing the transformed box*/
+    static AABB transform(const AABB& _box, const util::mat::Matrix4& _m);
+
+    /*!@return whether the box contains nothing*/
+    bool isEmpty() const;
+
+    /*!@return the centre of the box*/
+    util::vec::Vector3 getCentre() const;
+
+    /*!@return half of the size of the box along each axis*/
+    util::vec::Vector3 getExtents() const;
+
+    /*!@return the size of the box along each axis*/
+    util::vec::Vector3 getSize() const;
+
+    /*!@return the surface area of the box*/
+    float surfaceArea() const;
+
+    /*!Grows the box to contain the point
+    @_point the point to contain*/
+    void merge(const util::vec::Vector3& _point);
+
+    /*!Grows the box to contain the other box
+    @_other the box to contain*/
+    void merge(const AABB& _other);
+
+    /*!@return whether the point is inside or on the box*/
+    bool contains(const util::vec::Vector3& _point) const;
+
+    /*!@return whether the other box is entirely inside or on the box*/
+    bool contains(const AABB& _other) const;
+
+    /*!@return whether the boxes touch or overlap*/
+    bool overlaps(const AABB& _other) const;
+
+    /*!@return the squared distance from the point to the nearest point of the
+    box, zero when the point is inside*/
+    float squaredDistance(const util::vec::Vector3& _point) const;
+
+    /*!@return the minimum corner of the box*/
+    const util::vec::Vector3& getMin() const;
+
+    /*!@return the maximum corner of the box*/
+    const util::vec::Vector3& getMax() const;
+
+    /*!@_min the new minimum corner of the box*/
+    void setMin(const util::vec::Vector3& _min);
+
+    /*!@_max the new maximum corner of the box*/
+    void setMax(const util::vec::Vector3& _max);
+
+private:
+
+    //VARIABLES
+    //the corners of the box
+    util::vec::Vector3 min;
+    util::vec::Vector3 max;
+};
+
+//INLINE
+//FRIEND FUNCTIONS
+inline std::ostream& operator <<(std::ostream& _output, const AABB& _box) {
+
+    _output << "[" << _box.min << ", " << _box.max << "]";
+
+    return _output;
+}
+
+//CONSTRUCTORS
+inline AABB::AABB() :
+    min(std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::max()),
+    max(-std::numeric_limits<float>::max(),
+        -std::numeric_limits<float>::max(),
+        -std::numeric_limits<float>::max()) {
+}
+
+inline AABB::AABB(const util::vec::Vector3& _min,
+    const util::vec::Vector3& _max) :
+    min(_min),
+    max(_max) {
+}
+
+//OPERATORS
+inline bool AABB::operator ==(const AABB& _other) const {
+
+    return min == _other.min && max == _other.max;
+}
+
+inline bool AABB::operator !=(const AABB& _other) const {
+
+    return !((*this) == _other);
+}
+
+//PUBLIC MEMBER FUNCTIONS
+inline AABB AABB::fromPoints(const util::vec::Vector3* _points,
+    unsigned _count) {
+
+    AABB box;
+    for (unsigned i = 0; i < _count; ++i) {
+
+        box.merge(_points[i]);
+    }
+
+    return box;
+}
+
+inline AABB AABB::transform(const AABB& _box, const util::mat::Matrix4& _m) {
+
+    //an empty box has no corners to move
+    if (_box.isEmpty()) {
+
+        return _box;
+    }
+
+    const float* oldMin = _box.min.data();
+    const float* oldMax = _box.max.data();
+
+    //both corners start from the translation
+    util::vec::Vector3 t = _m.getTranslation();
+    util::vec::Vector3 newMin(t);
+    util::vec::Vector3 newMax(t);
+    float* nMin = newMin.data();
+    float* nMax = newMax.data();
+
+    for (unsigned row = 0; row < 3; ++row) {
+
+        for (unsigned col = 0; col < 3; ++col) {
+
+            float a = _m(col, row) * oldMin[col];
+            float b = _m(col, row) * oldMax[col];
+
+            if (a < b) {
+
+                nMin[row] += a;
+                nMax[row] += b;
+            }
+            else {
+
+                nMin[row] += b;
+                nMax[row] += a;
+            }
+        }
+    }
+
+    return AABB(newMin, newMax);
+}
+
+inline bool AABB::isEmpty() const {
+
+    return min.getX() > max.getX() || min.getY() > max.getY() ||
+           min.getZ() > max.getZ();
+}
+
+inline util::vec::Vector3 AABB::getCentre() const {
+
+    return (min + max) * 0.5f;
+}
+
+inline util::vec::Vector3 AABB::getExtents() const {
+
+    return (max - min) * 0.5f;
+}
+
+inline util::vec::Vector3 AABB::getSize() const {
+
+    return max - min;
+}
+
+inline float AABB::surfaceArea() const {
+
+    util::vec::Vector3 size = max - min;
+
+    return 2.0f * ((size.getX() * size.getY()) +
+        (size.getY() * size.getZ()) + (size.getZ() * size.getX()));
+}
+
+inline void AABB::merge(const util::vec::Vector3& _point) {
+
+    float* lo = min.data();
+    float* hi = max.data();
+    const float* p = _point.data();
+
+    for (unsigned i = 0; i < 3; ++i) {
+
+        lo[i] = p[i] < lo[i] ? p[i] : lo[i];
+        hi[i] = p[i] > hi[i] ? p[i] : hi[i];
+    }
+}
+
+inline void AABB::merge(const AABB& _other) {
+
+    float* lo = min.data();
+    float* hi = max.data();
+    const float* otherLo = _other.min.data();
+    const float* otherHi = _other.max.data();
+
+    for (unsigned i = 0; i < 3; ++i) {
+
+        lo[i] = otherLo[i] < lo[i] ? otherLo[i] : lo[i];
+        hi[i] = otherHi[i] > hi[i] ? otherHi[i] : hi[i];
+    }
+}
+
+inline bool AABB::contains(const util::vec::Vector3& _point) const {
+
+    return _point.getX() >= min.getX() && _point.getX() <= max.getX() &&
+           _point.getY() >= min.getY() && _point.getY() <= max.getY() &&
+           _point.getZ() >= min.getZ() && _point.getZ() <= max.getZ();
+}
+
+inline bool AABB::contains(const AABB& _other) const {
+
+    return _other.min.getX() >= min.getX() &&
+           _other.max.getX() <= max.getX() &&
+           _other.min.getY() >= min.getY() &&
+           _other.max.getY() <= max.getY() &&
+           _other.min.getZ() >= min.getZ() &&
+           _other.max.getZ() <= max.getZ();
+}
+
+inline bool AABB::overlaps(const AABB& _other) const {
+
+    return min.getX() <= _other.max.getX() &&
+           max.getX() >= _other.min.getX() &&
+           min.getY() <= _other.max.getY() &&
+           max.getY() >= _other.min.getY() &&
+           min.getZ() <= _other.max.getZ() &&
+           max.getZ() >= _other.min.getZ();
+}
+
+inline float AABB::squaredDistance(const util::vec::Vector3& _point) const {
+
+    const float* lo = min.data();
+    const float* hi = max.data();
+    const float* p = _point.data();
+
+    float d = 0.0f;
+    for (unsigned i = 0; i < 3; ++i) {
+
+        float below = lo[i] - p[i];
+        float above = p[i] - hi[i];
+        float outside = below > 0.0f ? below : (above > 0.0f ? above : 0.0f);
+        d += outside * outside;
+    }
+
+    return d;
+}
+
+inline const util::vec::Vector3& AABB::getMin() const {
+
+    return min;
+}
+
+inline const util::vec::Vector3& AABB::getMax() const {
+
+    return max;
+}
+
+inline void AABB::setMin(const util::vec::Vector3& _min) {
+
+    min = _min;
+}
+
+inline void AABB::setMax(const util::vec::Vector3& _max) {
+
+    max = _max;
+}
+
+} } //util //spatial
+
+#endif
@@ -0,0 +1,428 @@
+/**********************************************\
+| Structure of arrays batch of bounding boxes. |
+|                                              |
+| @author David Saxon                          |
+\**********************************************/
+
+#ifndef UTILITIES_SPATIAL_AABBBATCH_H_
+#   define UTILITIES_SPATIAL_AABBBATCH_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <stdint.h>
+
+#include "../SimdUtil.hpp"
+#include "../exceptions/FunctionCallException.hpp"
+#include "../matrix/Matrix4.hpp"
+#include "../vector/Vector3Batch.hpp"
+#include "AABB.hpp"
+#include "HitRecord.hpp"
+
+namespace util { namespace spatial {
+
+/**********************************************************************\
+| Holds a batch of axis aligned boxes as a batch of minimum corners    |
+| and a batch of maximum corners so that boxes can be tested four at a |
+| time. The overlap tests only compare and load so they are bound by   |
+| memory rather than arithmetic.                                       |
+|                                                                      |
+| @author David Saxon                                                  |
+\**********************************************************************/
+class AABBBatch {
+public:
+
+    //CONSTRUCTORS
+    /*!Creates a new empty batch*/
+    AABBBatch() {
+    }
+
+    /*!Creates a new batch by copying the array of boxes
+    @_boxes the array of boxes to copy
+    @_count the number of boxes in the array*/
+    AABBBatch(const AABB* _boxes, unsigned _count) {
+
+        fromArray(_boxes, _count);
+    }
+
+    //OPERATORS
+    /*!Gets the box at the given index
+    @_index the index of the box
+    @return a copy of the box*/
+    AABB operator [](unsigned _index) const;
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!Tests each pair of boxes of the two batches for overlap
+    @_a the first batch
+    @_b the second batch, must be the same size as the first
+    @_mask must have room for maskWords(_a.size()) words, bit i % 32 of word
+    i / 32 is set when _a[i] overlaps _b[i]*/
+    static void overlaps(const AABBBatch& _a, const AABBBatch& _b,
+        uint32_t* _mask);
+
+    /*!Finds the pairs of boxes of the two batches that overlap
+    @_a the first batch
+    @_b the second batch, must be the same size as the first
+    @_indices must have room for _a.size() results, receives each i where
+    _a[i] overlaps _b[i] in ascending order
+    @return the number of overlapping pairs*/
+    static unsigned overlapping(const AABBBatch& _a, const AABBBatch& _b,
+        unsigned* _indices);
+
+    /*!Transforms every box of the batch by the matrix with Arvo's method,
+    see AABB::transform()
+    #WARNING: the bottom row of the matrix must be 0 0 0 1
+    @_a the batch to transform
+    @_m the matrix to transform by
+    @_out is resized and filled with the results, may be the input*/
+    static void transform(const AABBBatch& _a, const util::mat::Matrix4& _m,
+        AABBBatch& _out);
+
+    /*!Tests every box of the batch for overlap with the box
+    @_box the box to test against
+    @_mask must have room for maskWords(size()) words, bit i % 32 of word
+    i / 32 is set when box i overlaps _box*/
+    void overlaps(const AABB& _box, uint32_t* _mask) const;
+
+    /*!Finds the boxes of the batch that overlap the box
+    @_box the box to test against
+    @_indices must have room for size() results, receives the indices of the
+    overlapping boxes in ascending order
+    @return the number of overlapping boxes*/
+    unsigned overlapping(const AABB& _box, unsigned* _indices) const;
+
+    /*!Replaces the contents of the batch with the array of boxes
+    @_boxes the array of boxes to copy
+    @_count the number of boxes in the array*/
+    void fromArray(const AABB* _boxes, unsigned _count);
+
+    /*!Copies the batch into an array of boxes
+    @_boxes must have room for size() boxes*/
+    void toArray(AABB* _boxes) const;
+
+    /*!@return the number of boxes in the batch*/
+    unsigned size() const;
+
+    /*!Changes the number of boxes in the batch, new boxes are zero size at
+    the origin
+    @_size the new number of boxes*/
+    void resize(unsigned _size);
+
+    /*!Removes all boxes from the batch*/
+    void clear();
+
+    /*!Sets the box at the given index
+    @_index the index of the box
+    @_box the new value*/
+    void set(unsigned _index, const AABB& _box);
+
+    /*!@return the minimum corners of the boxes*/
+    util::vec::Vector3Batch& getMins();
+
+    /*!@return the minimum corners of the boxes*/
+    const util::vec::Vector3Batch& getMins() const;
+
+    /*!@return the maximum corners of the boxes*/
+    util::vec::Vector3Batch& getMaxs();
+
+    /*!@return the maximum corners of the boxes*/
+    const util::vec::Vector3Batch& getMaxs() const;
+
+private:
+
+    //VARIABLES
+    //the corners of the boxes
+    util::vec::Vector3Batch mins;
+    util::vec::Vector3Batch maxs;
+
+    //PRIVATE MEMBER FUNCTIONS
+    /*!Tests each pair of boxes for overlap
+    @_mask the mask to set or NULL
+    @_indices the list to append to or NULL
+    @return the number of overlapping pairs*/
+    static unsigned testPairs(const AABBBatch& _a, const AABBBatch& _b,
+        uint32_t* _mask, unsigned* _indices);
+
+    /*!Tests every box for overlap with the box
+    @_mask the mask to set or NULL
+    @_indices the list to append to or NULL
+    @return the number of overlapping boxes*/
+    unsigned testBox(const AABB& _box, uint32_t* _mask,
+        unsigned* _indices) const;
+
+    /*!Checks that the two batches are the same size
+    @_a the first batch
+    @_b the second batch*/
+    static void checkSize(const AABBBatch& _a, const AABBBatch& _b);
+};
+
+//INLINE
+//OPERATORS
+inline AABB AABBBatch::operator [](unsigned _index) const {
+
+    return AABB(mins[_index], maxs[_index]);
+}
+
+//PUBLIC MEMBER FUNCTIONS
+inline void AABBBatch::overlaps(const AABBBatch& _a, const AABBBatch& _b,
+    uint32_t* _mask) {
+
+    checkSize(_a, _b);
+
+    std::fill(_mask, _mask + maskWords(_a.size()), 0);
+    testPairs(_a, _b, _mask, NULL);
+}
+
+inline unsigned AABBBatch::overlapping(const AABBBatch& _a,
+    const AABBBatch& _b, unsigned* _indices) {
+
+    checkSize(_a, _b);
+
+    return testPairs(_a, _b, NULL, _indices);
+}
+
+inline void AABBBatch::transform(const AABBBatch& _a,
+    const util::mat::Matrix4& _m, AABBBatch& _out) {
+
+    unsigned count = _a.size();
+    _out.resize(count);
+
+    const float* in[2][3] = {
+        {_a.mins.getX(), _a.mins.getY(), _a.mins.getZ()},
+        {_a.maxs.getX(), _a.maxs.getY(), _a.maxs.getZ()}
+    };
+    float* out[2][3] = {
+        {_out.mins.getX(), _out.mins.getY(), _out.mins.getZ()},
+        {_out.maxs.getX(), _out.maxs.getY(), _out.maxs.getZ()}
+    };
+
+    //every output row is written after all of its inputs have been read so
+    //the batch can be transformed in place
+    unsigned i = 0;
+    if (util::simd::level() != util::simd::cpu::SCALAR) {
+
+        util::simd::Float4 m[4][3];
+        for (unsigned col = 0; col < 4; ++col) {
+
+            for (unsigned row = 0; row < 3; ++row) {
+
+                m[col][row] = util::simd::splat(_m(col, row));
+            }
+        }
+
+        for (; i + 4 <= count; i += 4) {
+
+            util::simd::Float4 lo[3];
+            util::simd::Float4 hi[3];
+            for (unsigned c = 0; c < 3; ++c) {
+
+                lo[c] = util::simd::load(in[0][c] + i);
+                hi[c] = util::simd::load(in[1][c] + i);
+            }
+
+            //an empty box has no corners to move so it is passed through
+            //unchanged, as AABB::transform() does
+            unsigned empty = util::simd::lessThan(hi[0], lo[0]) |
+                util::simd::lessThan(hi[1], lo[1]) |
+                util::simd::lessThan(hi[2], lo[2]);
+
+            for (unsigned row = 0; row < 3; ++row) {
+
+                util::simd::Float4 newLo = m[3][row];
+                util::simd::Float4 newHi = m[3][row];
+                for (unsigned col = 0; col < 3; ++col) {
+
+                    util::simd::Float4 a = util::simd::mul(m[col][row],
+                        lo[col]);
+                    util::simd::Float4 b = util::simd::mul(m[col][row],
+                        hi[col]);
+                    newLo = util::simd::add(newLo, util::simd::min(a, b));
+                    newHi = util::simd::add(newHi, util::simd::max(a, b));
+                }
+
+                util::simd::store(out[0][row] + i,
+                    util::simd::select(empty, lo[row], newLo));
+                util::simd::store(out[1][row] + i,
+                    util::simd::select(empty, hi[row], newHi));
+            }
+        }
+    }
+    for (; i < count; ++i) {
+
+        _out.set(i, AABB::transform(_a[i], _m));
+    }
+}
+
+inline void AABBBatch::overlaps(const AABB& _box, uint32_t* _mask) const {
+
+    std::fill(_mask, _mask + maskWords(size()), 0);
+    testBox(_box, _mask, NULL);
+}
+
+inline unsigned AABBBatch::overlapping(const AABB& _box,
+    unsigned* _indices) const {
+
+    return testBox(_box, NULL, _indices);
+}
+
+inline void AABBBatch::fromArray(const AABB* _boxes, unsigned _count) {
+
+    resize(_count);
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        set(i, _boxes[i]);
+    }
+}
+
+inline void AABBBatch::toArray(AABB* _boxes) const {
+
+    for (unsigned i = 0; i < size(); ++i) {
+
+        _boxes[i] = (*this)[i];
+    }
+}
+
+inline unsigned AABBBatch::size() const {
+
+    return mins.size();
+}
+
+inline void AABBBatch::resize(unsigned _size) {
+
+    mins.resize(_size);
+    maxs.resize(_size);
+}
+
+inline void AABBBatch::clear() {
+
+    mins.clear();
+    maxs.clear();
+}
+
+inline void AABBBatch::set(unsigned _index, const AABB& _box) {
+
+    mins.set(_index, _box.getMin());
+    maxs.set(_index, _box.getMax());
+}
+
+inline util::vec::Vector3Batch& AABBBatch::getMins() {
+
+    return mins;
+}
+
+inline const util::vec::Vector3Batch& AABBBatch::getMins() const {
+
+    return mins;
+}
+
+inline util::vec::Vector3Batch& AABBBatch::getMaxs() {
+
+    return maxs;
+}
+
+inline const util::vec::Vector3Batch& AABBBatch::getMaxs() const {
+
+    return maxs;
+}
+
+//PRIVATE MEMBER FUNCTIONS
+inline unsigned AABBBatch::testPairs(const AABBBatch& _a, const AABBBatch& _b,
+    uint32_t* _mask, unsigned* _indices) {
+
+    const float* aLo[3] = {_a.mins.getX(), _a.mins.getY(), _a.mins.getZ()};
+    const float* aHi[3] = {_a.maxs.getX(), _a.maxs.getY(), _a.maxs.getZ()};
+    const float* bLo[3] = {_b.mins.getX(), _b.mins.getY(), _b.mins.getZ()};
+    const float* bHi[3] = {_b.maxs.getX(), _b.maxs.getY(), _b.maxs.getZ()};
+    unsigned count = _a.size();
+
+    unsigned hits = 0;
+    unsigned i = 0;
+    if (util::simd::level() != util::simd::cpu::SCALAR) {
+
+        for (; i + 4 <= count; i += 4) {
+
+            //the boxes are apart when they are apart along any axis
+            unsigned apart = 0;
+            for (unsigned c = 0; c < 3; ++c) {
+
+                apart |= util::simd::lessThan(util::simd::load(aHi[c] + i),
+                    util::simd::load(bLo[c] + i));
+                apart |= util::simd::lessThan(util::simd::load(bHi[c] + i),
+                    util::simd::load(aLo[c] + i));
+            }
+            recordHits(i, ~apart & 0xF, 4, _mask, _indices, hits);
+        }
+    }
+    for (; i < count; ++i) {
+
+        bool overlap = true;
+        for (unsigned c = 0; c < 3; ++c) {
+
+            overlap = overlap && aHi[c][i] >= bLo[c][i] &&
+                bHi[c][i] >= aLo[c][i];
+        }
+        recordHits(i, overlap, 1, _mask, _indices, hits);
+    }
+
+    return hits;
+}
+
+inline unsigned AABBBatch::testBox(const AABB& _box, uint32_t* _mask,
+    unsigned* _indices) const {
+
+    const float* lo[3] = {mins.getX(), mins.getY(), mins.getZ()};
+    const float* hi[3] = {maxs.getX(), maxs.getY(), maxs.getZ()};
+    const float* boxLo = _box.getMin().data();
+    const float* boxHi = _box.getMax().data();
+    unsigned count = size();
+
+    unsigned hits = 0;
+    unsigned i = 0;
+    if (util::simd::level() != util::simd::cpu::SCALAR) {
+
+        util::simd::Float4 queryLo[3];
+        util::simd::Float4 queryHi[3];
+        for (unsigned c = 0; c < 3; ++c) {
+
+            queryLo[c] = util::simd::splat(boxLo[c]);
+            queryHi[c] = util::simd::splat(boxHi[c]);
+        }
+
+        for (; i + 4 <= count; i += 4) {
+
+            unsigned apart = 0;
+            for (unsigned c = 0; c < 3; ++c) {
+
+                apart |= util::simd::lessThan(util::simd::load(hi[c] + i),
+                    queryLo[c]);
+                apart |= util::simd::lessThan(queryHi[c],
+                    util::simd::load(lo[c] + i));
+            }
+            recordHits(i, ~apart & 0xF, 4, _mask, _indices, hits);
+        }
+    }
+    for (; i < count; ++i) {
+
+        bool overlap = true;
+        for (unsigned c = 0; c < 3; ++c) {
+
+            overlap = overlap && hi[c][i] >= boxLo[c] && boxHi[c] >= lo[c][i];
+        }
+        recordHits(i, overlap, 1, _mask, _indices, hits);
+    }
+
+    return hits;
+}
+
+inline void AABBBatch::checkSize(const AABBBatch& _a, const AABBBatch& _b) {
+
+    if (_a.size() != _b.size()) {
+
+        throw util::ex::IllegalArgumentException(
+            "batches must be the same size.");
+    }
+}
+
+} } //util //spatial
+
+#endif
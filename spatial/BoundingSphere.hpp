@@ -0,0 +1,334 @@
+/*********************\
+| A bounding sphere.  |
+|                     |
+| @author David Saxon |
+\*********************/
+
+#ifndef UTILITIES_SPATIAL_BOUNDINGSPHERE_H_
+#   define UTILITIES_SPATIAL_BOUNDINGSPHERE_H_
+
+#include <iostream>
+#include <math.h>
+
+#include "../matrix/Matrix4.hpp"
+#include "../vector/Vector3.hpp"
+#include "AABB.hpp"
+
+namespace util { namespace spatial {
+
+/**********************************************************************\
+| A sphere held as its centre and radius. A default sphere is empty,   |
+| its radius is negative, so merging points or spheres into it grows   |
+| it from nothing.                                                     |
+|                                                                      |
+| @author David Saxon                                                  |
+\**********************************************************************/
+class BoundingSphere {
+
+    //FRIEND FUNCTIONS
+    /*!Prints the sphere to the output stream
+    @_output the output stream to print to
+    @_sphere the sphere to print
+    @return the changed output stream*/
+    friend std::ostream& operator <<(std::ostream& _output,
+        const BoundingSphere& _sphere);
+
+public:
+
+    //CONSTRUCTORS
+    /*!Creates a new empty sphere*/
+    BoundingSphere();
+
+    /*!Creates a new sphere
+    @_centre the centre of the sphere
+    @_radius the radius of the sphere*/
+    BoundingSphere(const util::vec::Vector3& _centre, float _radius);
+
+    /*!Creates the sphere around the box, which touches its corners
+    @_box the box to surround*/
+    explicit BoundingSphere(const AABB& _box);
+
+    //OPERATORS
+    bool operator ==(const BoundingSphere& _other) const;
+
+    bool operator !=(const BoundingSphere& _other) const;
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!Creates a sphere containing the points, the sphere is centred on the
+    box around the points so it is close to but not always the smallest
+    @_points the points to contain
+    @_count the number of points
+    @return the sphere, empty if there are no points*/
+    static BoundingSphere fromPoints(const util::vec::Vector3* _points,
+        unsigned _count);
+
+    /*!Transforms the sphere by the matrix, the radius is scaled by the
+    largest scale of the matrix's axes
+    #WARNING: the bottom row of the matrix must be 0 0 0 1
+    @_sphere the sphere to transform
+    @_m the matrix to transform by
+    @return a sphere containing the transformed sphere*/
+    static BoundingSphere transform(const BoundingSphere& _sphere,
+        const util::mat::Matrix4& _m);
+
+    /*!@return whether the sphere contains nothing*/
+    bool isEmpty() const;
+
+    /*!@return the box around the sphere*/
+    AABB getBox() const;
+
+    /*!Grows the sphere to contain the point, the centre moves towards the
+    point by as little as possible
+    @_point the point to contain*/
+    void merge(const util::vec::Vector3& _point);
+
+    /*!Grows the sphere to the smallest sphere containing both spheres
+    @_other the sphere to contain*/
+    void merge(const BoundingSphere& _other);
+
+    /*!@return whether the point is inside or on the sphere*/
+    bool contains(const util::vec::Vector3& _point) const;
+
+    /*!@return whether the other sphere is entirely inside or on the sphere*/
+    bool contains(const BoundingSphere& _other) const;
+
+    /*!@return whether the spheres touch or overlap*/
+    bool overlaps(const BoundingSphere& _other) const;
+
+    /*!@return whether the sphere touches or overlaps the box*/
+    bool overlaps(const AABB& _box) const;
+
+    /*!@return the centre of the sphere*/
+    const util::vec::Vector3& getCentre() const;
+
+    /*!@return the radius of the sphere*/
+    float getRadius() const;
+
+    /*!@_centre the new centre of the sphere*/
+    void setCentre(const util::vec::Vector3& _centre);
+
+    /*!@_radius the new radius of the sphere*/
+    void setRadius(float _radius);
+
+private:
+
+    //VARIABLES
+    //the centre of the sphere
+    util::vec::Vector3 centre;
+    //the radius of the sphere
+    float radius;
+};
+
+//INLINE
+//FRIEND FUNCTIONS
+inline std::ostream& operator <<(std::ostream& _output,
+    const BoundingSphere& _sphere) {
+
+    _output << "[" << _sphere.centre << ", " << _sphere.radius << "]";
+
+    return _output;
+}
+
+//CONSTRUCTORS
+inline BoundingSphere::BoundingSphere() :
+    centre(0.0f, 0.0f, 0.0f),
+    radius(-1.0f) {
+}
+
+inline BoundingSphere::BoundingSphere(const util::vec::Vector3& _centre,
+    float _radius) :
+    centre(_centre),
+    radius(_radius) {
+}
+
+inline BoundingSphere::BoundingSphere(const AABB& _box) :
+    centre(0.0f, 0.0f, 0.0f),
+    radius(-1.0f) {
+
+    if (!_box.isEmpty()) {
+
+        centre = _box.getCentre();
+        radius = _box.getExtents().magnitude();
+    }
+}
+
+//OPERATORS
+inline bool BoundingSphere::operator ==(const BoundingSphere& _other) const {
+
+    return centre == _other.centre && radius == _other.radius;
+}
+
+inline bool BoundingSphere::operator !=(const BoundingSphere& _other) const {
+
+    return !((*this) == _other);
+}
+
+//PUBLIC MEMBER FUNCTIONS
+inline BoundingSphere BoundingSphere::fromPoints(
+    const util::vec::Vector3* _points, unsigned _count) {
+
+    if (_count == 0) {
+
+        return BoundingSphere();
+    }
+
+    util::vec::Vector3 c = AABB::fromPoints(_points, _count).getCentre();
+    float r2 = 0.0f;
+    for (unsigned i = 0; i < _count; ++i) {
+
+        float d2 = c.squaredDistance(_points[i]);
+        r2 = d2 > r2 ? d2 : r2;
+    }
+
+    return BoundingSphere(c, sqrtf(r2));
+}
+
+inline BoundingSphere BoundingSphere::transform(const BoundingSphere& _sphere,
+    const util::mat::Matrix4& _m) {
+
+    if (_sphere.isEmpty()) {
+
+        return _sphere;
+    }
+
+    const util::vec::Vector3& c = _sphere.centre;
+    util::vec::Vector3 newCentre(
+        (_m(0, 0) * c.getX()) + (_m(1, 0) * c.getY()) +
+            (_m(2, 0) * c.getZ()) + _m(3, 0),
+        (_m(0, 1) * c.getX()) + (_m(1, 1) * c.getY()) +
+            (_m(2, 1) * c.getZ()) + _m(3, 1),
+        (_m(0, 2) * c.getX()) + (_m(1, 2) * c.getY()) +
+            (_m(2, 2) * c.getZ()) + _m(3, 2));
+
+    //the largest squared length of the axes gives the largest scale
+    float scale2 = 0.0f;
+    for (unsigned col = 0; col < 3; ++col) {
+
+        float s2 = (_m(col, 0) * _m(col, 0)) + (_m(col, 1) * _m(col, 1)) +
+            (_m(col, 2) * _m(col, 2));
+        scale2 = s2 > scale2 ? s2 : scale2;
+    }
+
+    return BoundingSphere(newCentre, _sphere.radius * sqrtf(scale2));
+}
+
+inline bool BoundingSphere::isEmpty() const {
+
+    return radius < 0.0f;
+}
+
+inline AABB BoundingSphere::getBox() const {
+
+    if (isEmpty()) {
+
+        return AABB();
+    }
+
+    return AABB(centre - radius, centre + radius);
+}
+
+inline void BoundingSphere::merge(const util::vec::Vector3& _point) {
+
+    if (isEmpty()) {
+
+        centre = _point;
+        radius = 0.0f;
+        return;
+    }
+
+    float d2 = centre.squaredDistance(_point);
+    if (d2 <= radius * radius) {
+
+        return;
+    }
+
+    //the new sphere spans from the far side of the old one to the point
+    float d = sqrtf(d2);
+    float newRadius = 0.5f * (radius + d);
+    centre += (_point - centre) * ((newRadius - radius) / d);
+    radius = newRadius;
+}
+
+inline void BoundingSphere::merge(const BoundingSphere& _other) {
+
+    if (_other.isEmpty() || contains(_other)) {
+
+        return;
+    }
+    if (isEmpty() || _other.contains(*this)) {
+
+        *this = _other;
+        return;
+    }
+
+    //the new sphere spans from the far side of one to the far side of the
+    //other
+    float d = centre.distance(_other.centre);
+    float newRadius = 0.5f * (radius + d + _other.radius);
+    centre += (_other.centre - centre) * ((newRadius - radius) / d);
+    radius = newRadius;
+}
+
+inline bool BoundingSphere::contains(const util::vec::Vector3& _point) const {
+
+    return !isEmpty() && centre.squaredDistance(_point) <= radius * radius;
+}
+
+inline bool BoundingSphere::contains(const BoundingSphere& _other) const {
+
+    if (_other.isEmpty()) {
+
+        return true;
+    }
+
+    float room = radius - _other.radius;
+
+    return room >= 0.0f &&
+           centre.squaredDistance(_other.centre) <= room * room;
+}
+
+inline bool BoundingSphere::overlaps(const BoundingSphere& _other) const {
+
+    if (isEmpty() || _other.isEmpty()) {
+
+        return false;
+    }
+
+    float reach = radius + _other.radius;
+
+    return centre.squaredDistance(_other.centre) <= reach * reach;
+}
+
+inline bool BoundingSphere::overlaps(const AABB& _box) const {
+
+    if (isEmpty() || _box.isEmpty()) {
+
+        return false;
+    }
+
+    return _box.squaredDistance(centre) <= radius * radius;
+}
+
+inline const util::vec::Vector3& BoundingSphere::getCentre() const {
+
+    return centre;
+}
+
+inline float BoundingSphere::getRadius() const {
+
+    return radius;
+}
+
+inline void BoundingSphere::setCentre(const util::vec::Vector3& _centre) {
+
+    centre = _centre;
+}
+
+inline void BoundingSphere::setRadius(float _radius) {
+
+    radius = _radius;
+}
+
+} } //util //spatial
+
+#endif
@@ -0,0 +1,445 @@
+/************************************************\
+| Structure of arrays batch of bounding spheres. |
+|                                                |
+| @author David Saxon                            |
+\************************************************/
+
+#ifndef UTILITIES_SPATIAL_BOUNDINGSPHEREBATCH_H_
+#   define UTILITIES_SPATIAL_BOUNDINGSPHEREBATCH_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+#include "../SimdUtil.hpp"
+#include "../exceptions/FunctionCallException.hpp"
+#include "../matrix/Matrix4.hpp"
+#include "../vector/Vector3Batch.hpp"
+#include "BoundingSphere.hpp"
+#include "HitRecord.hpp"
+
+namespace util { namespace spatial {
+
+/**********************************************************************\
+| Holds a batch of spheres as a batch of centres and an array of radii |
+| so that spheres can be tested four at a time.                        |
+|                                                                      |
+| @author David Saxon                                                  |
+\**********************************************************************/
+class BoundingSphereBatch {
+public:
+
+    //CONSTRUCTORS
+    /*!Creates a new empty batch*/
+    BoundingSphereBatch() {
+    }
+
+    /*!Creates a new batch by copying the array of spheres
+    @_spheres the array of spheres to copy
+    @_count the number of spheres in the array*/
+    BoundingSphereBatch(const BoundingSphere* _spheres, unsigned _count) {
+
+        fromArray(_spheres, _count);
+    }
+
+    //OPERATORS
+    /*!Gets the sphere at the given index
+    @_index the index of the sphere
+    @return a copy of the sphere*/
+    BoundingSphere operator [](unsigned _index) const;
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!Tests each pair of spheres of the two batches for overlap
+    @_a the first batch
+    @_b the second batch, must be the same size as the first
+    @_mask must have room for maskWords(_a.size()) words, bit i % 32 of word
+    i / 32 is set when _a[i] overlaps _b[i]*/
+    static void overlaps(const BoundingSphereBatch& _a,
+        const BoundingSphereBatch& _b, uint32_t* _mask);
+
+    /*!Finds the pairs of spheres of the two batches that overlap
+    @_a the first batch
+    @_b the second batch, must be the same size as the first
+    @_indices must have room for _a.size() results, receives each i where
+    _a[i] overlaps _b[i] in ascending order
+    @return the number of overlapping pairs*/
+    static unsigned overlapping(const BoundingSphereBatch& _a,
+        const BoundingSphereBatch& _b, unsigned* _indices);
+
+    /*!Transforms every sphere of the batch by the matrix, see
+    BoundingSphere::transform()
+    #WARNING: the bottom row of the matrix must be 0 0 0 1
+    @_a the batch to transform
+    @_m the matrix to transform by
+    @_out is resized and filled with the results, may be the input*/
+    static void transform(const BoundingSphereBatch& _a,
+        const util::mat::Matrix4& _m, BoundingSphereBatch& _out);
+
+    /*!Tests every sphere of the batch for overlap with the sphere
+    @_sphere the sphere to test against
+    @_mask must have room for maskWords(size()) words, bit i % 32 of word
+    i / 32 is set when sphere i overlaps _sphere*/
+    void overlaps(const BoundingSphere& _sphere, uint32_t* _mask) const;
+
+    /*!Finds the spheres of the batch that overlap the sphere
+    @_sphere the sphere to test against
+    @_indices must have room for size() results, receives the indices of the
+    overlapping spheres in ascending order
+    @return the number of overlapping spheres*/
+    unsigned overlapping(const BoundingSphere& _sphere,
+        unsigned* _indices) const;
+
+    /*!Replaces the contents of the batch with the array of spheres
+    @_spheres the array of spheres to copy
+    @_count the number of spheres in the array*/
+    void fromArray(const BoundingSphere* _spheres, unsigned _count);
+
+    /*!Copies the batch into an array of spheres
+    @_spheres must have room for size() spheres*/
+    void toArray(BoundingSphere* _spheres) const;
+
+    /*!@return the number of spheres in the batch*/
+    unsigned size() const;
+
+    /*!Changes the number of spheres in the batch, new spheres are zero
+    radius at the origin
+    @_size the new number of spheres*/
+    void resize(unsigned _size);
+
+    /*!Removes all spheres from the batch*/
+    void clear();
+
+    /*!Sets the sphere at the given index
+    @_index the index of the sphere
+    @_sphere the new value*/
+    void set(unsigned _index, const BoundingSphere& _sphere);
+
+    /*!@return the centres of the spheres*/
+    util::vec::Vector3Batch& getCentres();
+
+    /*!@return the centres of the spheres*/
+    const util::vec::Vector3Batch& getCentres() const;
+
+    /*!@return the array of radii*/
+    float* getRadii();
+
+    /*!@return the array of radii*/
+    const float* getRadii() const;
+
+private:
+
+    //VARIABLES
+    //the centres of the spheres
+    util::vec::Vector3Batch centres;
+    //the radius of each sphere
+    std::vector<float> radii;
+
+    //PRIVATE MEMBER FUNCTIONS
+    /*!Tests each sphere of the batch against the sphere of the other batch
+    at the same index, or against _sphere when _other is NULL
+    @_mask the mask to set or NULL
+    @_indices the list to append to or NULL
+    @return the number of overlapping spheres*/
+    unsigned test(const BoundingSphereBatch* _other,
+        const BoundingSphere& _sphere, uint32_t* _mask,
+        unsigned* _indices) const;
+
+    /*!Tests four spheres of the batch against four other spheres
+    @_x the x values of the centres of the four spheres
+    @_y the y values of the centres of the four spheres
+    @_z the z values of the centres of the four spheres
+    @_r the radii of the four spheres
+    @_ox the x values of the centres of the other spheres
+    @_oy the y values of the centres of the other spheres
+    @_oz the z values of the centres of the other spheres
+    @_or the radii of the other spheres
+    @return a mask with bit j set when pair j does not overlap*/
+    static unsigned apart4(const float* _x, const float* _y, const float* _z,
+        const float* _r, util::simd::Float4 _ox, util::simd::Float4 _oy,
+        util::simd::Float4 _oz, util::simd::Float4 _or);
+
+    /*!Checks that the two batches are the same size
+    @_a the first batch
+    @_b the second batch*/
+    static void checkSize(const BoundingSphereBatch& _a,
+        const BoundingSphereBatch& _b);
+};
+
+//INLINE
+//OPERATORS
+inline BoundingSphere BoundingSphereBatch::operator [](unsigned _index)
+    const {
+
+    return BoundingSphere(centres[_index], radii[_index]);
+}
+
+//PUBLIC MEMBER FUNCTIONS
+inline void BoundingSphereBatch::overlaps(const BoundingSphereBatch& _a,
+    const BoundingSphereBatch& _b, uint32_t* _mask) {
+
+    checkSize(_a, _b);
+
+    std::fill(_mask, _mask + maskWords(_a.size()), 0);
+    _a.test(&_b, BoundingSphere(), _mask, NULL);
+}
+
+inline unsigned BoundingSphereBatch::overlapping(
+    const BoundingSphereBatch& _a, const BoundingSphereBatch& _b,
+    unsigned* _indices) {
+
+    checkSize(_a, _b);
+
+    return _a.test(&_b, BoundingSphere(), NULL, _indices);
+}
+
+inline void BoundingSphereBatch::transform(const BoundingSphereBatch& _a,
+    const util::mat::Matrix4& _m, BoundingSphereBatch& _out) {
+
+    unsigned count = _a.size();
+    _out.resize(count);
+
+    //the scale is the same for every sphere
+    float scale2 = 0.0f;
+    for (unsigned col = 0; col < 3; ++col) {
+
+        float s2 = (_m(col, 0) * _m(col, 0)) + (_m(col, 1) * _m(col, 1)) +
+            (_m(col, 2) * _m(col, 2));
+        scale2 = s2 > scale2 ? s2 : scale2;
+    }
+    float scale = sqrtf(scale2);
+
+    const float* ix = _a.centres.getX();
+    const float* iy = _a.centres.getY();
+    const float* iz = _a.centres.getZ();
+    const float* ir = _a.getRadii();
+    float* ox = _out.centres.getX();
+    float* oy = _out.centres.getY();
+    float* oz = _out.centres.getZ();
+    float* orad = _out.getRadii();
+
+    unsigned i = 0;
+    if (util::simd::level() != util::simd::cpu::SCALAR) {
+
+        util::simd::Float4 m[4][3];
+        for (unsigned col = 0; col < 4; ++col) {
+
+            for (unsigned row = 0; row < 3; ++row) {
+
+                m[col][row] = util::simd::splat(_m(col, row));
+            }
+        }
+        util::simd::Float4 s = util::simd::splat(scale);
+        util::simd::Float4 zero = util::simd::splat(0.0f);
+
+        for (; i + 4 <= count; i += 4) {
+
+            util::simd::Float4 x = util::simd::load(ix + i);
+            util::simd::Float4 y = util::simd::load(iy + i);
+            util::simd::Float4 z = util::simd::load(iz + i);
+            util::simd::Float4 r = util::simd::load(ir + i);
+
+            //an empty sphere is passed through unchanged, as
+            //BoundingSphere::transform() does
+            unsigned empty = util::simd::lessThan(r, zero);
+
+            util::simd::Float4 c[3];
+            for (unsigned row = 0; row < 3; ++row) {
+
+                c[row] = util::simd::add(
+                    util::simd::add(util::simd::mul(m[0][row], x),
+                        util::simd::mul(m[1][row], y)),
+                    util::simd::add(util::simd::mul(m[2][row], z),
+                        m[3][row]));
+            }
+
+            util::simd::store(ox + i, util::simd::select(empty, x, c[0]));
+            util::simd::store(oy + i, util::simd::select(empty, y, c[1]));
+            util::simd::store(oz + i, util::simd::select(empty, z, c[2]));
+            util::simd::store(orad + i,
+                util::simd::select(empty, r, util::simd::mul(r, s)));
+        }
+    }
+    for (; i < count; ++i) {
+
+        _out.set(i, BoundingSphere::transform(_a[i], _m));
+    }
+}
+
+inline void BoundingSphereBatch::overlaps(const BoundingSphere& _sphere,
+    uint32_t* _mask) const {
+
+    std::fill(_mask, _mask + maskWords(size()), 0);
+    test(NULL, _sphere, _mask, NULL);
+}
+
+inline unsigned BoundingSphereBatch::overlapping(
+    const BoundingSphere& _sphere, unsigned* _indices) const {
+
+    return test(NULL, _sphere, NULL, _indices);
+}
+
+inline void BoundingSphereBatch::fromArray(const BoundingSphere* _spheres,
+    unsigned _count) {
+
+    resize(_count);
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        set(i, _spheres[i]);
+    }
+}
+
+inline void BoundingSphereBatch::toArray(BoundingSphere* _spheres) const {
+
+    for (unsigned i = 0; i < size(); ++i) {
+
+        _spheres[i] = (*this)[i];
+    }
+}
+
+inline unsigned BoundingSphereBatch::size() const {
+
+    return centres.size();
+}
+
+inline void BoundingSphereBatch::resize(unsigned _size) {
+
+    centres.resize(_size);
+    radii.resize(_size, 0.0f);
+}
+
+inline void BoundingSphereBatch::clear() {
+
+    centres.clear();
+    radii.clear();
+}
+
+inline void BoundingSphereBatch::set(unsigned _index,
+    const BoundingSphere& _sphere) {
+
+    centres.set(_index, _sphere.getCentre());
+    radii[_index] = _sphere.getRadius();
+}
+
+inline util::vec::Vector3Batch& BoundingSphereBatch::getCentres() {
+
+    return centres;
+}
+
+inline const util::vec::Vector3Batch& BoundingSphereBatch::getCentres()
+    const {
+
+    return centres;
+}
+
+inline float* BoundingSphereBatch::getRadii() {
+
+    return radii.empty() ? NULL : &radii[0];
+}
+
+inline const float* BoundingSphereBatch::getRadii() const {
+
+    return radii.empty() ? NULL : &radii[0];
+}
+
+//PRIVATE MEMBER FUNCTIONS
+inline unsigned BoundingSphereBatch::test(const BoundingSphereBatch* _other,
+    const BoundingSphere& _sphere, uint32_t* _mask,
+    unsigned* _indices) const {
+
+    const float* ax = centres.getX();
+    const float* ay = centres.getY();
+    const float* az = centres.getZ();
+    const float* ar = getRadii();
+
+    //the single sphere is read as arrays with a stride of zero so the
+    //scalar loop is shared
+    const util::vec::Vector3& c = _sphere.getCentre();
+    float r = _sphere.getRadius();
+    const float* bx = _other != NULL ? _other->centres.getX() : &c.data()[0];
+    const float* by = _other != NULL ? _other->centres.getY() : &c.data()[1];
+    const float* bz = _other != NULL ? _other->centres.getZ() : &c.data()[2];
+    const float* br = _other != NULL ? _other->getRadii() : &r;
+    unsigned stride = _other != NULL ? 1 : 0;
+    unsigned count = size();
+
+    unsigned hits = 0;
+    unsigned i = 0;
+    if (util::simd::level() != util::simd::cpu::SCALAR) {
+
+        if (_other != NULL) {
+
+            for (; i + 4 <= count; i += 4) {
+
+                unsigned apart = apart4(ax + i, ay + i, az + i, ar + i,
+                    util::simd::load(bx + i), util::simd::load(by + i),
+                    util::simd::load(bz + i), util::simd::load(br + i));
+                recordHits(i, ~apart & 0xF, 4, _mask, _indices, hits);
+            }
+        }
+        else {
+
+            util::simd::Float4 sx = util::simd::splat(c.getX());
+            util::simd::Float4 sy = util::simd::splat(c.getY());
+            util::simd::Float4 sz = util::simd::splat(c.getZ());
+            util::simd::Float4 sr = util::simd::splat(r);
+
+            for (; i + 4 <= count; i += 4) {
+
+                unsigned apart = apart4(ax + i, ay + i, az + i, ar + i, sx,
+                    sy, sz, sr);
+                recordHits(i, ~apart & 0xF, 4, _mask, _indices, hits);
+            }
+        }
+    }
+    for (; i < count; ++i) {
+
+        unsigned j = i * stride;
+        bool overlap = BoundingSphere(
+            util::vec::Vector3(ax[i], ay[i], az[i]), ar[i]).overlaps(
+                BoundingSphere(util::vec::Vector3(bx[j], by[j], bz[j]),
+                    br[j]));
+        recordHits(i, overlap, 1, _mask, _indices, hits);
+    }
+
+    return hits;
+}
+
+inline unsigned BoundingSphereBatch::apart4(const float* _x, const float* _y,
+    const float* _z, const float* _r, util::simd::Float4 _ox,
+    util::simd::Float4 _oy, util::simd::Float4 _oz,
+    util::simd::Float4 _or) {
+
+    util::simd::Float4 r = util::simd::load(_r);
+    util::simd::Float4 dx = util::simd::sub(util::simd::load(_x), _ox);
+    util::simd::Float4 dy = util::simd::sub(util::simd::load(_y), _oy);
+    util::simd::Float4 dz = util::simd::sub(util::simd::load(_z), _oz);
+    util::simd::Float4 d2 = util::simd::add(
+        util::simd::add(util::simd::mul(dx, dx), util::simd::mul(dy, dy)),
+        util::simd::mul(dz, dz));
+    util::simd::Float4 reach = util::simd::add(r, _or);
+
+    //apart when the centres are further than the radii reach, a negative
+    //radius is an empty sphere
+    unsigned apart = util::simd::lessThan(util::simd::mul(reach, reach), d2);
+    apart |= util::simd::lessThan(r, util::simd::splat(0.0f));
+    apart |= util::simd::lessThan(_or, util::simd::splat(0.0f));
+
+    return apart;
+}
+
+inline void BoundingSphereBatch::checkSize(const BoundingSphereBatch& _a,
+    const BoundingSphereBatch& _b) {
+
+    if (_a.size() != _b.size()) {
+
+        throw util::ex::IllegalArgumentException(
+            "batches must be the same size.");
+    }
+}
+
+} } //util //spatial
+
+#endif
@@ -0,0 +1,578 @@
+/****************************************\
+| View frustum planes and batch culling. |
+|                                        |
+| @author David Saxon                    |
+\****************************************/
+
+#ifndef UTILITIES_SPATIAL_FRUSTUM_H_
+#   define UTILITIES_SPATIAL_FRUSTUM_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <math.h>
+#include <stdint.h>
+
+#include "../SimdUtil.hpp"
+#include "../exceptions/ArrayException.hpp"
+#include "../exceptions/FunctionCallException.hpp"
+#include "../matrix/Matrix4.hpp"
+#include "../vector/Vector3.hpp"
+#include "../vector/Vector3Batch.hpp"
+#include "../vector/Vector4.hpp"
+#include "AABBBatch.hpp"
+#include "BoundingSphereBatch.hpp"
+#include "HitRecord.hpp"
+
+namespace util { namespace spatial {
+
+namespace frustum {
+
+//ENUMERATORS
+//!The planes of a frustum
+enum Plane {
+
+    LEFT = 0,
+    RIGHT,
+    BOTTOM,
+    TOP,
+    Z_NEAR,
+    Z_FAR,
+    //!the number of planes
+    PLANE_COUNT
+};
+
+} //frustum
+
+/**********************************************************************\
+| The six planes of a view frustum, extracted from a projection or     |
+| view-projection matrix. Each plane is held as a Vector4 of its unit  |
+| normal, which points into the frustum, and its distance so a point   |
+| p is on the inside of the plane when dot(normal, p) + w >= 0. The    |
+| batch tests cull arrays of spheres or boxes four at a time, or eight |
+| at a time on processors with AVX2, and report what is visible either |
+| as a bit mask or as a list of indices.                               |
+|                                                                      |
+| @author David Saxon                                                  |
+\**********************************************************************/
+class Frustum {
+public:
+
+    //CONSTRUCTORS
+    /*!Extracts the planes of the frustum from the matrix, the clip space of
+    the matrix must be the same as Matrix4::perspective()'s
+    @_m the projection matrix for planes in view space, or the
+    view-projection matrix for planes in world space*/
+    explicit Frustum(const util::mat::Matrix4& _m);
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!@return the plane at the given index, see frustum::Plane*/
+    const util::vec::Vector4& getPlane(unsigned _index) const;
+
+    /*!@return whether the point is inside the frustum*/
+    bool containsPoint(const util::vec::Vector3& _point) const;
+
+    /*!@return whether any part of the sphere may be inside the frustum
+    @_centre the centre of the sphere
+    @_radius the radius of the sphere*/
+    bool intersectsSphere(const util::vec::Vector3& _centre,
+        float _radius) const;
+
+    /*!@return whether any part of the axis aligned box may be inside the
+    frustum
+    @_min the minimum corner of the box
+    @_max the maximum corner of the box*/
+    bool intersectsBox(const util::vec::Vector3& _min,
+        const util::vec::Vector3& _max) const;
+
+    /*!Tests a batch of spheres against the frustum
+    #NOTE: like intersectsSphere() a sphere near a corner of the frustum may
+    be reported visible when it is just outside
+    @_centres the centres of the spheres
+    @_radii the radius of each sphere
+    @_mask must have room for (_centres.size() + 31) / 32 words, bit i % 32
+    of word i / 32 is set when sphere i is visible*/
+    void testSpheres(const util::vec::Vector3Batch& _centres,
+        const float* _radii, uint32_t* _mask) const;
+
+    /*!Finds the visible spheres of a batch
+    @_centres the centres of the spheres
+    @_radii the radius of each sphere
+    @_indices must have room for _centres.size() results, receives the
+    indices of the visible spheres in ascending order
+    @return the number of visible spheres*/
+    unsigned visibleSpheres(const util::vec::Vector3Batch& _centres,
+        const float* _radii, unsigned* _indices) const;
+
+    /*!Tests a batch of spheres against the frustum, see testSpheres()
+    @_spheres the spheres to test
+    @_mask must have room for maskWords(_spheres.size()) words*/
+    void testSpheres(const BoundingSphereBatch& _spheres,
+        uint32_t* _mask) const;
+
+    /*!Finds the visible spheres of a batch, see visibleSpheres()
+    @_spheres the spheres to test
+    @_indices must have room for _spheres.size() results
+    @return the number of visible spheres*/
+    unsigned visibleSpheres(const BoundingSphereBatch& _spheres,
+        unsigned* _indices) const;
+
+    /*!Tests a batch of axis aligned boxes against the frustum
+    @_mins the minimum corners of the boxes
+    @_maxs the maximum corners of the boxes
+    @_mask must have room for (_mins.size() + 31) / 32 words, bit i % 32 of
+    word i / 32 is set when box i is visible*/
+    void testBoxes(const util::vec::Vector3Batch& _mins,
+        const util::vec::Vector3Batch& _maxs, uint32_t* _mask) const;
+
+    /*!Finds the visible axis aligned boxes of a batch
+    @_mins the minimum corners of the boxes
+    @_maxs the maximum corners of the boxes
+    @_indices must have room for _mins.size() results, receives the indices
+    of the visible boxes in ascending order
+    @return the number of visible boxes*/
+    unsigned visibleBoxes(const util::vec::Vector3Batch& _mins,
+        const util::vec::Vector3Batch& _maxs, unsigned* _indices) const;
+
+    /*!Tests a batch of axis aligned boxes against the frustum, see
+    testBoxes()
+    @_boxes the boxes to test
+    @_mask must have room for maskWords(_boxes.size()) words*/
+    void testBoxes(const AABBBatch& _boxes, uint32_t* _mask) const;
+
+    /*!Finds the visible axis aligned boxes of a batch, see visibleBoxes()
+    @_boxes the boxes to test
+    @_indices must have room for _boxes.size() results
+    @return the number of visible boxes*/
+    unsigned visibleBoxes(const AABBBatch& _boxes, unsigned* _indices) const;
+
+private:
+
+    //VARIABLES
+    //the planes, see frustum::Plane
+    util::vec::Vector4 planes[frustum::PLANE_COUNT];
+
+    //PRIVATE MEMBER FUNCTIONS
+    /*!Culls the spheres with the widest kernel the processor supports
+    @return the number of visible spheres*/
+    unsigned cullSpheres(const util::vec::Vector3Batch& _centres,
+        const float* _radii, uint32_t* _mask, unsigned* _indices) const;
+
+    /*!Culls the boxes with the widest kernel the processor supports
+    @return the number of visible boxes*/
+    unsigned cullBoxes(const util::vec::Vector3Batch& _mins,
+        const util::vec::Vector3Batch& _maxs, uint32_t* _mask,
+        unsigned* _indices) const;
+
+    /*!Selects the corner of each box that is furthest along the normal of
+    each plane, a box is outside when that corner is outside any plane
+    @_mins the minimum corner of the boxes
+    @_maxs the maximum corner of the boxes
+    @_corners receives the x, y and z arrays to read for each plane*/
+    void selectCorners(const util::vec::Vector3Batch& _mins,
+        const util::vec::Vector3Batch& _maxs,
+        const float* _corners[frustum::PLANE_COUNT][3]) const;
+
+    /*!Checks the mins and maxs are the same size*/
+    static void checkSize(const util::vec::Vector3Batch& _mins,
+        const util::vec::Vector3Batch& _maxs);
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+    //8 wide kernels, each returns the number of objects it tested, the rest
+    //are left to the narrower loops
+    UTIL_SIMD_TARGET("avx2,fma")
+    static unsigned cullSpheresAvx2(const util::vec::Vector4* _planes,
+        const float* _x, const float* _y, const float* _z,
+        const float* _radii, unsigned _count, uint32_t* _mask,
+        unsigned* _indices, unsigned& _visible);
+
+    UTIL_SIMD_TARGET("avx2,fma")
+    static unsigned cullBoxesAvx2(const util::vec::Vector4* _planes,
+        const float* _corners[frustum::PLANE_COUNT][3], unsigned _count,
+        uint32_t* _mask, unsigned* _indices, unsigned& _visible);
+#endif
+};
+
+//INLINE
+//CONSTRUCTORS
+inline Frustum::Frustum(const util::mat::Matrix4& _m) {
+
+    //each plane is the sum or difference of the w row with another row
+    util::vec::Vector4 w = _m.getRow(3);
+    planes[frustum::LEFT]   = w + _m.getRow(0);
+    planes[frustum::RIGHT]  = w - _m.getRow(0);
+    planes[frustum::BOTTOM] = w + _m.getRow(1);
+    planes[frustum::TOP]    = w - _m.getRow(1);
+    planes[frustum::Z_NEAR] = w + _m.getRow(2);
+    planes[frustum::Z_FAR]  = w - _m.getRow(2);
+
+    //scale the planes so the distances are true distances
+    for (unsigned i = 0; i < frustum::PLANE_COUNT; ++i) {
+
+        util::vec::Vector4& p = planes[i];
+        float length = sqrtf((p.getX() * p.getX()) + (p.getY() * p.getY()) +
+            (p.getZ() * p.getZ()));
+        p /= length;
+    }
+}
+
+//PUBLIC MEMBER FUNCTIONS
+inline const util::vec::Vector4& Frustum::getPlane(unsigned _index) const {
+
+    if (_index >= frustum::PLANE_COUNT) {
+
+        throw util::ex::IndexOutOfBoundsException(
+            "frustum plane index out of bounds.");
+    }
+
+    return planes[_index];
+}
+
+inline bool Frustum::containsPoint(const util::vec::Vector3& _point) const {
+
+    return intersectsSphere(_point, 0.0f);
+}
+
+inline bool Frustum::intersectsSphere(const util::vec::Vector3& _centre,
+    float _radius) const {
+
+    for (unsigned i = 0; i < frustum::PLANE_COUNT; ++i) {
+
+        const util::vec::Vector4& p = planes[i];
+        float d = (p.getX() * _centre.getX()) + (p.getY() * _centre.getY()) +
+            (p.getZ() * _centre.getZ()) + p.getW();
+        if (d < -_radius) {
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+inline bool Frustum::intersectsBox(const util::vec::Vector3& _min,
+    const util::vec::Vector3& _max) const {
+
+    for (unsigned i = 0; i < frustum::PLANE_COUNT; ++i) {
+
+        const util::vec::Vector4& p = planes[i];
+        float d =
+            (p.getX() * (p.getX() >= 0.0f ? _max.getX() : _min.getX())) +
+            (p.getY() * (p.getY() >= 0.0f ? _max.getY() : _min.getY())) +
+            (p.getZ() * (p.getZ() >= 0.0f ? _max.getZ() : _min.getZ())) +
+            p.getW();
+        if (d < 0.0f) {
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+inline void Frustum::testSpheres(const util::vec::Vector3Batch& _centres,
+    const float* _radii, uint32_t* _mask) const {
+
+    std::fill(_mask, _mask + maskWords(_centres.size()), 0);
+    cullSpheres(_centres, _radii, _mask, NULL);
+}
+
+inline unsigned Frustum::visibleSpheres(
+    const util::vec::Vector3Batch& _centres, const float* _radii,
+    unsigned* _indices) const {
+
+    return cullSpheres(_centres, _radii, NULL, _indices);
+}
+
+inline void Frustum::testSpheres(const BoundingSphereBatch& _spheres,
+    uint32_t* _mask) const {
+
+    testSpheres(_spheres.getCentres(), _spheres.getRadii(), _mask);
+}
+
+inline unsigned Frustum::visibleSpheres(const BoundingSphereBatch& _spheres,
+    unsigned* _indices) const {
+
+    return visibleSpheres(_spheres.getCentres(), _spheres.getRadii(),
+        _indices);
+}
+
+inline void Frustum::testBoxes(const util::vec::Vector3Batch& _mins,
+    const util::vec::Vector3Batch& _maxs, uint32_t* _mask) const {
+
+    checkSize(_mins, _maxs);
+
+    std::fill(_mask, _mask + maskWords(_mins.size()), 0);
+    cullBoxes(_mins, _maxs, _mask, NULL);
+}
+
+inline unsigned Frustum::visibleBoxes(const util::vec::Vector3Batch& _mins,
+    const util::vec::Vector3Batch& _maxs, unsigned* _indices) const {
+
+    checkSize(_mins, _maxs);
+
+    return cullBoxes(_mins, _maxs, NULL, _indices);
+}
+
+inline void Frustum::testBoxes(const AABBBatch& _boxes,
+    uint32_t* _mask) const {
+
+    testBoxes(_boxes.getMins(), _boxes.getMaxs(), _mask);
+}
+
+inline unsigned Frustum::visibleBoxes(const AABBBatch& _boxes,
+    unsigned* _indices) const {
+
+    return visibleBoxes(_boxes.getMins(), _boxes.getMaxs(), _indices);
+}
+
+//PRIVATE MEMBER FUNCTIONS
+inline unsigned Frustum::cullSpheres(const util::vec::Vector3Batch& _centres,
+    const float* _radii, uint32_t* _mask, unsigned* _indices) const {
+
+    const float* x = _centres.getX();
+    const float* y = _centres.getY();
+    const float* z = _centres.getZ();
+    unsigned count = _centres.size();
+    util::simd::cpu::Level level = util::simd::level();
+
+    unsigned visible = 0;
+    unsigned i = 0;
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (level >= util::simd::cpu::AVX2) {
+
+        i = cullSpheresAvx2(planes, x, y, z, _radii, count, _mask, _indices,
+            visible);
+    }
+#endif
+    if (level != util::simd::cpu::SCALAR) {
+
+        util::simd::Float4 px[frustum::PLANE_COUNT];
+        util::simd::Float4 py[frustum::PLANE_COUNT];
+        util::simd::Float4 pz[frustum::PLANE_COUNT];
+        util::simd::Float4 pw[frustum::PLANE_COUNT];
+        for (unsigned p = 0; p < frustum::PLANE_COUNT; ++p) {
+
+            px[p] = util::simd::splat(planes[p].getX());
+            py[p] = util::simd::splat(planes[p].getY());
+            pz[p] = util::simd::splat(planes[p].getZ());
+            pw[p] = util::simd::splat(planes[p].getW());
+        }
+
+        for (; i + 4 <= count; i += 4) {
+
+            util::simd::Float4 cx = util::simd::load(x + i);
+            util::simd::Float4 cy = util::simd::load(y + i);
+            util::simd::Float4 cz = util::simd::load(z + i);
+
+            //only the nearest plane matters, a sphere is culled when its
+            //centre is further than its radius outside of it
+            util::simd::Float4 nearest = util::simd::splat(HUGE_VALF);
+            for (unsigned p = 0; p < frustum::PLANE_COUNT; ++p) {
+
+                util::simd::Float4 d = util::simd::add(
+                    util::simd::add(util::simd::mul(px[p], cx),
+                        util::simd::mul(py[p], cy)),
+                    util::simd::add(util::simd::mul(pz[p], cz), pw[p]));
+                nearest = util::simd::min(nearest, d);
+            }
+
+            unsigned culled = util::simd::lessThan(nearest,
+                util::simd::negate(util::simd::load(_radii + i)));
+            recordHits(i, ~culled & 0xF, 4, _mask, _indices, visible);
+        }
+    }
+    for (; i < count; ++i) {
+
+        bool inside = intersectsSphere(
+            util::vec::Vector3(x[i], y[i], z[i]), _radii[i]);
+        recordHits(i, inside, 1, _mask, _indices, visible);
+    }
+
+    return visible;
+}
+
+inline unsigned Frustum::cullBoxes(const util::vec::Vector3Batch& _mins,
+    const util::vec::Vector3Batch& _maxs, uint32_t* _mask,
+    unsigned* _indices) const {
+
+    const float* corners[frustum::PLANE_COUNT][3];
+    selectCorners(_mins, _maxs, corners);
+    unsigned count = _mins.size();
+    util::simd::cpu::Level level = util::simd::level();
+
+    unsigned visible = 0;
+    unsigned i = 0;
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (level >= util::simd::cpu::AVX2) {
+
+        i = cullBoxesAvx2(planes, corners, count, _mask, _indices, visible);
+    }
+#endif
+    if (level != util::simd::cpu::SCALAR) {
+
+        util::simd::Float4 px[frustum::PLANE_COUNT];
+        util::simd::Float4 py[frustum::PLANE_COUNT];
+        util::simd::Float4 pz[frustum::PLANE_COUNT];
+        util::simd::Float4 pw[frustum::PLANE_COUNT];
+        for (unsigned p = 0; p < frustum::PLANE_COUNT; ++p) {
+
+            px[p] = util::simd::splat(planes[p].getX());
+            py[p] = util::simd::splat(planes[p].getY());
+            pz[p] = util::simd::splat(planes[p].getZ());
+            pw[p] = util::simd::splat(planes[p].getW());
+        }
+
+        for (; i + 4 <= count; i += 4) {
+
+            util::simd::Float4 nearest = util::simd::splat(HUGE_VALF);
+            for (unsigned p = 0; p < frustum::PLANE_COUNT; ++p) {
+
+                util::simd::Float4 d = util::simd::add(
+                    util::simd::add(
+                        util::simd::mul(px[p],
+                            util::simd::load(corners[p][0] + i)),
+                        util::simd::mul(py[p],
+                            util::simd::load(corners[p][1] + i))),
+                    util::simd::add(
+                        util::simd::mul(pz[p],
+                            util::simd::load(corners[p][2] + i)),
+                        pw[p]));
+                nearest = util::simd::min(nearest, d);
+            }
+
+            unsigned culled = util::simd::lessThan(nearest,
+                util::simd::splat(0.0f));
+            recordHits(i, ~culled & 0xF, 4, _mask, _indices, visible);
+        }
+    }
+    for (; i < count; ++i) {
+
+        bool inside = true;
+        for (unsigned p = 0; p < frustum::PLANE_COUNT; ++p) {
+
+            const util::vec::Vector4& plane = planes[p];
+            float d = (plane.getX() * corners[p][0][i]) +
+                (plane.getY() * corners[p][1][i]) +
+                (plane.getZ() * corners[p][2][i]) + plane.getW();
+            inside = inside && d >= 0.0f;
+        }
+        recordHits(i, inside, 1, _mask, _indices, visible);
+    }
+
+    return visible;
+}
+
+inline void Frustum::selectCorners(const util::vec::Vector3Batch& _mins,
+    const util::vec::Vector3Batch& _maxs,
+    const float* _corners[frustum::PLANE_COUNT][3]) const {
+
+    for (unsigned p = 0; p < frustum::PLANE_COUNT; ++p) {
+
+        const util::vec::Vector4& plane = planes[p];
+        _corners[p][0] = plane.getX() >= 0.0f ? _maxs.getX() : _mins.getX();
+        _corners[p][1] = plane.getY() >= 0.0f ? _maxs.getY() : _mins.getY();
+        _corners[p][2] = plane.getZ() >= 0.0f ? _maxs.getZ() : _mins.getZ();
+    }
+}
+
+inline void Frustum::checkSize(const util::vec::Vector3Batch& _mins,
+    const util::vec::Vector3Batch& _maxs) {
+
+    if (_mins.size() != _maxs.size()) {
+
+        throw util::ex::IllegalArgumentException(
+            "box minimums and maximums must be the same size.");
+    }
+}
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline unsigned Frustum::cullSpheresAvx2(const util::vec::Vector4* _planes,
+    const float* _x, const float* _y, const float* _z, const float* _radii,
+    unsigned _count, uint32_t* _mask, unsigned* _indices,
+    unsigned& _visible) {
+
+    __m256 px[frustum::PLANE_COUNT];
+    __m256 py[frustum::PLANE_COUNT];
+    __m256 pz[frustum::PLANE_COUNT];
+    __m256 pw[frustum::PLANE_COUNT];
+    for (unsigned p = 0; p < frustum::PLANE_COUNT; ++p) {
+
+        px[p] = _mm256_set1_ps(_planes[p].getX());
+        py[p] = _mm256_set1_ps(_planes[p].getY());
+        pz[p] = _mm256_set1_ps(_planes[p].getZ());
+        pw[p] = _mm256_set1_ps(_planes[p].getW());
+    }
+
+    unsigned i = 0;
+    for (; i + 8 <= _count; i += 8) {
+
+        __m256 cx = _mm256_loadu_ps(_x + i);
+        __m256 cy = _mm256_loadu_ps(_y + i);
+        __m256 cz = _mm256_loadu_ps(_z + i);
+
+        __m256 nearest = _mm256_set1_ps(HUGE_VALF);
+        for (unsigned p = 0; p < frustum::PLANE_COUNT; ++p) {
+
+            __m256 d = _mm256_fmadd_ps(px[p], cx, pw[p]);
+            d = _mm256_fmadd_ps(py[p], cy, d);
+            d = _mm256_fmadd_ps(pz[p], cz, d);
+            nearest = _mm256_min_ps(nearest, d);
+        }
+
+        __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(),
+            _mm256_loadu_ps(_radii + i));
+        unsigned culled = static_cast<unsigned>(_mm256_movemask_ps(
+            _mm256_cmp_ps(nearest, negRadius, _CMP_LT_OQ)));
+        recordHits(i, ~culled & 0xFF, 8, _mask, _indices, _visible);
+    }
+
+    return i;
+}
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline unsigned Frustum::cullBoxesAvx2(const util::vec::Vector4* _planes,
+    const float* _corners[frustum::PLANE_COUNT][3], unsigned _count,
+    uint32_t* _mask, unsigned* _indices, unsigned& _visible) {
+
+    __m256 px[frustum::PLANE_COUNT];
+    __m256 py[frustum::PLANE_COUNT];
+    __m256 pz[frustum::PLANE_COUNT];
+    __m256 pw[frustum::PLANE_COUNT];
+    for (unsigned p = 0; p < frustum::PLANE_COUNT; ++p) {
+
+        px[p] = _mm256_set1_ps(_planes[p].getX());
+        py[p] = _mm256_set1_ps(_planes[p].getY());
+        pz[p] = _mm256_set1_ps(_planes[p].getZ());
+        pw[p] = _mm256_set1_ps(_planes[p].getW());
+    }
+
+    unsigned i = 0;
+    for (; i + 8 <= _count; i += 8) {
+
+        __m256 nearest = _mm256_set1_ps(HUGE_VALF);
+        for (unsigned p = 0; p < frustum::PLANE_COUNT; ++p) {
+
+            __m256 d = _mm256_fmadd_ps(px[p],
+                _mm256_loadu_ps(_corners[p][0] + i), pw[p]);
+            d = _mm256_fmadd_ps(py[p], _mm256_loadu_ps(_corners[p][1] + i), d);
+            d = _mm256_fmadd_ps(pz[p], _mm256_loadu_ps(_corners[p][2] + i), d);
+            nearest = _mm256_min_ps(nearest, d);
+        }
+
+        unsigned culled = static_cast<unsigned>(_mm256_movemask_ps(
+            _mm256_cmp_ps(nearest, _mm256_setzero_ps(), _CMP_LT_OQ)));
+        recordHits(i, ~culled & 0xFF, 8, _mask, _indices, _visible);
+    }
+
+    return i;
+}
+#endif
+
+} } //util //spatial
+
+#endif
@@ -0,0 +1,63 @@
+/***************************************\
+| Recording the results of batch tests. |
+|                                       |
+| @author David Saxon                   |
+\***************************************/
+
+#ifndef UTILITIES_SPATIAL_HITRECORD_H_
+#   define UTILITIES_SPATIAL_HITRECORD_H_
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace util { namespace spatial {
+
+//The batch tests of the spatial types report which objects passed either as
+//a bit mask, where bit i % 32 of word i / 32 is set when object i passed, or
+//as a list of the indices of the objects that passed in ascending order.
+
+//FUNCTIONS
+/*!Records the results of up to 8 consecutive tests
+#NOTE: the kernels test 8, 4 or 1 objects at a time from an index that is a
+multiple of the same so a group never crosses a word of the mask
+@_first the index of the first object
+@_bits bit j is set when object _first + j passed
+@_n the number of objects
+@_mask the mask to set the bits in or NULL, the words must start at zero
+@_indices the list to append the indices that passed to or NULL
+@_hits the number of objects that have passed so far*/
+inline void recordHits(unsigned _first, unsigned _bits, unsigned _n,
+    uint32_t* _mask, unsigned* _indices, unsigned& _hits) {
+
+    if (_mask != NULL) {
+
+        _mask[_first / 32] |= static_cast<uint32_t>(_bits) << (_first % 32);
+    }
+    if (_indices != NULL) {
+
+        //every index is written but only kept when it passed so there is no
+        //branch to mispredict
+        for (unsigned j = 0; j < _n; ++j) {
+
+            _indices[_hits] = _first + j;
+            _hits += (_bits >> j) & 1;
+        }
+    }
+    else {
+
+        for (unsigned j = 0; j < _n; ++j) {
+
+            _hits += (_bits >> j) & 1;
+        }
+    }
+}
+
+/*!@return the number of words a mask needs for the given number of objects*/
+inline unsigned maskWords(unsigned _count) {
+
+    return (_count + 31) / 32;
+}
+
+} } //util //spatial
+
+#endif
@@ -0,0 +1,549 @@
+/****************************************\
+| k-d tree spatial index over 3D points. |
+|                                        |
+| @author David Saxon                    |
+\****************************************/
+
+#ifndef UTILITIES_SPATIAL_KDTREE_H_
+#   define UTILITIES_SPATIAL_KDTREE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#if defined(_OPENMP)
+#   include <omp.h>
+#endif
+
+#include "../exceptions/FunctionCallException.hpp"
+#include "../vector/Vector3.hpp"
+
+namespace util { namespace spatial {
+
+/*********************************************************************\
+| Indexes an array of 3D points for nearest neighbour, radius and box |
+| queries. The tree does not copy the points, it keeps a pointer to   |
+| them and an array of indices, so the points must not be changed or  |
+| destroyed while the tree is in use. The nodes are stored flattened  |
+| in depth first order so the first child of a node is the next node. |
+| Every query result is an index into the original array of points.   |
+|                                                                     |
+| @author David Saxon                                                 |
+\*********************************************************************/
+class KdTree {
+public:
+
+    //CONSTRUCTORS
+    /*!Builds a tree over the points
+    @_points the points to index, must outlive the tree
+    @_parallel whether the subtrees are built on separate threads, only when
+    built with OpenMP*/
+    explicit KdTree(const std::vector<util::vec::Vector3>& _points,
+        bool _parallel = false);
+
+    /*!Builds a tree over the array of points
+    @_points the points to index, must outlive the tree
+    @_count the number of points in the array
+    @_parallel whether the subtrees are built on separate threads, only when
+    built with OpenMP*/
+    KdTree(const util::vec::Vector3* _points, unsigned _count,
+        bool _parallel = false);
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!@return the number of points in the tree*/
+    unsigned size() const;
+
+    /*!Finds the point nearest to the position
+    @_position the position to search around
+    @return the index of the nearest point*/
+    unsigned nearest(const util::vec::Vector3& _position) const;
+
+    /*!Finds the points nearest to each of the positions
+    @_positions the positions to search around
+    @_count the number of positions
+    @_out must have room for _count results, receives the index of the
+    nearest point to each position
+    @_parallel whether the positions are split across threads, only when
+    built with OpenMP*/
+    void nearest(const util::vec::Vector3* _positions, unsigned _count,
+        unsigned* _out, bool _parallel = false) const;
+
+    /*!Finds the k points nearest to the position
+    @_position the position to search around
+    @_k the number of points to find, must not be greater than size()
+    @_out is cleared and receives the indices of the points, nearest first*/
+    void nearest(const util::vec::Vector3& _position, unsigned _k,
+        std::vector<unsigned>& _out) const;
+
+    /*!Finds the k points nearest to each of the positions
+    @_positions the positions to search around
+    @_count the number of positions
+    @_k the number of points to find, must not be greater than size()
+    @_out must have room for _count * _k results, receives the indices of the
+    points for each position, nearest first
+    @_parallel whether the positions are split across threads, only when
+    built with OpenMP*/
+    void nearest(const util::vec::Vector3* _positions, unsigned _count,
+        unsigned _k, unsigned* _out, bool _parallel = false) const;
+
+    /*!Finds every point within the radius of the position
+    @_position the centre of the sphere to search
+    @_radius the radius of the sphere to search
+    @_out is cleared and receives the indices of the points in no order*/
+    void withinRadius(const util::vec::Vector3& _position, float _radius,
+        std::vector<unsigned>& _out) const;
+
+    /*!Finds every point inside the axis aligned box, points on the edges of
+    the box are included
+    @_min the minimum corner of the box
+    @_max the maximum corner of the box
+    @_out is cleared and receives the indices of the points in no order*/
+    void withinBox(const util::vec::Vector3& _min,
+        const util::vec::Vector3& _max, std::vector<unsigned>& _out) const;
+
+private:
+
+    //STRUCTURES
+    /*~A node of the tree, covering a range of the index array*/
+    struct Node {
+
+        //the value of the axis that splits the children, the first child
+        //holds the points at or below it and the second at or above it
+        float split;
+        //the axis that is split or LEAF
+        unsigned axis;
+        //the range of the index array the node covers
+        unsigned begin;
+        unsigned end;
+        //the index of the second child, the first child is the next node
+        unsigned second;
+    };
+
+    /*~Orders indices by the value of their points on an axis*/
+    struct AxisLess {
+
+        const util::vec::Vector3* points;
+        unsigned axis;
+
+        bool operator ()(unsigned _a, unsigned _b) const {
+
+            return points[_a].data()[axis] < points[_b].data()[axis];
+        }
+    };
+
+    //VARIABLES
+    //the maximum number of points in a leaf
+    static const unsigned LEAF_SIZE = 8;
+    //the axis value of leaf nodes
+    static const unsigned LEAF = 3;
+    //subtrees with fewer points than this are built on the current thread
+    static const unsigned PARALLEL_SIZE = 16384;
+    //deeper than any tree over 32 bit indices can be
+    static const unsigned MAX_DEPTH = 64;
+
+    //the points the tree is built over
+    const util::vec::Vector3* points;
+    //the number of points
+    unsigned count;
+    //the indices of the points ordered so every node covers a range
+    std::vector<unsigned> indices;
+    //the flattened nodes, the root is the first
+    std::vector<Node> nodes;
+
+    //PRIVATE MEMBER FUNCTIONS
+    /*!Builds the nodes and orders the indices
+    @_parallel whether the subtrees are built on separate threads*/
+    void build(bool _parallel);
+
+    /*!Builds the subtree covering a range of the index array
+    @_node the index the root of the subtree is stored at
+    @_begin the start of the range
+    @_end one past the end of the range
+    @_parallel whether the children are built on separate threads*/
+    void buildNode(unsigned _node, unsigned _begin, unsigned _end,
+        bool _parallel);
+
+    /*!@return the number of nodes a subtree over the number of points has,
+    the shape of a tree only depends on how many points it has*/
+    static unsigned nodeCount(unsigned _points);
+
+    /*!@return the squared distance between the position and the point*/
+    float squaredDistance(const util::vec::Vector3& _position,
+        unsigned _point) const;
+
+    /*!Checks that k points can be found in the tree*/
+    void checkK(unsigned _k) const;
+
+    /*!Finds the k points nearest to the position, does not throw
+    #WARNING: _k must have been checked with checkK()
+    @_position the position to search around
+    @_k the number of points to find
+    @_indices receives the indices of the points, nearest first
+    @_distances must have room for _k values, used while searching*/
+    void nearest(const util::vec::Vector3& _position, unsigned _k,
+        unsigned* _indices, float* _distances) const;
+};
+
+//INLINE
+//CONSTRUCTORS
+inline KdTree::KdTree(const std::vector<util::vec::Vector3>& _points,
+    bool _parallel) :
+    points(_points.empty() ? NULL : &_points[0]),
+    count(static_cast<unsigned>(_points.size())) {
+
+    build(_parallel);
+}
+
+inline KdTree::KdTree(const util::vec::Vector3* _points, unsigned _count,
+    bool _parallel) :
+    points(_points),
+    count(_count) {
+
+    build(_parallel);
+}
+
+//PUBLIC MEMBER FUNCTIONS
+inline unsigned KdTree::size() const {
+
+    return count;
+}
+
+inline unsigned KdTree::nearest(const util::vec::Vector3& _position) const {
+
+    checkK(1);
+
+    unsigned index = 0;
+    float distance = 0.0f;
+    nearest(_position, 1, &index, &distance);
+
+    return index;
+}
+
+inline void KdTree::nearest(const util::vec::Vector3* _positions,
+    unsigned _count, unsigned* _out, bool _parallel) const {
+
+    nearest(_positions, _count, 1, _out, _parallel);
+}
+
+inline void KdTree::nearest(const util::vec::Vector3& _position, unsigned _k,
+    std::vector<unsigned>& _out) const {
+
+    _out.resize(_k);
+    if (_k == 0) {
+
+        return;
+    }
+    checkK(_k);
+
+    std::vector<float> distances(_k);
+    nearest(_position, _k, &_out[0], &distances[0]);
+}
+
+inline void KdTree::nearest(const util::vec::Vector3* _positions,
+    unsigned _count, unsigned _k, unsigned* _out, bool _parallel) const {
+
+    if (_k == 0) {
+
+        return;
+    }
+
+    //nothing may throw inside the parallel region, so the arguments are
+    //checked and every thread's search space is allocated up front
+    checkK(_k);
+#if defined(_OPENMP)
+
+    size_t threads =
+        _parallel ? static_cast<size_t>(omp_get_max_threads()) : 1;
+#else
+
+    (void) _parallel;
+    size_t threads = 1;
+#endif
+    std::vector<float> distances(threads * _k);
+
+    //every query is independent so they are shared across threads
+    int queries = static_cast<int>(_count);
+#if defined(_OPENMP)
+#   pragma omp parallel if (_parallel)
+#endif
+    {
+#if defined(_OPENMP)
+
+        float* search =
+            &distances[static_cast<size_t>(omp_get_thread_num()) * _k];
+#   pragma omp for schedule(dynamic, 64)
+#else
+
+        float* search = &distances[0];
+#endif
+        for (int i = 0; i < queries; ++i) {
+
+            nearest(_positions[i], _k, _out + (static_cast<size_t>(i) * _k),
+                search);
+        }
+    }
+}
+
+inline void KdTree::withinRadius(const util::vec::Vector3& _position,
+    float _radius, std::vector<unsigned>& _out) const {
+
+    _out.clear();
+    if (count == 0) {
+
+        return;
+    }
+
+    float squaredRadius = _radius * _radius;
+
+    unsigned stack[MAX_DEPTH];
+    unsigned depth = 0;
+    stack[depth++] = 0;
+    while (depth > 0) {
+
+        const Node& node = nodes[stack[--depth]];
+        if (node.axis == LEAF) {
+
+            for (unsigned i = node.begin; i < node.end; ++i) {
+
+                if (squaredDistance(_position, indices[i]) <= squaredRadius) {
+
+                    _out.push_back(indices[i]);
+                }
+            }
+            continue;
+        }
+
+        float value = _position.data()[node.axis];
+        unsigned first = static_cast<unsigned>(&node - &nodes[0]) + 1;
+        if (value - _radius <= node.split) {
+
+            stack[depth++] = first;
+        }
+        if (value + _radius >= node.split) {
+
+            stack[depth++] = node.second;
+        }
+    }
+}
+
+inline void KdTree::withinBox(const util::vec::Vector3& _min,
+    const util::vec::Vector3& _max, std::vector<unsigned>& _out) const {
+
+    _out.clear();
+    if (count == 0) {
+
+        return;
+    }
+
+    unsigned stack[MAX_DEPTH];
+    unsigned depth = 0;
+    stack[depth++] = 0;
+    while (depth > 0) {
+
+        const Node& node = nodes[stack[--depth]];
+        if (node.axis == LEAF) {
+
+            for (unsigned i = node.begin; i < node.end; ++i) {
+
+                const util::vec::Vector3& p = points[indices[i]];
+                if (p.getX() >= _min.getX() && p.getX() <= _max.getX() &&
+                    p.getY() >= _min.getY() && p.getY() <= _max.getY() &&
+                    p.getZ() >= _min.getZ() && p.getZ() <= _max.getZ()) {
+
+                    _out.push_back(indices[i]);
+                }
+            }
+            continue;
+        }
+
+        unsigned first = static_cast<unsigned>(&node - &nodes[0]) + 1;
+        if (_min.data()[node.axis] <= node.split) {
+
+            stack[depth++] = first;
+        }
+        if (_max.data()[node.axis] >= node.split) {
+
+            stack[depth++] = node.second;
+        }
+    }
+}
+
+//PRIVATE MEMBER FUNCTIONS
+inline void KdTree::build(bool _parallel) {
+
+    indices.resize(count);
+    for (unsigned i = 0; i < count; ++i) {
+
+        indices[i] = i;
+    }
+
+    if (count == 0) {
+
+        return;
+    }
+    nodes.resize(nodeCount(count));
+
+    //the slot of every node is known up front so subtrees can be built on
+    //separate threads without sharing anything
+#if defined(_OPENMP)
+#   pragma omp parallel if (_parallel)
+#   pragma omp single
+#endif
+    buildNode(0, 0, count, _parallel);
+}
+
+inline void KdTree::buildNode(unsigned _node, unsigned _begin, unsigned _end,
+    bool _parallel) {
+
+    Node& node = nodes[_node];
+    node.begin = _begin;
+    node.end = _end;
+    node.second = 0;
+    node.split = 0.0f;
+    node.axis = LEAF;
+    if (_end - _begin <= LEAF_SIZE) {
+
+        return;
+    }
+
+    //split the axis the points are most spread along at the median
+    const float* first = points[indices[_begin]].data();
+    float low[3] = {first[0], first[1], first[2]};
+    float high[3] = {first[0], first[1], first[2]};
+    for (unsigned i = _begin + 1; i < _end; ++i) {
+
+        const float* p = points[indices[i]].data();
+        for (unsigned a = 0; a < 3; ++a) {
+
+            low[a] = std::min(low[a], p[a]);
+            high[a] = std::max(high[a], p[a]);
+        }
+    }
+    unsigned axis = 0;
+    for (unsigned a = 1; a < 3; ++a) {
+
+        if (high[a] - low[a] > high[axis] - low[axis]) {
+
+            axis = a;
+        }
+    }
+
+    unsigned middle = _begin + ((_end - _begin) / 2);
+    AxisLess less;
+    less.points = points;
+    less.axis = axis;
+    std::nth_element(indices.begin() + _begin, indices.begin() + middle,
+        indices.begin() + _end, less);
+
+    node.axis = axis;
+    node.split = points[indices[middle]].data()[axis];
+    node.second = _node + 1 + nodeCount(middle - _begin);
+    unsigned second = node.second;
+
+#if defined(_OPENMP)
+#   pragma omp task if (_parallel && (_end - _begin) > PARALLEL_SIZE)
+#endif
+    buildNode(_node + 1, _begin, middle, _parallel);
+    buildNode(second, middle, _end, _parallel);
+#if defined(_OPENMP)
+#   pragma omp taskwait
+#endif
+}
+
+inline unsigned KdTree::nodeCount(unsigned _points) {
+
+    if (_points <= LEAF_SIZE) {
+
+        return 1;
+    }
+
+    unsigned half = _points / 2;
+    return 1 + nodeCount(half) + nodeCount(_points - half);
+}
+
+inline float KdTree::squaredDistance(const util::vec::Vector3& _position,
+    unsigned _point) const {
+
+    const util::vec::Vector3& p = points[_point];
+    float dx = p.getX() - _position.getX();
+    float dy = p.getY() - _position.getY();
+    float dz = p.getZ() - _position.getZ();
+
+    return (dx * dx) + (dy * dy) + (dz * dz);
+}
+
+inline void KdTree::checkK(unsigned _k) const {
+
+    if (count == 0) {
+
+        throw util::ex::IllegalArgumentException(
+            "cannot search a tree with no points.");
+    }
+    if (_k > count) {
+
+        throw util::ex::OversizedArgumentException(
+            "cannot find more points than are in the tree.");
+    }
+}
+
+inline void KdTree::nearest(const util::vec::Vector3& _position, unsigned _k,
+    unsigned* _indices, float* _distances) const {
+
+    //the nearest points found so far, sorted nearest first
+    unsigned found = 0;
+
+    //every entry is a node and the squared distance from the position to
+    //the region of the node along the axis that led to it
+    unsigned stack[MAX_DEPTH];
+    float bounds[MAX_DEPTH];
+    unsigned depth = 0;
+    stack[depth] = 0;
+    bounds[depth++] = 0.0f;
+    while (depth > 0) {
+
+        --depth;
+        if (found == _k && bounds[depth] > _distances[_k - 1]) {
+
+            continue;
+        }
+
+        const Node& node = nodes[stack[depth]];
+        if (node.axis == LEAF) {
+
+            for (unsigned i = node.begin; i < node.end; ++i) {
+
+                float d = squaredDistance(_position, indices[i]);
+                if (found == _k && d >= _distances[_k - 1]) {
+
+                    continue;
+                }
+
+                //insert into the sorted list, dropping the furthest
+                unsigned slot = found < _k ? found++ : _k - 1;
+                for (; slot > 0 && _distances[slot - 1] > d; --slot) {
+
+                    _distances[slot] = _distances[slot - 1];
+                    _indices[slot] = _indices[slot - 1];
+                }
+                _distances[slot] = d;
+                _indices[slot] = indices[i];
+            }
+            continue;
+        }
+
+        //the far child is pushed first so the near child is searched first
+        float offset = _position.data()[node.axis] - node.split;
+        unsigned first = stack[depth] + 1;
+        unsigned nearChild = offset < 0.0f ? first : node.second;
+        unsigned farChild = offset < 0.0f ? node.second : first;
+
+        stack[depth] = farChild;
+        bounds[depth++] = offset * offset;
+        stack[depth] = nearChild;
+        bounds[depth++] = 0.0f;
+    }
+}
+
+} } //util //spatial
+
+#endif
@@ -0,0 +1,247 @@
+/***********************************\
+| A ray and its intersection tests. |
+|                                   |
+| @author David Saxon               |
+\***********************************/
+
+#ifndef UTILITIES_SPATIAL_RAY_H_
+#   define UTILITIES_SPATIAL_RAY_H_
+
+#include <iostream>
+#include <limits>
+
+#include "../vector/Vector3.hpp"
+#include "AABB.hpp"
+
+namespace util { namespace spatial {
+
+/*~Where a ray hit a triangle*/
+struct RayHit {
+
+    //VARIABLES
+    //!the index returned when nothing was hit
+    static const unsigned MISS = 0xFFFFFFFF;
+
+    //!the distance along the ray in multiples of its direction
+    float t;
+    //!the barycentric coordinate of the hit along the first edge
+    float u;
+    //!the barycentric coordinate of the hit along the second edge
+    float v;
+    //!the index of the triangle hit or MISS
+    unsigned index;
+
+    //CONSTRUCTORS
+    /*!Creates a new miss, a hit must be nearer than the given distance to
+    replace it
+    @_maxT the furthest distance along the ray a hit may be*/
+    explicit RayHit(float _maxT = std::numeric_limits<float>::infinity()) :
+        t(_maxT),
+        u(0.0f),
+        v(0.0f),
+        index(MISS) {
+    }
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!@return whether a triangle was hit*/
+    bool isHit() const {
+
+        return index != MISS;
+    }
+};
+
+/**********************************************************************\
+| A ray from an origin along a direction, the direction does not need  |
+| to be unit length, distances along the ray are in multiples of it.   |
+| The triangle test is Moller and Trumbore's and hits either side of a |
+| triangle, the box test is the slab test.                             |
+|                                                                      |
+| @author David Saxon                                                  |
+\**********************************************************************/
+class Ray {
+
+    //FRIEND FUNCTIONS
+    /*!Prints the ray to the output stream
+    @_output the output stream to print to
+    @_ray the ray to print
+    @return the changed output stream*/
+    friend std::ostream& operator <<(std::ostream& _output, const Ray& _ray);
+
+public:
+
+    //CONSTRUCTORS
+    /*!Creates a new ray
+    @_origin the point the ray starts from
+    @_direction the direction the ray travels*/
+    Ray(const util::vec::Vector3& _origin,
+        const util::vec::Vector3& _direction);
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!@return the point the given distance along the ray*/
+    util::vec::Vector3 at(float _t) const;
+
+    /*!Intersects the ray with a triangle
+    @_v0 the first corner of the triangle
+    @_v1 the second corner of the triangle
+    @_v2 the third corner of the triangle
+    @_hit is replaced when the ray hits the triangle nearer than _hit.t and
+    no nearer than 0, the index is set to 0
+    @return whether the hit was replaced*/
+    bool intersects(const util::vec::Vector3& _v0,
+        const util::vec::Vector3& _v1, const util::vec::Vector3& _v2,
+        RayHit& _hit) const;
+
+    /*!Intersects the ray with an axis aligned box
+    @_box the box to intersect
+    @_tNear receives the distance the ray enters the box, negative when the
+    origin is inside the box
+    @_tFar receives the distance the ray leaves the box
+    @return whether the ray hits the box*/
+    bool intersects(const AABB& _box, float& _tNear, float& _tFar) const;
+
+    /*!@return the point the ray starts from*/
+    const util::vec::Vector3& getOrigin() const;
+
+    /*!@return the direction the ray travels*/
+    const util::vec::Vector3& getDirection() const;
+
+    /*!@return the reciprocal of each element of the direction*/
+    const util::vec::Vector3& getInverseDirection() const;
+
+    /*!@_origin the new point the ray starts from*/
+    void setOrigin(const util::vec::Vector3& _origin);
+
+    /*!@_direction the new direction the ray travels*/
+    void setDirection(const util::vec::Vector3& _direction);
+
+private:
+
+    //VARIABLES
+    //the point the ray starts from
+    util::vec::Vector3 origin;
+    //the direction the ray travels
+    util::vec::Vector3 direction;
+    //the reciprocal of the direction, used by the slab test
+    util::vec::Vector3 inverseDirection;
+};
+
+//INLINE
+//FRIEND FUNCTIONS
+inline std::ostream& operator <<(std::ostream& _output, const Ray& _ray) {
+
+    _output << "[" << _ray.origin << ", " << _ray.direction << "]";
+
+    return _output;
+}
+
+//CONSTRUCTORS
+inline Ray::Ray(const util::vec::Vector3& _origin,
+    const util::vec::Vector3& _direction) :
+    origin(_origin) {
+
+    setDirection(_direction);
+}
+
+//PUBLIC MEMBER FUNCTIONS
+inline util::vec::Vector3 Ray::at(float _t) const {
+
+    return origin + (direction * _t);
+}
+
+inline bool Ray::intersects(const util::vec::Vector3& _v0,
+    const util::vec::Vector3& _v1, const util::vec::Vector3& _v2,
+    RayHit& _hit) const {
+
+    util::vec::Vector3 e1 = _v1 - _v0;
+    util::vec::Vector3 e2 = _v2 - _v0;
+
+    util::vec::Vector3 p = direction.crossProduct(e2);
+    float det = e1.dotProduct(p);
+
+    //the ray is parallel to the triangle
+    if (det == 0.0f) {
+
+        return false;
+    }
+    float invDet = 1.0f / det;
+
+    util::vec::Vector3 s = origin - _v0;
+    float u = s.dotProduct(p) * invDet;
+    if (u < 0.0f || u > 1.0f) {
+
+        return false;
+    }
+
+    util::vec::Vector3 q = s.crossProduct(e1);
+    float v = direction.dotProduct(q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) {
+
+        return false;
+    }
+
+    float t = e2.dotProduct(q) * invDet;
+    if (t < 0.0f || t >= _hit.t) {
+
+        return false;
+    }
+
+    _hit.t = t;
+    _hit.u = u;
+    _hit.v = v;
+    _hit.index = 0;
+    return true;
+}
+
+inline bool Ray::intersects(const AABB& _box, float& _tNear,
+    float& _tFar) const {
+
+    const float* o = origin.data();
+    const float* inv = inverseDirection.data();
+    const float* lo = _box.getMin().data();
+    const float* hi = _box.getMax().data();
+
+    _tNear = -std::numeric_limits<float>::infinity();
+    _tFar = std::numeric_limits<float>::infinity();
+    for (unsigned i = 0; i < 3; ++i) {
+
+        float t1 = (lo[i] - o[i]) * inv[i];
+        float t2 = (hi[i] - o[i]) * inv[i];
+        float entry = t1 < t2 ? t1 : t2;
+        float exit = t1 < t2 ? t2 : t1;
+        _tNear = entry > _tNear ? entry : _tNear;
+        _tFar = exit < _tFar ? exit : _tFar;
+    }
+
+    return _tNear <= _tFar && _tFar >= 0.0f;
+}
+
+inline const util::vec::Vector3& Ray::getOrigin() const {
+
+    return origin;
+}
+
+inline const util::vec::Vector3& Ray::getDirection() const {
+
+    return direction;
+}
+
+inline const util::vec::Vector3& Ray::getInverseDirection() const {
+
+    return inverseDirection;
+}
+
+inline void Ray::setOrigin(const util::vec::Vector3& _origin) {
+
+    origin = _origin;
+}
+
+inline void Ray::setDirection(const util::vec::Vector3& _direction) {
+
+    direction = _direction;
+    inverseDirection = util::vec::Vector3(1.0f / direction.getX(),
+        1.0f / direction.getY(), 1.0f / direction.getZ());
+}
+
+} } //util //spatial
+
+#endif
@@ -0,0 +1,717 @@
+/************************************\
+| Structure of arrays batch of rays. |
+|                                    |
+| @author David Saxon                |
+\************************************/
+
+#ifndef UTILITIES_SPATIAL_RAYBATCH_H_
+#   define UTILITIES_SPATIAL_RAYBATCH_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <math.h>
+#include <stdint.h>
+
+#include "../SimdUtil.hpp"
+#include "../vector/Vector3.hpp"
+#include "../vector/Vector3Batch.hpp"
+#include "AABB.hpp"
+#include "HitRecord.hpp"
+#include "Ray.hpp"
+#include "TriangleBatch.hpp"
+
+namespace util { namespace spatial {
+
+/**********************************************************************\
+| Holds a packet of rays as batches of origins, directions and the     |
+| reciprocals of the directions so that four or eight rays can be      |
+| tested against one triangle or one box at a time. Rays that start    |
+| near each other and point the same way, such as the rays of a tile   |
+| of pixels, tend to hit the same objects so they share the loads of   |
+| the object.                                                          |
+|                                                                      |
+| @author David Saxon                                                  |
+\**********************************************************************/
+class RayBatch {
+public:
+
+    //CONSTRUCTORS
+    /*!Creates a new empty batch*/
+    RayBatch() {
+    }
+
+    /*!Creates a new batch by copying the array of rays
+    @_rays the array of rays to copy
+    @_count the number of rays in the array*/
+    RayBatch(const Ray* _rays, unsigned _count) {
+
+        fromArray(_rays, _count);
+    }
+
+    //OPERATORS
+    /*!Gets the ray at the given index
+    @_index the index of the ray
+    @return a copy of the ray*/
+    Ray operator [](unsigned _index) const;
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!Intersects every ray of the batch with the triangle
+    @_v0 the first corner of the triangle
+    @_v1 the second corner of the triangle
+    @_v2 the third corner of the triangle
+    @_index the index given to hits on the triangle
+    @_hits must hold size() hits, _hits[i] is replaced when ray i hits the
+    triangle nearer than _hits[i].t and no nearer than 0
+    @return the number of hits replaced*/
+    unsigned intersect(const util::vec::Vector3& _v0,
+        const util::vec::Vector3& _v1, const util::vec::Vector3& _v2,
+        unsigned _index, RayHit* _hits) const;
+
+    /*!Intersects every ray of the batch with every triangle, the batch is
+    tested against one triangle at a time
+    @_triangles the triangles to intersect
+    @_hits must hold size() hits, _hits[i] is replaced by the nearest hit of
+    ray i that is nearer than _hits[i].t and no nearer than 0
+    @return the number of rays whose hit was replaced*/
+    unsigned intersect(const TriangleBatch& _triangles, RayHit* _hits) const;
+
+    /*!Tests every ray of the batch against the box with the slab test
+    #NOTE: a ray that lies exactly in the plane of a face of the box may miss
+    it
+    @_box the box to test against
+    @_mask must have room for maskWords(size()) words, bit i % 32 of word
+    i / 32 is set when ray i hits the box
+    @_tNear receives the distance each ray enters the box, negative when its
+    origin is inside, or NULL*/
+    void intersects(const AABB& _box, uint32_t* _mask,
+        float* _tNear = NULL) const;
+
+    /*!Finds the rays of the batch that hit the box, see intersects()
+    @_box the box to test against
+    @_indices must have room for size() results, receives the indices of the
+    rays that hit the box in ascending order
+    @_tNear receives the distance each ray enters the box or NULL, written
+    for every ray whether it hits or not
+    @return the number of rays that hit the box*/
+    unsigned intersecting(const AABB& _box, unsigned* _indices,
+        float* _tNear = NULL) const;
+
+    /*!Replaces the contents of the batch with the array of rays
+    @_rays the array of rays to copy
+    @_count the number of rays in the array*/
+    void fromArray(const Ray* _rays, unsigned _count);
+
+    /*!Copies the batch into an array of rays
+    @_rays must have room for size() rays*/
+    void toArray(Ray* _rays) const;
+
+    /*!@return the number of rays in the batch*/
+    unsigned size() const;
+
+    /*!Changes the number of rays in the batch, new rays start at the origin
+    and point along the z axis
+    @_size the new number of rays*/
+    void resize(unsigned _size);
+
+    /*!Removes all rays from the batch*/
+    void clear();
+
+    /*!Sets the ray at the given index
+    @_index the index of the ray
+    @_ray the new value*/
+    void set(unsigned _index, const Ray& _ray);
+
+    /*!@return the origins of the rays*/
+    const util::vec::Vector3Batch& getOrigins() const;
+
+    /*!@return the directions of the rays*/
+    const util::vec::Vector3Batch& getDirections() const;
+
+    /*!@return the reciprocals of the directions of the rays*/
+    const util::vec::Vector3Batch& getInverseDirections() const;
+
+private:
+
+    //VARIABLES
+    //the origins of the rays
+    util::vec::Vector3Batch origins;
+    //the directions of the rays
+    util::vec::Vector3Batch directions;
+    //the reciprocals of the directions, used by the slab test
+    util::vec::Vector3Batch inverseDirections;
+
+    //PRIVATE MEMBER FUNCTIONS
+    /*!Intersects a range of the rays with the triangle
+    @_triangle the first corner, the first edge and the second edge of the
+    triangle
+    @_begin the first ray to intersect
+    @_end one past the last ray to intersect
+    @_changed bit i - _begin is set when the hit of ray i is replaced, or NULL
+    when the range is more than 64 rays
+    @return the number of hits replaced*/
+    unsigned intersectTriangle(const float* _triangle, unsigned _index,
+        RayHit* _hits, unsigned _begin, unsigned _end,
+        uint64_t* _changed) const;
+
+    /*!Replaces the hits of a group of rays that are nearer
+    @_first the index of the first ray of the group
+    @_bits bit j is set when ray _first + j hit the triangle
+    @_t the distance of each hit
+    @_u the first barycentric coordinate of each hit
+    @_v the second barycentric coordinate of each hit
+    @_index the index of the triangle
+    @return bit j is set when the hit of ray _first + j was replaced*/
+    static unsigned keepNearest(unsigned _first, unsigned _bits,
+        const float* _t, const float* _u, const float* _v, unsigned _index,
+        RayHit* _hits);
+
+    /*!Records the hits a group of rays replaced
+    @_lanes bit j is set when the hit of the j-th ray of the group was
+    replaced, see keepNearest()
+    @_offset the position of the group's first ray in the range, see
+    intersectTriangle()
+    @_changed the bits of the range to set or NULL
+    @return the number of hits replaced*/
+    static unsigned markReplaced(unsigned _lanes, unsigned _offset,
+        uint64_t* _changed);
+
+    /*!Tests every ray against the box
+    @_mask the mask to set or NULL
+    @_indices the list to append to or NULL
+    @_tNear the entry distances to write or NULL
+    @return the number of rays that hit the box*/
+    unsigned testBox(const AABB& _box, uint32_t* _mask, unsigned* _indices,
+        float* _tNear) const;
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+    //8 wide kernels, each returns the number of rays it tested, the rest are
+    //left to the narrower loops
+    UTIL_SIMD_TARGET("avx2,fma")
+    static unsigned intersectAvx2(const float* const* _rays,
+        const float* _triangle, unsigned _begin, unsigned _end,
+        unsigned _index, RayHit* _hits, uint64_t* _changed,
+        unsigned& _replaced);
+
+    UTIL_SIMD_TARGET("avx2,fma")
+    static unsigned testBoxAvx2(const float* const* _rays, const float* _lo,
+        const float* _hi, unsigned _count, uint32_t* _mask,
+        unsigned* _indices, float* _tNear, unsigned& _hits);
+#endif
+};
+
+//INLINE
+//OPERATORS
+inline Ray RayBatch::operator [](unsigned _index) const {
+
+    return Ray(origins[_index], directions[_index]);
+}
+
+//PUBLIC MEMBER FUNCTIONS
+inline unsigned RayBatch::intersect(const util::vec::Vector3& _v0,
+    const util::vec::Vector3& _v1, const util::vec::Vector3& _v2,
+    unsigned _index, RayHit* _hits) const {
+
+    util::vec::Vector3 e1 = _v1 - _v0;
+    util::vec::Vector3 e2 = _v2 - _v0;
+    const float triangle[9] = {
+        _v0.getX(), _v0.getY(), _v0.getZ(),
+        e1.getX(),  e1.getY(),  e1.getZ(),
+        e2.getX(),  e2.getY(),  e2.getZ()
+    };
+
+    return intersectTriangle(triangle, _index, _hits, 0, size(), NULL);
+}
+
+inline unsigned RayBatch::intersect(const TriangleBatch& _triangles,
+    RayHit* _hits) const {
+
+    //the rays are taken 64 at a time through every triangle so each block
+    //can track which of its hits were replaced in one word, the hits may
+    //already hold the indices of another batch's triangles so they cannot
+    //be compared instead
+    const unsigned BLOCK = 64;
+
+    const util::vec::Vector3Batch& corners = _triangles.getCorners();
+    const util::vec::Vector3Batch& edges1 = _triangles.getFirstEdges();
+    const util::vec::Vector3Batch& edges2 = _triangles.getSecondEdges();
+    unsigned count = size();
+
+    unsigned replaced = 0;
+    for (unsigned begin = 0; begin < count; begin += BLOCK) {
+
+        unsigned end = begin + BLOCK < count ? begin + BLOCK : count;
+        uint64_t changed = 0;
+        for (unsigned j = 0; j < _triangles.size(); ++j) {
+
+            const float triangle[9] = {
+                corners.getX()[j], corners.getY()[j], corners.getZ()[j],
+                edges1.getX()[j],  edges1.getY()[j],  edges1.getZ()[j],
+                edges2.getX()[j],  edges2.getY()[j],  edges2.getZ()[j]
+            };
+            intersectTriangle(triangle, j, _hits, begin, end, &changed);
+        }
+
+        for (; changed != 0; changed &= changed - 1) {
+
+            ++replaced;
+        }
+    }
+
+    return replaced;
+}
+
+inline void RayBatch::intersects(const AABB& _box, uint32_t* _mask,
+    float* _tNear) const {
+
+    std::fill(_mask, _mask + maskWords(size()), 0);
+    testBox(_box, _mask, NULL, _tNear);
+}
+
+inline unsigned RayBatch::intersecting(const AABB& _box, unsigned* _indices,
+    float* _tNear) const {
+
+    return testBox(_box, NULL, _indices, _tNear);
+}
+
+inline void RayBatch::fromArray(const Ray* _rays, unsigned _count) {
+
+    resize(_count);
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        set(i, _rays[i]);
+    }
+}
+
+inline void RayBatch::toArray(Ray* _rays) const {
+
+    for (unsigned i = 0; i < size(); ++i) {
+
+        _rays[i] = (*this)[i];
+    }
+}
+
+inline unsigned RayBatch::size() const {
+
+    return origins.size();
+}
+
+inline void RayBatch::resize(unsigned _size) {
+
+    unsigned oldSize = size();
+    origins.resize(_size);
+    directions.resize(_size);
+    inverseDirections.resize(_size);
+
+    for (unsigned i = oldSize; i < _size; ++i) {
+
+        set(i, Ray(util::vec::Vector3(0.0f, 0.0f, 0.0f),
+            util::vec::Vector3(0.0f, 0.0f, 1.0f)));
+    }
+}
+
+inline void RayBatch::clear() {
+
+    origins.clear();
+    directions.clear();
+    inverseDirections.clear();
+}
+
+inline void RayBatch::set(unsigned _index, const Ray& _ray) {
+
+    origins.set(_index, _ray.getOrigin());
+    directions.set(_index, _ray.getDirection());
+    inverseDirections.set(_index, _ray.getInverseDirection());
+}
+
+inline const util::vec::Vector3Batch& RayBatch::getOrigins() const {
+
+    return origins;
+}
+
+inline const util::vec::Vector3Batch& RayBatch::getDirections() const {
+
+    return directions;
+}
+
+inline const util::vec::Vector3Batch& RayBatch::getInverseDirections() const {
+
+    return inverseDirections;
+}
+
+//PRIVATE MEMBER FUNCTIONS
+inline unsigned RayBatch::intersectTriangle(const float* _triangle,
+    unsigned _index, RayHit* _hits, unsigned _begin, unsigned _end,
+    uint64_t* _changed) const {
+
+    //the origin and direction arrays
+    const float* rays[6] = {
+        origins.getX(),    origins.getY(),    origins.getZ(),
+        directions.getX(), directions.getY(), directions.getZ()
+    };
+    util::simd::cpu::Level level = util::simd::level();
+
+    unsigned replaced = 0;
+    unsigned i = _begin;
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (level >= util::simd::cpu::AVX2) {
+
+        i = intersectAvx2(rays, _triangle, _begin, _end, _index, _hits,
+            _changed, replaced);
+    }
+#endif
+    if (level != util::simd::cpu::SCALAR) {
+
+        util::simd::Float4 tri[9];
+        for (unsigned c = 0; c < 9; ++c) {
+
+            tri[c] = util::simd::splat(_triangle[c]);
+        }
+        util::simd::Float4 zero = util::simd::splat(0.0f);
+        util::simd::Float4 one = util::simd::splat(1.0f);
+
+        for (; i + 4 <= _end; i += 4) {
+
+            util::simd::Float4 dx = util::simd::load(rays[3] + i);
+            util::simd::Float4 dy = util::simd::load(rays[4] + i);
+            util::simd::Float4 dz = util::simd::load(rays[5] + i);
+
+            //p = d x e2
+            util::simd::Float4 px = util::simd::sub(util::simd::mul(dy,
+                tri[8]), util::simd::mul(dz, tri[7]));
+            util::simd::Float4 py = util::simd::sub(util::simd::mul(dz,
+                tri[6]), util::simd::mul(dx, tri[8]));
+            util::simd::Float4 pz = util::simd::sub(util::simd::mul(dx,
+                tri[7]), util::simd::mul(dy, tri[6]));
+            util::simd::Float4 det = util::simd::add(util::simd::add(
+                util::simd::mul(tri[3], px), util::simd::mul(tri[4], py)),
+                util::simd::mul(tri[5], pz));
+            util::simd::Float4 invDet = util::simd::div(one, det);
+
+            //s = o - v0
+            util::simd::Float4 sx = util::simd::sub(
+                util::simd::load(rays[0] + i), tri[0]);
+            util::simd::Float4 sy = util::simd::sub(
+                util::simd::load(rays[1] + i), tri[1]);
+            util::simd::Float4 sz = util::simd::sub(
+                util::simd::load(rays[2] + i), tri[2]);
+            util::simd::Float4 u = util::simd::mul(util::simd::add(
+                util::simd::add(util::simd::mul(sx, px),
+                util::simd::mul(sy, py)), util::simd::mul(sz, pz)), invDet);
+
+            //q = s x e1
+            util::simd::Float4 qx = util::simd::sub(util::simd::mul(sy,
+                tri[5]), util::simd::mul(sz, tri[4]));
+            util::simd::Float4 qy = util::simd::sub(util::simd::mul(sz,
+                tri[3]), util::simd::mul(sx, tri[5]));
+            util::simd::Float4 qz = util::simd::sub(util::simd::mul(sx,
+                tri[4]), util::simd::mul(sy, tri[3]));
+            util::simd::Float4 v = util::simd::mul(util::simd::add(
+                util::simd::add(util::simd::mul(dx, qx),
+                util::simd::mul(dy, qy)), util::simd::mul(dz, qz)), invDet);
+            util::simd::Float4 t = util::simd::mul(util::simd::add(
+                util::simd::add(util::simd::mul(tri[6], qx),
+                util::simd::mul(tri[7], qy)), util::simd::mul(tri[8], qz)),
+                invDet);
+
+            //a parallel ray gives a zero determinant, which is neither less
+            //nor greater than zero
+            unsigned hits = util::simd::lessThan(det, zero) |
+                util::simd::lessThan(zero, det);
+            hits &= ~(util::simd::lessThan(u, zero) |
+                util::simd::lessThan(one, u) |
+                util::simd::lessThan(v, zero) |
+                util::simd::lessThan(one, util::simd::add(u, v)) |
+                util::simd::lessThan(t, zero));
+
+            if (hits != 0) {
+
+                float tLanes[4];
+                float uLanes[4];
+                float vLanes[4];
+                util::simd::store(tLanes, t);
+                util::simd::store(uLanes, u);
+                util::simd::store(vLanes, v);
+                replaced += markReplaced(keepNearest(i, hits, tLanes,
+                    uLanes, vLanes, _index, _hits), i - _begin, _changed);
+            }
+        }
+    }
+    for (; i < _end; ++i) {
+
+        float o[3] = {rays[0][i], rays[1][i], rays[2][i]};
+        float d[3] = {rays[3][i], rays[4][i], rays[5][i]};
+        const float* e1 = _triangle + 3;
+        const float* e2 = _triangle + 6;
+
+        float p[3] = {
+            (d[1] * e2[2]) - (d[2] * e2[1]),
+            (d[2] * e2[0]) - (d[0] * e2[2]),
+            (d[0] * e2[1]) - (d[1] * e2[0])
+        };
+        float det = (e1[0] * p[0]) + (e1[1] * p[1]) + (e1[2] * p[2]);
+        if (det == 0.0f) {
+
+            continue;
+        }
+        float invDet = 1.0f / det;
+
+        float s[3] = {
+            o[0] - _triangle[0], o[1] - _triangle[1], o[2] - _triangle[2]
+        };
+        float u = ((s[0] * p[0]) + (s[1] * p[1]) + (s[2] * p[2])) * invDet;
+
+        float q[3] = {
+            (s[1] * e1[2]) - (s[2] * e1[1]),
+            (s[2] * e1[0]) - (s[0] * e1[2]),
+            (s[0] * e1[1]) - (s[1] * e1[0])
+        };
+        float v = ((d[0] * q[0]) + (d[1] * q[1]) + (d[2] * q[2])) * invDet;
+        float t = ((e2[0] * q[0]) + (e2[1] * q[1]) + (e2[2] * q[2])) * invDet;
+
+        bool hit = u >= 0.0f && u <= 1.0f && v >= 0.0f && u + v <= 1.0f &&
+            t >= 0.0f;
+        replaced += markReplaced(keepNearest(i, hit, &t, &u, &v, _index,
+            _hits), i - _begin, _changed);
+    }
+
+    return replaced;
+}
+
+inline unsigned RayBatch::keepNearest(unsigned _first, unsigned _bits,
+    const float* _t, const float* _u, const float* _v, unsigned _index,
+    RayHit* _hits) {
+
+    unsigned replaced = 0;
+    for (unsigned j = 0; _bits != 0; ++j, _bits >>= 1) {
+
+        RayHit& hit = _hits[_first + j];
+        if ((_bits & 1) != 0 && _t[j] < hit.t) {
+
+            hit.t = _t[j];
+            hit.u = _u[j];
+            hit.v = _v[j];
+            hit.index = _index;
+            replaced |= 1U << j;
+        }
+    }
+
+    return replaced;
+}
+
+inline unsigned RayBatch::markReplaced(unsigned _lanes, unsigned _offset,
+    uint64_t* _changed) {
+
+    if (_changed != NULL) {
+
+        *_changed |= static_cast<uint64_t>(_lanes) << _offset;
+    }
+
+    unsigned count = 0;
+    for (; _lanes != 0; _lanes &= _lanes - 1) {
+
+        ++count;
+    }
+    return count;
+}
+
+inline unsigned RayBatch::testBox(const AABB& _box, uint32_t* _mask,
+    unsigned* _indices, float* _tNear) const {
+
+    //the origin and inverse direction arrays
+    const float* rays[6] = {
+        origins.getX(),           origins.getY(),
+        origins.getZ(),           inverseDirections.getX(),
+        inverseDirections.getY(), inverseDirections.getZ()
+    };
+    const float* lo = _box.getMin().data();
+    const float* hi = _box.getMax().data();
+    unsigned count = size();
+    util::simd::cpu::Level level = util::simd::level();
+
+    unsigned hits = 0;
+    unsigned i = 0;
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (level >= util::simd::cpu::AVX2) {
+
+        i = testBoxAvx2(rays, lo, hi, count, _mask, _indices, _tNear, hits);
+    }
+#endif
+    if (level != util::simd::cpu::SCALAR) {
+
+        util::simd::Float4 boxLo[3];
+        util::simd::Float4 boxHi[3];
+        for (unsigned c = 0; c < 3; ++c) {
+
+            boxLo[c] = util::simd::splat(lo[c]);
+            boxHi[c] = util::simd::splat(hi[c]);
+        }
+        util::simd::Float4 zero = util::simd::splat(0.0f);
+
+        for (; i + 4 <= count; i += 4) {
+
+            util::simd::Float4 tNear = util::simd::splat(-HUGE_VALF);
+            util::simd::Float4 tFar = util::simd::splat(HUGE_VALF);
+            for (unsigned c = 0; c < 3; ++c) {
+
+                util::simd::Float4 o = util::simd::load(rays[c] + i);
+                util::simd::Float4 inv = util::simd::load(rays[c + 3] + i);
+                util::simd::Float4 t1 = util::simd::mul(
+                    util::simd::sub(boxLo[c], o), inv);
+                util::simd::Float4 t2 = util::simd::mul(
+                    util::simd::sub(boxHi[c], o), inv);
+                tNear = util::simd::max(util::simd::min(t1, t2), tNear);
+                tFar = util::simd::min(util::simd::max(t1, t2), tFar);
+            }
+
+            if (_tNear != NULL) {
+
+                util::simd::store(_tNear + i, tNear);
+            }
+            unsigned miss = util::simd::lessThan(tFar, tNear) |
+                util::simd::lessThan(tFar, zero);
+            recordHits(i, ~miss & 0xF, 4, _mask, _indices, hits);
+        }
+    }
+    for (; i < count; ++i) {
+
+        float tNear = -HUGE_VALF;
+        float tFar = HUGE_VALF;
+        for (unsigned c = 0; c < 3; ++c) {
+
+            float t1 = (lo[c] - rays[c][i]) * rays[c + 3][i];
+            float t2 = (hi[c] - rays[c][i]) * rays[c + 3][i];
+            float entry = t1 < t2 ? t1 : t2;
+            float exit = t1 < t2 ? t2 : t1;
+            tNear = entry > tNear ? entry : tNear;
+            tFar = exit < tFar ? exit : tFar;
+        }
+
+        if (_tNear != NULL) {
+
+            _tNear[i] = tNear;
+        }
+        recordHits(i, tNear <= tFar && tFar >= 0.0f, 1, _mask, _indices,
+            hits);
+    }
+
+    return hits;
+}
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline unsigned RayBatch::intersectAvx2(const float* const* _rays,
+    const float* _triangle, unsigned _begin, unsigned _end, unsigned _index,
+    RayHit* _hits, uint64_t* _changed, unsigned& _replaced) {
+
+    __m256 tri[9];
+    for (unsigned c = 0; c < 9; ++c) {
+
+        tri[c] = _mm256_set1_ps(_triangle[c]);
+    }
+    __m256 zero = _mm256_setzero_ps();
+    __m256 one = _mm256_set1_ps(1.0f);
+
+    unsigned i = _begin;
+    for (; i + 8 <= _end; i += 8) {
+
+        __m256 dx = _mm256_loadu_ps(_rays[3] + i);
+        __m256 dy = _mm256_loadu_ps(_rays[4] + i);
+        __m256 dz = _mm256_loadu_ps(_rays[5] + i);
+
+        __m256 px = _mm256_fmsub_ps(dy, tri[8], _mm256_mul_ps(dz, tri[7]));
+        __m256 py = _mm256_fmsub_ps(dz, tri[6], _mm256_mul_ps(dx, tri[8]));
+        __m256 pz = _mm256_fmsub_ps(dx, tri[7], _mm256_mul_ps(dy, tri[6]));
+        __m256 det = _mm256_fmadd_ps(tri[5], pz,
+            _mm256_fmadd_ps(tri[4], py, _mm256_mul_ps(tri[3], px)));
+        __m256 invDet = _mm256_div_ps(one, det);
+
+        __m256 sx = _mm256_sub_ps(_mm256_loadu_ps(_rays[0] + i), tri[0]);
+        __m256 sy = _mm256_sub_ps(_mm256_loadu_ps(_rays[1] + i), tri[1]);
+        __m256 sz = _mm256_sub_ps(_mm256_loadu_ps(_rays[2] + i), tri[2]);
+        __m256 u = _mm256_mul_ps(_mm256_fmadd_ps(sz, pz,
+            _mm256_fmadd_ps(sy, py, _mm256_mul_ps(sx, px))), invDet);
+
+        __m256 qx = _mm256_fmsub_ps(sy, tri[5], _mm256_mul_ps(sz, tri[4]));
+        __m256 qy = _mm256_fmsub_ps(sz, tri[3], _mm256_mul_ps(sx, tri[5]));
+        __m256 qz = _mm256_fmsub_ps(sx, tri[4], _mm256_mul_ps(sy, tri[3]));
+        __m256 v = _mm256_mul_ps(_mm256_fmadd_ps(dz, qz,
+            _mm256_fmadd_ps(dy, qy, _mm256_mul_ps(dx, qx))), invDet);
+        __m256 t = _mm256_mul_ps(_mm256_fmadd_ps(tri[8], qz,
+            _mm256_fmadd_ps(tri[7], qy, _mm256_mul_ps(tri[6], qx))), invDet);
+
+        __m256 hit = _mm256_cmp_ps(det, zero, _CMP_NEQ_OQ);
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(u, one, _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit,
+            _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+        unsigned hits = static_cast<unsigned>(_mm256_movemask_ps(hit));
+
+        if (hits != 0) {
+
+            float tLanes[8];
+            float uLanes[8];
+            float vLanes[8];
+            _mm256_storeu_ps(tLanes, t);
+            _mm256_storeu_ps(uLanes, u);
+            _mm256_storeu_ps(vLanes, v);
+            _replaced += markReplaced(keepNearest(i, hits, tLanes, uLanes,
+                vLanes, _index, _hits), i - _begin, _changed);
+        }
+    }
+
+    return i;
+}
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline unsigned RayBatch::testBoxAvx2(const float* const* _rays,
+    const float* _lo, const float* _hi, unsigned _count, uint32_t* _mask,
+    unsigned* _indices, float* _tNear, unsigned& _hits) {
+
+    __m256 boxLo[3];
+    __m256 boxHi[3];
+    for (unsigned c = 0; c < 3; ++c) {
+
+        boxLo[c] = _mm256_set1_ps(_lo[c]);
+        boxHi[c] = _mm256_set1_ps(_hi[c]);
+    }
+    __m256 zero = _mm256_setzero_ps();
+
+    unsigned i = 0;
+    for (; i + 8 <= _count; i += 8) {
+
+        __m256 tNear = _mm256_set1_ps(-HUGE_VALF);
+        __m256 tFar = _mm256_set1_ps(HUGE_VALF);
+        for (unsigned c = 0; c < 3; ++c) {
+
+            __m256 o = _mm256_loadu_ps(_rays[c] + i);
+            __m256 inv = _mm256_loadu_ps(_rays[c + 3] + i);
+            __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(boxLo[c], o), inv);
+            __m256 t2 = _mm256_mul_ps(_mm256_sub_ps(boxHi[c], o), inv);
+            tNear = _mm256_max_ps(_mm256_min_ps(t1, t2), tNear);
+            tFar = _mm256_min_ps(_mm256_max_ps(t1, t2), tFar);
+        }
+
+        if (_tNear != NULL) {
+
+            _mm256_storeu_ps(_tNear + i, tNear);
+        }
+        unsigned miss = static_cast<unsigned>(_mm256_movemask_ps(
+            _mm256_or_ps(_mm256_cmp_ps(tFar, tNear, _CMP_LT_OQ),
+            _mm256_cmp_ps(tFar, zero, _CMP_LT_OQ))));
+        recordHits(i, ~miss & 0xFF, 8, _mask, _indices, _hits);
+    }
+
+    return i;
+}
+#endif
+
+} } //util //spatial
+
+#endif
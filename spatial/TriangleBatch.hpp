@@ -0,0 +1,472 @@
+/*****************************************\
+| Structure of arrays batch of triangles. |
+|                                         |
+| @author David Saxon                     |
+\*****************************************/
+
+#ifndef UTILITIES_SPATIAL_TRIANGLEBATCH_H_
+#   define UTILITIES_SPATIAL_TRIANGLEBATCH_H_
+
+#include <limits>
+
+#include "../SimdUtil.hpp"
+#include "../vector/Vector3.hpp"
+#include "../vector/Vector3Batch.hpp"
+#include "Ray.hpp"
+
+namespace util { namespace spatial {
+
+/**********************************************************************\
+| Holds a batch of triangles as a batch of first corners and batches   |
+| of the two edges leaving the first corner, the edges are what the    |
+| Moller and Trumbore test needs so they are worked out once when a    |
+| triangle is set rather than every time a ray is cast. A ray is       |
+| tested against four or eight triangles at a time.                    |
+|                                                                      |
+| @author David Saxon                                                  |
+\**********************************************************************/
+class TriangleBatch {
+public:
+
+    //CONSTRUCTORS
+    /*!Creates a new empty batch*/
+    TriangleBatch() {
+    }
+
+    /*!Creates a new batch from an array of corners
+    @_vertices the three corners of each triangle one after the other
+    @_count the number of triangles*/
+    TriangleBatch(const util::vec::Vector3* _vertices, unsigned _count) {
+
+        fromArray(_vertices, _count);
+    }
+
+    /*!Creates a new batch from an indexed mesh
+    @_vertices the vertices of the mesh
+    @_indices the indices of the three corners of each triangle one after the
+    other
+    @_count the number of triangles*/
+    TriangleBatch(const util::vec::Vector3* _vertices,
+        const unsigned* _indices, unsigned _count) {
+
+        fromArray(_vertices, _indices, _count);
+    }
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!Finds the nearest triangle the ray hits
+    @_ray the ray to cast
+    @_hit is replaced by the nearest hit that is nearer than _hit.t and no
+    nearer than 0, the index is the index of the triangle
+    @return whether the hit was replaced*/
+    bool intersect(const Ray& _ray, RayHit& _hit) const;
+
+    /*!Finds whether the ray hits any triangle, this stops at the first hit so
+    is quicker than intersect() when only visibility is needed
+    @_ray the ray to cast
+    @_maxT the furthest distance along the ray a hit may be
+    @return whether any triangle is hit no nearer than 0 and nearer than
+    _maxT*/
+    bool occluded(const Ray& _ray,
+        float _maxT = std::numeric_limits<float>::infinity()) const;
+
+    /*!Replaces the contents of the batch with an array of corners
+    @_vertices the three corners of each triangle one after the other
+    @_count the number of triangles*/
+    void fromArray(const util::vec::Vector3* _vertices, unsigned _count);
+
+    /*!Replaces the contents of the batch with an indexed mesh
+    @_vertices the vertices of the mesh
+    @_indices the indices of the three corners of each triangle one after the
+    other
+    @_count the number of triangles*/
+    void fromArray(const util::vec::Vector3* _vertices,
+        const unsigned* _indices, unsigned _count);
+
+    /*!@return the number of triangles in the batch*/
+    unsigned size() const;
+
+    /*!Changes the number of triangles in the batch, new triangles have all
+    three corners at the origin
+    @_size the new number of triangles*/
+    void resize(unsigned _size);
+
+    /*!Removes all triangles from the batch*/
+    void clear();
+
+    /*!Sets the triangle at the given index
+    @_index the index of the triangle
+    @_v0 the first corner
+    @_v1 the second corner
+    @_v2 the third corner*/
+    void set(unsigned _index, const util::vec::Vector3& _v0,
+        const util::vec::Vector3& _v1, const util::vec::Vector3& _v2);
+
+    /*!@return the first corners of the triangles*/
+    const util::vec::Vector3Batch& getCorners() const;
+
+    /*!@return the edges from the first to the second corners*/
+    const util::vec::Vector3Batch& getFirstEdges() const;
+
+    /*!@return the edges from the first to the third corners*/
+    const util::vec::Vector3Batch& getSecondEdges() const;
+
+private:
+
+    //VARIABLES
+    //the first corners of the triangles
+    util::vec::Vector3Batch corners;
+    //the edges leaving the first corners
+    util::vec::Vector3Batch edges1;
+    util::vec::Vector3Batch edges2;
+
+    //PRIVATE MEMBER FUNCTIONS
+    /*!Tests the ray against every triangle
+    @_any whether to stop at the first hit
+    @return whether the hit was replaced*/
+    bool test(const Ray& _ray, RayHit& _hit, bool _any) const;
+
+    /*!Keeps the nearest of a group of hits
+    @_first the index of the first triangle of the group
+    @_bits bit j is set when triangle _first + j was hit
+    @_t the distance of each hit
+    @_u the first barycentric coordinate of each hit
+    @_v the second barycentric coordinate of each hit
+    @_hit is replaced by any hit nearer than it
+    @return whether the hit was replaced*/
+    static bool keepNearest(unsigned _first, unsigned _bits, const float* _t,
+        const float* _u, const float* _v, RayHit& _hit);
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+    //8 wide kernel, returns the number of triangles it tested, the rest are
+    //left to the narrower loops, _replaced is set when the hit is replaced
+    UTIL_SIMD_TARGET("avx2,fma")
+    static unsigned testAvx2(const float* const* _arrays, const Ray& _ray,
+        unsigned _count, bool _any, RayHit& _hit, bool& _replaced);
+#endif
+};
+
+//INLINE
+//PUBLIC MEMBER FUNCTIONS
+inline bool TriangleBatch::intersect(const Ray& _ray, RayHit& _hit) const {
+
+    return test(_ray, _hit, false);
+}
+
+inline bool TriangleBatch::occluded(const Ray& _ray, float _maxT) const {
+
+    RayHit hit(_maxT);
+
+    return test(_ray, hit, true);
+}
+
+inline void TriangleBatch::fromArray(const util::vec::Vector3* _vertices,
+    unsigned _count) {
+
+    resize(_count);
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        set(i, _vertices[i * 3], _vertices[(i * 3) + 1],
+            _vertices[(i * 3) + 2]);
+    }
+}
+
+inline void TriangleBatch::fromArray(const util::vec::Vector3* _vertices,
+    const unsigned* _indices, unsigned _count) {
+
+    resize(_count);
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        set(i, _vertices[_indices[i * 3]], _vertices[_indices[(i * 3) + 1]],
+            _vertices[_indices[(i * 3) + 2]]);
+    }
+}
+
+inline unsigned TriangleBatch::size() const {
+
+    return corners.size();
+}
+
+inline void TriangleBatch::resize(unsigned _size) {
+
+    corners.resize(_size);
+    edges1.resize(_size);
+    edges2.resize(_size);
+}
+
+inline void TriangleBatch::clear() {
+
+    corners.clear();
+    edges1.clear();
+    edges2.clear();
+}
+
+inline void TriangleBatch::set(unsigned _index,
+    const util::vec::Vector3& _v0, const util::vec::Vector3& _v1,
+    const util::vec::Vector3& _v2) {
+
+    corners.set(_index, _v0);
+    edges1.set(_index, _v1 - _v0);
+    edges2.set(_index, _v2 - _v0);
+}
+
+inline const util::vec::Vector3Batch& TriangleBatch::getCorners() const {
+
+    return corners;
+}
+
+inline const util::vec::Vector3Batch& TriangleBatch::getFirstEdges() const {
+
+    return edges1;
+}
+
+inline const util::vec::Vector3Batch& TriangleBatch::getSecondEdges() const {
+
+    return edges2;
+}
+
+//PRIVATE MEMBER FUNCTIONS
+inline bool TriangleBatch::test(const Ray& _ray, RayHit& _hit,
+    bool _any) const {
+
+    //the corner, first edge and second edge arrays
+    const float* arrays[9] = {
+        corners.getX(), corners.getY(), corners.getZ(),
+        edges1.getX(),  edges1.getY(),  edges1.getZ(),
+        edges2.getX(),  edges2.getY(),  edges2.getZ()
+    };
+    const float* o = _ray.getOrigin().data();
+    const float* d = _ray.getDirection().data();
+    unsigned count = size();
+    //the hit may already hold the same index from another batch so whether
+    //it was replaced is tracked rather than found by comparing indices
+    bool replaced = false;
+    util::simd::cpu::Level level = util::simd::level();
+
+    unsigned i = 0;
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (level >= util::simd::cpu::AVX2) {
+
+        i = testAvx2(arrays, _ray, count, _any, _hit, replaced);
+    }
+#endif
+    if (level != util::simd::cpu::SCALAR) {
+
+        util::simd::Float4 ox = util::simd::splat(o[0]);
+        util::simd::Float4 oy = util::simd::splat(o[1]);
+        util::simd::Float4 oz = util::simd::splat(o[2]);
+        util::simd::Float4 dx = util::simd::splat(d[0]);
+        util::simd::Float4 dy = util::simd::splat(d[1]);
+        util::simd::Float4 dz = util::simd::splat(d[2]);
+        util::simd::Float4 zero = util::simd::splat(0.0f);
+        util::simd::Float4 one = util::simd::splat(1.0f);
+
+        for (; i + 4 <= count && !(_any && replaced); i += 4) {
+
+            util::simd::Float4 e1x = util::simd::load(arrays[3] + i);
+            util::simd::Float4 e1y = util::simd::load(arrays[4] + i);
+            util::simd::Float4 e1z = util::simd::load(arrays[5] + i);
+            util::simd::Float4 e2x = util::simd::load(arrays[6] + i);
+            util::simd::Float4 e2y = util::simd::load(arrays[7] + i);
+            util::simd::Float4 e2z = util::simd::load(arrays[8] + i);
+
+            //p = d x e2
+            util::simd::Float4 px = util::simd::sub(util::simd::mul(dy, e2z),
+                util::simd::mul(dz, e2y));
+            util::simd::Float4 py = util::simd::sub(util::simd::mul(dz, e2x),
+                util::simd::mul(dx, e2z));
+            util::simd::Float4 pz = util::simd::sub(util::simd::mul(dx, e2y),
+                util::simd::mul(dy, e2x));
+            util::simd::Float4 det = util::simd::add(util::simd::add(
+                util::simd::mul(e1x, px), util::simd::mul(e1y, py)),
+                util::simd::mul(e1z, pz));
+            util::simd::Float4 invDet = util::simd::div(one, det);
+
+            //s = o - v0
+            util::simd::Float4 sx = util::simd::sub(ox,
+                util::simd::load(arrays[0] + i));
+            util::simd::Float4 sy = util::simd::sub(oy,
+                util::simd::load(arrays[1] + i));
+            util::simd::Float4 sz = util::simd::sub(oz,
+                util::simd::load(arrays[2] + i));
+            util::simd::Float4 u = util::simd::mul(util::simd::add(
+                util::simd::add(util::simd::mul(sx, px),
+                util::simd::mul(sy, py)), util::simd::mul(sz, pz)), invDet);
+
+            //q = s x e1
+            util::simd::Float4 qx = util::simd::sub(util::simd::mul(sy, e1z),
+                util::simd::mul(sz, e1y));
+            util::simd::Float4 qy = util::simd::sub(util::simd::mul(sz, e1x),
+                util::simd::mul(sx, e1z));
+            util::simd::Float4 qz = util::simd::sub(util::simd::mul(sx, e1y),
+                util::simd::mul(sy, e1x));
+            util::simd::Float4 v = util::simd::mul(util::simd::add(
+                util::simd::add(util::simd::mul(dx, qx),
+                util::simd::mul(dy, qy)), util::simd::mul(dz, qz)), invDet);
+            util::simd::Float4 t = util::simd::mul(util::simd::add(
+                util::simd::add(util::simd::mul(e2x, qx),
+                util::simd::mul(e2y, qy)), util::simd::mul(e2z, qz)), invDet);
+
+            //a parallel ray gives a zero determinant, which is neither less
+            //nor greater than zero
+            unsigned hits = util::simd::lessThan(det, zero) |
+                util::simd::lessThan(zero, det);
+            hits &= ~(util::simd::lessThan(u, zero) |
+                util::simd::lessThan(one, u) |
+                util::simd::lessThan(v, zero) |
+                util::simd::lessThan(one, util::simd::add(u, v)) |
+                util::simd::lessThan(t, zero));
+            hits &= util::simd::lessThan(t, util::simd::splat(_hit.t));
+
+            if (hits != 0) {
+
+                float tLanes[4];
+                float uLanes[4];
+                float vLanes[4];
+                util::simd::store(tLanes, t);
+                util::simd::store(uLanes, u);
+                util::simd::store(vLanes, v);
+                replaced |= keepNearest(i, hits, tLanes, uLanes, vLanes,
+                    _hit);
+            }
+        }
+    }
+    for (; i < count && !(_any && replaced); ++i) {
+
+        float e1[3] = {arrays[3][i], arrays[4][i], arrays[5][i]};
+        float e2[3] = {arrays[6][i], arrays[7][i], arrays[8][i]};
+
+        float p[3] = {
+            (d[1] * e2[2]) - (d[2] * e2[1]),
+            (d[2] * e2[0]) - (d[0] * e2[2]),
+            (d[0] * e2[1]) - (d[1] * e2[0])
+        };
+        float det = (e1[0] * p[0]) + (e1[1] * p[1]) + (e1[2] * p[2]);
+        if (det == 0.0f) {
+
+            continue;
+        }
+        float invDet = 1.0f / det;
+
+        float s[3] = {
+            o[0] - arrays[0][i], o[1] - arrays[1][i], o[2] - arrays[2][i]
+        };
+        float u = ((s[0] * p[0]) + (s[1] * p[1]) + (s[2] * p[2])) * invDet;
+
+        float q[3] = {
+            (s[1] * e1[2]) - (s[2] * e1[1]),
+            (s[2] * e1[0]) - (s[0] * e1[2]),
+            (s[0] * e1[1]) - (s[1] * e1[0])
+        };
+        float v = ((d[0] * q[0]) + (d[1] * q[1]) + (d[2] * q[2])) * invDet;
+        float t = ((e2[0] * q[0]) + (e2[1] * q[1]) + (e2[2] * q[2])) * invDet;
+
+        bool hit = u >= 0.0f && u <= 1.0f && v >= 0.0f && u + v <= 1.0f &&
+            t >= 0.0f;
+        replaced |= keepNearest(i, hit, &t, &u, &v, _hit);
+    }
+
+    return replaced;
+}
+
+inline bool TriangleBatch::keepNearest(unsigned _first, unsigned _bits,
+    const float* _t, const float* _u, const float* _v, RayHit& _hit) {
+
+    bool replaced = false;
+    for (unsigned j = 0; _bits != 0; ++j, _bits >>= 1) {
+
+        if ((_bits & 1) != 0 && _t[j] < _hit.t) {
+
+            _hit.t = _t[j];
+            _hit.u = _u[j];
+            _hit.v = _v[j];
+            _hit.index = _first + j;
+            replaced = true;
+        }
+    }
+
+    return replaced;
+}
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline unsigned TriangleBatch::testAvx2(const float* const* _arrays,
+    const Ray& _ray, unsigned _count, bool _any, RayHit& _hit,
+    bool& _replaced) {
+
+    const float* o = _ray.getOrigin().data();
+    const float* d = _ray.getDirection().data();
+    __m256 ox = _mm256_set1_ps(o[0]);
+    __m256 oy = _mm256_set1_ps(o[1]);
+    __m256 oz = _mm256_set1_ps(o[2]);
+    __m256 dx = _mm256_set1_ps(d[0]);
+    __m256 dy = _mm256_set1_ps(d[1]);
+    __m256 dz = _mm256_set1_ps(d[2]);
+    __m256 zero = _mm256_setzero_ps();
+    __m256 one = _mm256_set1_ps(1.0f);
+
+    unsigned i = 0;
+    for (; i + 8 <= _count && !(_any && _replaced); i += 8) {
+
+        __m256 e1x = _mm256_loadu_ps(_arrays[3] + i);
+        __m256 e1y = _mm256_loadu_ps(_arrays[4] + i);
+        __m256 e1z = _mm256_loadu_ps(_arrays[5] + i);
+        __m256 e2x = _mm256_loadu_ps(_arrays[6] + i);
+        __m256 e2y = _mm256_loadu_ps(_arrays[7] + i);
+        __m256 e2z = _mm256_loadu_ps(_arrays[8] + i);
+
+        __m256 px = _mm256_fmsub_ps(dy, e2z, _mm256_mul_ps(dz, e2y));
+        __m256 py = _mm256_fmsub_ps(dz, e2x, _mm256_mul_ps(dx, e2z));
+        __m256 pz = _mm256_fmsub_ps(dx, e2y, _mm256_mul_ps(dy, e2x));
+        __m256 det = _mm256_fmadd_ps(e1z, pz,
+            _mm256_fmadd_ps(e1y, py, _mm256_mul_ps(e1x, px)));
+        __m256 invDet = _mm256_div_ps(one, det);
+
+        __m256 sx = _mm256_sub_ps(ox, _mm256_loadu_ps(_arrays[0] + i));
+        __m256 sy = _mm256_sub_ps(oy, _mm256_loadu_ps(_arrays[1] + i));
+        __m256 sz = _mm256_sub_ps(oz, _mm256_loadu_ps(_arrays[2] + i));
+        __m256 u = _mm256_mul_ps(_mm256_fmadd_ps(sz, pz,
+            _mm256_fmadd_ps(sy, py, _mm256_mul_ps(sx, px))), invDet);
+
+        __m256 qx = _mm256_fmsub_ps(sy, e1z, _mm256_mul_ps(sz, e1y));
+        __m256 qy = _mm256_fmsub_ps(sz, e1x, _mm256_mul_ps(sx, e1z));
+        __m256 qz = _mm256_fmsub_ps(sx, e1y, _mm256_mul_ps(sy, e1x));
+        __m256 v = _mm256_mul_ps(_mm256_fmadd_ps(dz, qz,
+            _mm256_fmadd_ps(dy, qy, _mm256_mul_ps(dx, qx))), invDet);
+        __m256 t = _mm256_mul_ps(_mm256_fmadd_ps(e2z, qz,
+            _mm256_fmadd_ps(e2y, qy, _mm256_mul_ps(e2x, qx))), invDet);
+
+        __m256 hit = _mm256_cmp_ps(det, zero, _CMP_NEQ_OQ);
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(u, one, _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit,
+            _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit,
+            _mm256_cmp_ps(t, _mm256_set1_ps(_hit.t), _CMP_LT_OQ));
+        unsigned hits = static_cast<unsigned>(_mm256_movemask_ps(hit));
+
+        if (hits != 0) {
+
+            float tLanes[8];
+            float uLanes[8];
+            float vLanes[8];
+            _mm256_storeu_ps(tLanes, t);
+            _mm256_storeu_ps(uLanes, u);
+            _mm256_storeu_ps(vLanes, v);
+            _replaced |= keepNearest(i, hits, tLanes, uLanes, vLanes, _hit);
+        }
+    }
+
+    return i;
+}
+#endif
+
+} } //util //spatial
+
+#endif
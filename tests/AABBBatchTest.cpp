@@ -0,0 +1,81 @@
+/***************************************\
+| Tests for the batched AABB transform. |
+|                                       |
+| @author David Saxon                   |
+\***************************************/
+
+#include <cstdlib>
+#include <vector>
+
+#include "../spatial/AABBBatch.hpp"
+#include "Check.hpp"
+
+using util::spatial::AABB;
+using util::spatial::AABBBatch;
+using util::vec::Vector3;
+
+static float random(float _range) {
+
+    return ((std::rand() / static_cast<float>(RAND_MAX)) * 2.0f - 1.0f) *
+        _range;
+}
+
+int main() {
+
+    std::srand(11);
+
+    //default boxes are empty, they are spread through the batch so some
+    //fall in SIMD groups and some in the scalar tail
+    std::vector<AABB> boxes;
+    for (unsigned i = 0; i < 23; ++i) {
+
+        if (i % 3 == 0 || i < 4 || i == 22) {
+
+            boxes.push_back(AABB());
+            continue;
+        }
+        Vector3 a(random(10.0f), random(10.0f), random(10.0f));
+        Vector3 b(random(10.0f), random(10.0f), random(10.0f));
+        boxes.push_back(AABB(
+            Vector3(std::min(a.getX(), b.getX()), std::min(a.getY(), b.getY()),
+                std::min(a.getZ(), b.getZ())),
+            Vector3(std::max(a.getX(), b.getX()), std::max(a.getY(), b.getY()),
+                std::max(a.getZ(), b.getZ()))));
+    }
+    util::mat::Matrix4 m = util::mat::Matrix4::translation(
+        Vector3(1.0f, -2.0f, 3.0f)) * util::mat::Matrix4::rotationXYZ(
+        Vector3(30.0f, 45.0f, 60.0f)) * util::mat::Matrix4::scale(
+        Vector3(2.0f, 1.0f, 0.5f));
+
+    for (int level = 0; level <= util::test::maxLevel(); ++level) {
+
+        util::simd::setLevel(static_cast<util::simd::cpu::Level>(level));
+
+        AABBBatch batch(&boxes[0], static_cast<unsigned>(boxes.size()));
+        AABBBatch out;
+        AABBBatch::transform(batch, m, out);
+        //in place as well
+        AABBBatch::transform(batch, m, batch);
+
+        for (unsigned i = 0; i < boxes.size(); ++i) {
+
+            AABB expected = AABB::transform(boxes[i], m);
+            AABB results[2] = {out[i], batch[i]};
+            for (unsigned r = 0; r < 2; ++r) {
+
+                UTIL_CHECK(results[r].isEmpty() == expected.isEmpty());
+                for (unsigned c = 0; c < 3; ++c) {
+
+                    UTIL_CHECK(util::test::near(
+                        results[r].getMin().data()[c],
+                        expected.getMin().data()[c], 1e-5));
+                    UTIL_CHECK(util::test::near(
+                        results[r].getMax().data()[c],
+                        expected.getMax().data()[c], 1e-5));
+                }
+            }
+        }
+    }
+
+    return util::test::result();
+}
@@ -0,0 +1,135 @@
+/**************************************************\
+| Checks that the hot vector functions never touch |
+| the heap.                                        |
+|                                                  |
+| @author David Saxon                              |
+\**************************************************/
+
+#include <cstdlib>
+#include <new>
+
+#include "../vector/Vector2.hpp"
+#include "../vector/Vector3.hpp"
+#include "../vector/Vector4.hpp"
+#include "Check.hpp"
+
+using util::vec::Vector2;
+using util::vec::Vector3;
+using util::vec::Vector4;
+
+namespace {
+
+/*!The number of times operator new has been called*/
+unsigned allocations = 0;
+
+} //anonymous
+
+//every allocation in the program goes through these so they can be counted
+void* operator new(std::size_t _size) {
+
+    ++allocations;
+    void* memory = std::malloc(_size == 0 ? 1 : _size);
+    if (memory == NULL) {
+
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](std::size_t _size) {
+
+    return operator new(_size);
+}
+
+#if __cplusplus >= 201103L
+#   define UTIL_TEST_NOTHROW noexcept
+#else
+#   define UTIL_TEST_NOTHROW throw()
+#endif
+
+void operator delete(void* _memory) UTIL_TEST_NOTHROW {
+
+    std::free(_memory);
+}
+
+void operator delete[](void* _memory) UTIL_TEST_NOTHROW {
+
+    std::free(_memory);
+}
+
+#if __cplusplus >= 201402L
+
+void operator delete(void* _memory, std::size_t) noexcept {
+
+    std::free(_memory);
+}
+
+void operator delete[](void* _memory, std::size_t) noexcept {
+
+    std::free(_memory);
+}
+#endif
+
+namespace {
+
+/*!Runs the functions of a vector type that are meant to be usable in tight
+loops
+@_a the first vector to use
+@_b the second vector to use, must not be zero
+@_array must have room for the vector's values
+@return a sum of the results so the work is not optimised away*/
+template<typename VectorType>
+float hotPath(const VectorType& _a, const VectorType& _b, float* _array) {
+
+    VectorType v = -_a;
+    v += _b;
+    v -= 1.0f;
+    v *= _b;
+    v /= 2.0f;
+    v = (v + _a) - (_b * 2.0f) + (_a / _b);
+    v.inverse();
+    v.normalise();
+
+    _a.toArray(_array);
+    float sum = _array[0] + v.data()[0] + _a.data()[1];
+    sum += v.magnitude() + v.squaredMagnitude() + v.dotProduct(_b);
+    sum += v.distance(_b) + v.squaredDistance(_b);
+    sum += v[0] + v[1];
+    return sum;
+}
+
+} //anonymous
+
+int main() {
+
+    Vector2 a2(1.0f, 2.0f);
+    Vector2 b2(3.0f, -4.0f);
+    Vector3 a3(1.0f, 2.0f, 3.0f);
+    Vector3 b3(3.0f, -4.0f, 5.0f);
+    Vector4 a4(1.0f, 2.0f, 3.0f, 4.0f);
+    Vector4 b4(3.0f, -4.0f, 5.0f, -6.0f);
+    float array[4];
+
+    //make sure the counter sees the old allocating functions
+    unsigned before = allocations;
+    float* allocated = a3.toArray();
+    Vector3* inverse = a3.getInverse();
+    UTIL_CHECK(allocations == before + 2);
+    delete[] allocated;
+    delete inverse;
+
+    before = allocations;
+    float sum = 0.0f;
+    for (unsigned i = 0; i < 1000; ++i) {
+
+        sum += hotPath(a2, b2, array);
+        sum += hotPath(a3, b3, array);
+        sum += hotPath(a4, b4, array);
+        sum += a3.crossProduct(b3).getZ();
+        sum += a2.angleBetween(b2) + a3.angleBetween(b3);
+    }
+    UTIL_CHECK(allocations == before);
+    UTIL_CHECK(sum == sum);
+
+    return util::test::result();
+}
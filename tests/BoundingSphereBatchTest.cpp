@@ -0,0 +1,88 @@
+/**************************************************\
+| Tests for the batched bounding sphere transform. |
+|                                                  |
+| @author David Saxon                              |
+\**************************************************/
+
+#include <cstdlib>
+#include <vector>
+
+#include "../spatial/BoundingSphereBatch.hpp"
+#include "Check.hpp"
+
+using util::spatial::BoundingSphere;
+using util::spatial::BoundingSphereBatch;
+using util::vec::Vector3;
+
+static float random(float _range) {
+
+    return ((std::rand() / static_cast<float>(RAND_MAX)) * 2.0f - 1.0f) *
+        _range;
+}
+
+int main() {
+
+    std::srand(18);
+
+    //default spheres are empty, they are spread through the batch so some
+    //fall in SIMD groups and some in the scalar tail
+    std::vector<BoundingSphere> spheres;
+    for (unsigned i = 0; i < 23; ++i) {
+
+        if (i % 3 == 0 || i < 4 || i == 22) {
+
+            spheres.push_back(BoundingSphere());
+            continue;
+        }
+        spheres.push_back(BoundingSphere(
+            Vector3(random(10.0f), random(10.0f), random(10.0f)),
+            random(5.0f) + 5.0f));
+    }
+    //a zero scale turns an empty sphere's radius into -0, which is not
+    //empty, so it shows whether empty spheres are passed through
+    util::mat::Matrix4 matrices[2] = {
+        util::mat::Matrix4::translation(Vector3(1.0f, -2.0f, 3.0f)) *
+            util::mat::Matrix4::rotationXYZ(Vector3(30.0f, 45.0f, 60.0f)) *
+            util::mat::Matrix4::scale(Vector3(2.0f, 1.0f, 0.5f)),
+        util::mat::Matrix4::scale(Vector3(0.0f, 0.0f, 0.0f))
+    };
+
+    for (int level = 0; level <= util::test::maxLevel(); ++level) {
+
+        util::simd::setLevel(static_cast<util::simd::cpu::Level>(level));
+
+        for (unsigned k = 0; k < 2; ++k) {
+
+            const util::mat::Matrix4& m = matrices[k];
+
+            BoundingSphereBatch batch(&spheres[0],
+                static_cast<unsigned>(spheres.size()));
+            BoundingSphereBatch out;
+            BoundingSphereBatch::transform(batch, m, out);
+            //in place as well
+            BoundingSphereBatch::transform(batch, m, batch);
+
+            for (unsigned i = 0; i < spheres.size(); ++i) {
+
+                BoundingSphere expected =
+                    BoundingSphere::transform(spheres[i], m);
+                BoundingSphere results[2] = {out[i], batch[i]};
+                for (unsigned r = 0; r < 2; ++r) {
+
+                    UTIL_CHECK(
+                        results[r].isEmpty() == expected.isEmpty());
+                    UTIL_CHECK(util::test::near(results[r].getRadius(),
+                        expected.getRadius(), 1e-5));
+                    for (unsigned c = 0; c < 3; ++c) {
+
+                        UTIL_CHECK(util::test::near(
+                            results[r].getCentre().data()[c],
+                            expected.getCentre().data()[c], 1e-5));
+                    }
+                }
+            }
+        }
+    }
+
+    return util::test::result();
+}
@@ -0,0 +1,76 @@
+/*************************************\
+| Minimal checks shared by the tests. |
+|                                     |
+| @author David Saxon                 |
+\*************************************/
+
+#ifndef UTILITIES_TESTS_CHECK_H_
+#   define UTILITIES_TESTS_CHECK_H_
+
+#include <cmath>
+#include <iostream>
+
+#include "../SimdUtil.hpp"
+
+namespace util { namespace test {
+
+//FUNCTIONS
+/*!@return the number of checks that have failed so far*/
+inline unsigned& failures() {
+
+    static unsigned count = 0;
+    return count;
+}
+
+/*!Records a check, printing where it failed
+@_condition whether the check passed
+@_what the text of the check
+@_file the file the check is in
+@_line the line the check is on*/
+inline void check(bool _condition, const char* _what, const char* _file,
+    int _line) {
+
+    if (!_condition) {
+
+        ++failures();
+        std::cerr << _file << ":" << _line << ": check failed: " << _what <<
+            " (level " << util::simd::level() << ")" << std::endl;
+    }
+}
+
+/*!@return whether the two values are within the tolerance of each other,
+relative to the larger of them once it is above one*/
+inline bool near(double _a, double _b, double _tolerance) {
+
+    double scale = std::fabs(_a) > std::fabs(_b) ? std::fabs(_a) :
+        std::fabs(_b);
+    return std::fabs(_a - _b) <= _tolerance * (scale > 1.0 ? scale : 1.0);
+}
+
+/*!@return the highest SIMD level the tests can force, see
+util::simd::setLevel()*/
+inline util::simd::cpu::Level maxLevel() {
+
+    return util::simd::detectLevel();
+}
+
+/*!Prints the outcome of the test
+@return the exit code for the test program*/
+inline int result() {
+
+    if (failures() != 0) {
+
+        std::cerr << failures() << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "passed" << std::endl;
+    return 0;
+}
+
+}} //util //test
+
+/*!Checks that the condition is true, the test keeps going if it is not*/
+#define UTIL_CHECK(_condition) \
+    util::test::check((_condition), #_condition, __FILE__, __LINE__)
+
+#endif
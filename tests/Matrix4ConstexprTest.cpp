@@ -0,0 +1,71 @@
+/************************************************\
+| Checks that Matrix4's factories are constexpr. |
+|                                                |
+| @author David Saxon                            |
+\************************************************/
+
+#include "../matrix/Matrix4.hpp"
+#include "Check.hpp"
+
+//before C++14 UTIL_CONSTEXPR is empty and there is nothing to check
+#if __cplusplus >= 201402L
+
+using util::mat::Matrix4;
+using util::vec::Vector3;
+using util::vec::Vector4;
+
+namespace {
+
+/*!@return whether the two vectors hold the same values, usable in constant
+expressions unlike Vector4::operator ==()*/
+constexpr bool equal(const Vector4& _a, const Vector4& _b) {
+
+    return _a.getX() == _b.getX() && _a.getY() == _b.getY() &&
+           _a.getZ() == _b.getZ() && _a.getW() == _b.getW();
+}
+
+/*!@return whether the two matrices hold the same values*/
+constexpr bool equal(const Matrix4& _a, const Matrix4& _b) {
+
+    return equal(_a[0], _b[0]) && equal(_a[1], _b[1]) &&
+           equal(_a[2], _b[2]) && equal(_a[3], _b[3]);
+}
+
+constexpr Matrix4 IDENTITY = Matrix4::identity();
+constexpr Matrix4 TRANSLATION = Matrix4::translation(Vector3(1.0f, 2.0f, 3.0f));
+constexpr Matrix4 SCALE = Matrix4::scale(Vector3(2.0f, 3.0f, 4.0f));
+
+static_assert(equal(Matrix4(), Matrix4(0.0f)), "zero matrix");
+static_assert(equal(IDENTITY, Matrix4(
+    Vector4(1.0f, 0.0f, 0.0f, 0.0f), Vector4(0.0f, 1.0f, 0.0f, 0.0f),
+    Vector4(0.0f, 0.0f, 1.0f, 0.0f), Vector4(0.0f, 0.0f, 0.0f, 1.0f))),
+    "identity");
+static_assert(equal(TRANSLATION[3], Vector4(1.0f, 2.0f, 3.0f, 1.0f)),
+    "translation column");
+static_assert(equal(TRANSLATION[0], Vector4::xVector()), "translation basis");
+static_assert(SCALE[0].getX() == 2.0f && SCALE[1].getY() == 3.0f &&
+    SCALE[2].getZ() == 4.0f && equal(SCALE[3], Vector4::wVector()), "scale");
+static_assert(equal(Matrix4::transpose(IDENTITY), IDENTITY),
+    "transpose of identity");
+static_assert(equal(Matrix4::transpose(TRANSLATION)[0],
+    Vector4(1.0f, 0.0f, 0.0f, 1.0f)), "transpose");
+static_assert(equal(Matrix4::transpose(Matrix4::transpose(TRANSLATION)),
+    TRANSLATION), "transpose twice");
+static_assert(equal(Matrix4::multiply(IDENTITY, TRANSLATION), TRANSLATION),
+    "multiply by identity");
+static_assert(equal(Matrix4::multiply(TRANSLATION, SCALE), Matrix4(
+    Vector4(2.0f, 0.0f, 0.0f, 0.0f), Vector4(0.0f, 3.0f, 0.0f, 0.0f),
+    Vector4(0.0f, 0.0f, 4.0f, 0.0f), Vector4(1.0f, 2.0f, 3.0f, 1.0f))),
+    "translation * scale");
+static_assert(equal(Matrix4::multiply(SCALE, TRANSLATION)[3],
+    Vector4(2.0f, 6.0f, 12.0f, 1.0f)), "scale * translation");
+
+} //anonymous
+
+#endif
+
+int main() {
+
+    //everything is checked at compile time
+    return util::test::result();
+}
@@ -0,0 +1,280 @@
+/*******************************************************\
+| Tests Matrix4's inverse and determinant paths against |
+| a double precision reference.                         |
+|                                                       |
+| @author David Saxon                                   |
+\*******************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "../matrix/Matrix4.hpp"
+#include "Check.hpp"
+
+using util::mat::Matrix4;
+using util::vec::Vector3;
+using util::vec::Vector4;
+namespace m4 = util::mat::m4;
+
+namespace {
+
+/*!A column major 4x4 matrix in double precision*/
+struct Reference {
+
+    double m[4][4];
+    double determinant;
+};
+
+/*!Inverses the matrix in double precision using Gauss-Jordan elimination
+with partial pivoting
+@_matrix the matrix to inverse
+@return the inverse and the determinant of the matrix*/
+Reference reference(const Matrix4& _matrix) {
+
+    double a[4][8];
+    for (unsigned row = 0; row < 4; ++row) {
+
+        for (unsigned col = 0; col < 4; ++col) {
+
+            a[row][col] = _matrix(col, row);
+            a[row][col + 4] = (row == col) ? 1.0 : 0.0;
+        }
+    }
+
+    Reference result;
+    result.determinant = 1.0;
+    for (unsigned col = 0; col < 4; ++col) {
+
+        unsigned pivot = col;
+        for (unsigned row = col + 1; row < 4; ++row) {
+
+            if (std::fabs(a[row][col]) > std::fabs(a[pivot][col])) {
+
+                pivot = row;
+            }
+        }
+        if (pivot != col) {
+
+            for (unsigned i = 0; i < 8; ++i) {
+
+                std::swap(a[pivot][i], a[col][i]);
+            }
+            result.determinant = -result.determinant;
+        }
+
+        double p = a[col][col];
+        result.determinant *= p;
+        for (unsigned i = 0; i < 8; ++i) {
+
+            a[col][i] /= p;
+        }
+        for (unsigned row = 0; row < 4; ++row) {
+
+            double factor = a[row][col];
+            if (row == col || factor == 0.0) {
+
+                continue;
+            }
+            for (unsigned i = 0; i < 8; ++i) {
+
+                a[row][i] -= factor * a[col][i];
+            }
+        }
+    }
+
+    for (unsigned row = 0; row < 4; ++row) {
+
+        for (unsigned col = 0; col < 4; ++col) {
+
+            result.m[col][row] = a[row][col + 4];
+        }
+    }
+    return result;
+}
+
+/*!@return the largest absolute value in the matrix*/
+double largest(const double _m[4][4]) {
+
+    double l = 0.0;
+    for (unsigned i = 0; i < 16; ++i) {
+
+        l = std::max(l, std::fabs(_m[i / 4][i % 4]));
+    }
+    return l;
+}
+
+/*!@return the condition number of the matrix in the max norm, which scales
+how far a float inverse can be from the exact one*/
+double condition(const Matrix4& _matrix, const Reference& _inverse) {
+
+    double m[4][4];
+    for (unsigned i = 0; i < 16; ++i) {
+
+        m[i / 4][i % 4] = _matrix(i / 4, i % 4);
+    }
+    return 16.0 * largest(m) * largest(_inverse.m);
+}
+
+/*!@return whether the inverse is within the tolerance of the reference,
+relative to the largest value of the reference*/
+bool matches(const Matrix4& _inverse, const Reference& _reference,
+    double _tolerance) {
+
+    double scale = largest(_reference.m);
+    for (unsigned i = 0; i < 16; ++i) {
+
+        double error = std::fabs(
+            _inverse(i / 4, i % 4) - _reference.m[i / 4][i % 4]);
+        if (!(error <= _tolerance * scale)) {
+
+            return false;
+        }
+    }
+    return true;
+}
+
+float random(float _range) {
+
+    return ((std::rand() / static_cast<float>(RAND_MAX)) * 2.0f - 1.0f) *
+        _range;
+}
+
+Vector4 randomVector(float _range) {
+
+    return Vector4(
+        random(_range), random(_range), random(_range), random(_range));
+}
+
+Matrix4 randomGeneral() {
+
+    return Matrix4(
+        randomVector(5.0f), randomVector(5.0f),
+        randomVector(5.0f), randomVector(5.0f));
+}
+
+/*!@return a matrix with one column that is almost a mix of the others*/
+Matrix4 randomNearSingular() {
+
+    Matrix4 m = randomGeneral();
+    float epsilon = (std::rand() % 2 == 0) ? 0.001f : 0.0001f;
+    m[std::rand() % 4] =
+        (m[(std::rand() % 3) == 0 ? 0 : 1] * random(2.0f)) +
+        (m[2] * random(2.0f)) + (randomVector(1.0f) * epsilon);
+    return m;
+}
+
+Matrix4 randomAffine() {
+
+    return Matrix4::translation(
+            Vector3(random(20.0f), random(20.0f), random(20.0f))) *
+        Matrix4::rotationXYZ(
+            Vector3(random(180.0f), random(180.0f), random(180.0f))) *
+        Matrix4::scale(Vector3(
+            random(3.0f) + 3.5f, random(3.0f) + 3.5f, random(3.0f) + 3.5f));
+}
+
+Matrix4 randomRigid() {
+
+    return Matrix4::translation(
+            Vector3(random(20.0f), random(20.0f), random(20.0f))) *
+        Matrix4::rotationX(random(180.0f)) *
+        Matrix4::rotationY(random(180.0f)) *
+        Matrix4::rotationZ(random(180.0f));
+}
+
+} //anonymous
+
+int main() {
+
+    std::srand(5);
+
+    //sizes that are not a multiple of four or eight so the batch tails run
+    std::vector<Matrix4> general;
+    std::vector<Matrix4> nearSingular;
+    std::vector<Matrix4> affine;
+    std::vector<Matrix4> rigid;
+    for (unsigned i = 0; i < 37; ++i) {
+
+        general.push_back(randomGeneral());
+        nearSingular.push_back(randomNearSingular());
+        affine.push_back(randomAffine());
+        rigid.push_back(randomRigid());
+    }
+    std::vector<Matrix4>* sets[] = {&general, &nearSingular, &affine, &rigid};
+    const char* names[] = {"general", "near singular", "affine", "rigid"};
+
+    for (int level = 0; level <= util::test::maxLevel(); ++level) {
+
+        util::simd::setLevel(static_cast<util::simd::cpu::Level>(level));
+
+        for (unsigned s = 0; s < 4; ++s) {
+
+            const std::vector<Matrix4>& in = *sets[s];
+            unsigned count = static_cast<unsigned>(in.size());
+
+            std::vector<Matrix4> classified(count);
+            std::vector<Matrix4> batch(count);
+            std::vector<float> determinants(count);
+            Matrix4::inverse(&in[0], &classified[0], count);
+            Matrix4::inverse(&in[0], &batch[0], count, m4::GENERAL);
+            Matrix4::determinant(&in[0], &determinants[0], count);
+
+            for (unsigned i = 0; i < count; ++i) {
+
+                Reference ref = reference(in[i]);
+                //float rounding of the inputs alone is magnified by the
+                //condition number
+                double tolerance = std::max(1e-5, condition(in[i], ref) * 1e-6);
+
+                bool ok =
+                    matches(Matrix4::inverse(in[i]), ref, tolerance) &&
+                    matches(classified[i], ref, tolerance) &&
+                    matches(batch[i], ref, tolerance) &&
+                    util::test::near(
+                        determinants[i], ref.determinant, tolerance) &&
+                    util::test::near(
+                        Matrix4::determinant(in[i]), ref.determinant,
+                        tolerance);
+                if (s >= 2) {
+
+                    ok = ok && matches(Matrix4::inverseAffine(in[i]), ref,
+                        tolerance);
+                }
+                if (s == 3) {
+
+                    ok = ok && matches(Matrix4::inverseRigid(in[i]), ref,
+                        tolerance);
+                }
+                if (!ok) {
+
+                    std::cerr << names[s] << " matrix " << i << std::endl;
+                }
+                UTIL_CHECK(ok);
+            }
+
+            //the affine and rigid sets can also be batched by their type
+            if (s >= 2) {
+
+                m4::Type type = (s == 2) ? m4::AFFINE : m4::RIGID;
+                Matrix4::inverse(&in[0], &batch[0], count, type);
+                for (unsigned i = 0; i < count; ++i) {
+
+                    UTIL_CHECK(Matrix4::classify(in[i]) == type);
+                    UTIL_CHECK(matches(batch[i], reference(in[i]), 1e-5));
+                }
+            }
+
+            //inversing in place gives the same result
+            std::vector<Matrix4> inPlace(in);
+            Matrix4::inverse(&inPlace[0], &inPlace[0], count, m4::GENERAL);
+            for (unsigned i = 0; i < count; ++i) {
+
+                UTIL_CHECK(matches(inPlace[i], reference(in[i]),
+                    std::max(1e-5, condition(in[i], reference(in[i])) * 1e-6)));
+            }
+        }
+    }
+
+    return util::test::result();
+}
@@ -0,0 +1,157 @@
+/*********************************************\
+| Tests for the batched ray triangle kernels. |
+|                                             |
+| @author David Saxon                         |
+\*********************************************/
+
+#include <cstdlib>
+#include <vector>
+
+#include "../spatial/RayBatch.hpp"
+#include "Check.hpp"
+
+using util::spatial::Ray;
+using util::spatial::RayBatch;
+using util::spatial::RayHit;
+using util::spatial::TriangleBatch;
+using util::vec::Vector3;
+
+namespace {
+
+float randomValue(float _range) {
+
+    return ((std::rand() / static_cast<float>(RAND_MAX)) * 2.0f - 1.0f) *
+        _range;
+}
+
+Vector3 randomVector(float _range) {
+
+    return Vector3(randomValue(_range), randomValue(_range),
+        randomValue(_range));
+}
+
+//intersects the ray with every triangle one at a time
+bool reference(const Ray& _ray, const std::vector<Vector3>& _vertices,
+    RayHit& _hit) {
+
+    bool replaced = false;
+    for (unsigned j = 0; j < _vertices.size() / 3; ++j) {
+
+        if (_ray.intersects(_vertices[j * 3], _vertices[(j * 3) + 1],
+            _vertices[(j * 3) + 2], _hit)) {
+
+            _hit.index = j;
+            replaced = true;
+        }
+    }
+    return replaced;
+}
+
+bool same(const RayHit& _a, const RayHit& _b) {
+
+    return _a.index == _b.index && util::test::near(_a.t, _b.t, 1e-4) &&
+        util::test::near(_a.u, _b.u, 1e-3) &&
+        util::test::near(_a.v, _b.v, 1e-3);
+}
+
+//a mesh with one large triangle at the given depth in front of the rays
+//first and the rest off to the side, 13 triangles use the 8 wide, 4 wide
+//and scalar loops
+TriangleBatch wall(float _z) {
+
+    std::vector<Vector3> vertices;
+    vertices.push_back(Vector3(-10.0f, -10.0f, _z));
+    vertices.push_back(Vector3( 10.0f, -10.0f, _z));
+    vertices.push_back(Vector3(  0.0f,  10.0f, _z));
+    for (unsigned j = 1; j < 13; ++j) {
+
+        vertices.push_back(Vector3(100.0f + j, 0.0f, _z));
+        vertices.push_back(Vector3(101.0f + j, 0.0f, _z));
+        vertices.push_back(Vector3(100.0f + j, 1.0f, _z));
+    }
+    return TriangleBatch(&vertices[0], 13);
+}
+
+} //anonymous
+
+int main() {
+
+    std::srand(19);
+
+    //78 rays are a block of 64 and a block of 14, which uses the 8 wide, 4
+    //wide and scalar loops
+    std::vector<Ray> rays;
+    for (unsigned i = 0; i < 78; ++i) {
+
+        Vector3 origin = randomVector(1.0f);
+        Vector3 direction = randomVector(1.0f) + Vector3(0.0f, 0.0f, 2.0f);
+        direction.normalise();
+        rays.push_back(Ray(origin, direction));
+    }
+    std::vector<Vector3> vertices;
+    for (unsigned j = 0; j < 29; ++j) {
+
+        Vector3 centre = randomVector(3.0f) + Vector3(0.0f, 0.0f, 6.0f);
+        for (unsigned c = 0; c < 3; ++c) {
+
+            vertices.push_back(centre + randomVector(2.0f));
+        }
+    }
+    TriangleBatch triangles(&vertices[0], 29);
+
+    TriangleBatch farWall = wall(5.0f);
+    TriangleBatch nearWall = wall(2.0f);
+    std::vector<Ray> forward;
+    for (unsigned i = 0; i < rays.size(); ++i) {
+
+        forward.push_back(Ray(randomVector(1.0f) * Vector3(1.0f, 1.0f, 0.0f),
+            Vector3(0.0f, 0.0f, 1.0f)));
+    }
+
+    for (int level = 0; level <= util::test::maxLevel(); ++level) {
+
+        util::simd::setLevel(static_cast<util::simd::cpu::Level>(level));
+
+        RayBatch batch(&rays[0], static_cast<unsigned>(rays.size()));
+        std::vector<RayHit> hits(rays.size(), RayHit(8.0f));
+        unsigned replaced = batch.intersect(triangles, &hits[0]);
+
+        unsigned expectedReplaced = 0;
+        for (unsigned i = 0; i < rays.size(); ++i) {
+
+            RayHit expected(8.0f);
+            bool hit = reference(rays[i], vertices, expected);
+            expectedReplaced += hit;
+            UTIL_CHECK(same(hits[i], expected));
+
+            RayHit single(8.0f);
+            UTIL_CHECK(triangles.intersect(rays[i], single) == hit);
+            UTIL_CHECK(same(single, expected));
+            UTIL_CHECK(triangles.occluded(rays[i], 8.0f) == hit);
+        }
+        UTIL_CHECK(replaced == expectedReplaced);
+
+        //a hit already on triangle 0 of another mesh is still replaced by
+        //a nearer hit on triangle 0
+        RayBatch forwardBatch(&forward[0],
+            static_cast<unsigned>(forward.size()));
+        std::vector<RayHit> wallHits(forward.size());
+        UTIL_CHECK(forwardBatch.intersect(farWall, &wallHits[0]) ==
+            forward.size());
+        UTIL_CHECK(forwardBatch.intersect(nearWall, &wallHits[0]) ==
+            forward.size());
+        for (unsigned i = 0; i < forward.size(); ++i) {
+
+            UTIL_CHECK(wallHits[i].index == 0);
+            UTIL_CHECK(util::test::near(wallHits[i].t, 2.0f, 1e-5));
+
+            RayHit hit;
+            UTIL_CHECK(farWall.intersect(forward[i], hit));
+            UTIL_CHECK(hit.index == 0);
+            UTIL_CHECK(nearWall.intersect(forward[i], hit));
+            UTIL_CHECK(util::test::near(hit.t, 2.0f, 1e-5));
+        }
+    }
+
+    return util::test::result();
+}
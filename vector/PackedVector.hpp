@@ -0,0 +1,495 @@
+/**************************************\
+| Compact storage formats for vectors. |
+|                                      |
+| @author David Saxon                  |
+\**************************************/
+
+#ifndef UTILTIES_VECTOR_PACKEDVECTOR_H_
+#   define UTILTIES_VECTOR_PACKEDVECTOR_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+
+#include "../SimdUtil.hpp"
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+
+namespace util { namespace vec {
+
+/*~A 3D vector of half precision floats, 6 bytes*/
+struct Half3 {
+
+    //VARIABLES
+    //!the x, y and z values as IEEE 754 half precision bits
+    uint16_t v[3];
+};
+
+/*~A 4D vector of half precision floats, 8 bytes*/
+struct Half4 {
+
+    //VARIABLES
+    //!the x, y, z and w values as IEEE 754 half precision bits
+    uint16_t v[4];
+};
+
+//the conversions treat arrays of these as unbroken arrays of halves
+typedef char Half3IsPacked[(sizeof(Half3) == (3 * sizeof(uint16_t))) ? 1 : -1];
+typedef char Half4IsPacked[(sizeof(Half4) == (4 * sizeof(uint16_t))) ? 1 : -1];
+
+/**********************************************************************\
+| Converts vectors to and from compact formats. Half precision uses    |
+| the F16C instructions when they are available and otherwise a        |
+| software conversion that gives the same bits, rounding to the        |
+| nearest even value. Unit length normals can also be stored in 32     |
+| bits as two 16 bit octahedral coordinates, or as three signed 10 bit |
+| values and a 2 bit w value.                                          |
+|                                                                      |
+| @author David Saxon                                                  |
+\**********************************************************************/
+class PackedVector {
+public:
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!@return the half precision bits of the float*/
+    static uint16_t toHalf(float _value);
+
+    /*!@return the float of the half precision bits, every half is exactly
+    representable*/
+    static float fromHalf(uint16_t _half);
+
+    /*!Converts an array of floats to half precision
+    @_in the floats
+    @_out receives the half precision bits
+    @_count the number of floats*/
+    static void toHalf(const float* _in, uint16_t* _out, unsigned _count);
+
+    /*!Converts an array of half precision values to floats
+    @_in the half precision bits
+    @_out receives the floats
+    @_count the number of values*/
+    static void fromHalf(const uint16_t* _in, float* _out, unsigned _count);
+
+    /*!Converts an array of 3D vectors to half precision
+    @_in the vectors
+    @_out receives the half precision vectors
+    @_count the number of vectors*/
+    static void toHalf(const Vector3* _in, Half3* _out, unsigned _count);
+
+    /*!Converts an array of half precision 3D vectors to floats
+    @_in the half precision vectors
+    @_out receives the vectors
+    @_count the number of vectors*/
+    static void fromHalf(const Half3* _in, Vector3* _out, unsigned _count);
+
+    /*!Converts an array of 4D vectors to half precision
+    @_in the vectors
+    @_out receives the half precision vectors
+    @_count the number of vectors*/
+    static void toHalf(const Vector4* _in, Half4* _out, unsigned _count);
+
+    /*!Converts an array of half precision 4D vectors to floats
+    @_in the half precision vectors
+    @_out receives the vectors
+    @_count the number of vectors*/
+    static void fromHalf(const Half4* _in, Vector4* _out, unsigned _count);
+
+    /*!Packs a unit length vector by folding the octahedron it is projected
+    onto flat, x is in the low 16 bits and y in the high 16 bits
+    #NOTE: vectors come back within 0.0001 of their direction
+    @_normal the unit length vector to pack
+    @return the packed vector*/
+    static uint32_t toOctahedral(const Vector3& _normal);
+
+    /*!@return the unit length vector of the octahedral bits*/
+    static Vector3 fromOctahedral(uint32_t _packed);
+
+    /*!Packs an array of unit length vectors, see toOctahedral()
+    @_in the vectors
+    @_out receives the packed vectors
+    @_count the number of vectors*/
+    static void toOctahedral(const Vector3* _in, uint32_t* _out,
+        unsigned _count);
+
+    /*!Unpacks an array of octahedral vectors
+    @_in the packed vectors
+    @_out receives the unit length vectors
+    @_count the number of vectors*/
+    static void fromOctahedral(const uint32_t* _in, Vector3* _out,
+        unsigned _count);
+
+    /*!Packs a vector with elements between -1 and 1 into signed normalised
+    10 bit x, y and z values and a signed 2 bit w value, x is in the low bits
+    #NOTE: elements come back within 0.001
+    @_normal the vector to pack, elements are clamped to -1 and 1
+    @_w the w value between -1 and 1, often the handedness of a tangent
+    @return the packed vector*/
+    static uint32_t to1010102(const Vector3& _normal, int _w = 0);
+
+    /*!Unpacks a 10:10:10:2 vector
+    @_packed the packed vector
+    @_w receives the w value if not NULL
+    @return the vector*/
+    static Vector3 from1010102(uint32_t _packed, int* _w = NULL);
+
+    /*!Packs an array of vectors with a w value of 0, see to1010102()
+    @_in the vectors
+    @_out receives the packed vectors
+    @_count the number of vectors*/
+    static void to1010102(const Vector3* _in, uint32_t* _out,
+        unsigned _count);
+
+    /*!Unpacks an array of 10:10:10:2 vectors, the w values are dropped
+    @_in the packed vectors
+    @_out receives the vectors
+    @_count the number of vectors*/
+    static void from1010102(const uint32_t* _in, Vector3* _out,
+        unsigned _count);
+
+private:
+
+    //PRIVATE MEMBER FUNCTIONS
+    /*!@return the value multiplied by the scale and rounded to the nearest
+    integer after being clamped to -1 and 1*/
+    static int32_t toSnorm(float _value, float _scale);
+
+    /*!@return 1 for values of 0 or more and -1 otherwise*/
+    static float signNotZero(float _value);
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+    /*!Converts as many floats to half precision as fit in groups of eight,
+    see toHalf()
+    @return the number of floats done, the rest are left to the caller*/
+    UTIL_SIMD_TARGET("avx2,fma,f16c")
+    static unsigned toHalfF16c(const float* _in, uint16_t* _out,
+        unsigned _count);
+
+    /*!Converts as many half precision values to floats as fit in groups of
+    eight, see fromHalf()
+    @return the number of values done, the rest are left to the caller*/
+    UTIL_SIMD_TARGET("avx2,fma,f16c")
+    static unsigned fromHalfF16c(const uint16_t* _in, float* _out,
+        unsigned _count);
+#endif
+};
+
+//INLINE
+//PUBLIC MEMBER FUNCTIONS
+inline uint16_t PackedVector::toHalf(float _value) {
+
+    uint32_t f = 0;
+    std::memcpy(&f, &_value, sizeof(f));
+
+    uint16_t sign = static_cast<uint16_t>((f >> 16) & 0x8000);
+    f &= 0x7FFFFFFF;
+
+    //infinity stays infinity and nans keep the top of their payload but
+    //are always made quiet, as F16C does
+    if (f >= 0x7F800000) {
+
+        uint16_t nan = f > 0x7F800000 ?
+            static_cast<uint16_t>(0x0200 | ((f >> 13) & 0x03FF)) : 0;
+        return sign | 0x7C00 | nan;
+    }
+    //65520 and above round up past the largest half
+    if (f >= 0x477FF000) {
+
+        return sign | 0x7C00;
+    }
+    //normal halves, the exponent is rebiased and the 13 dropped mantissa
+    //bits are rounded to even
+    if (f >= 0x38800000) {
+
+        f += 0xC8000FFF + ((f >> 13) & 1);
+        return sign | static_cast<uint16_t>(f >> 13);
+    }
+    //half of the smallest subnormal and below round to zero
+    if (f <= 0x33000000) {
+
+        return sign;
+    }
+
+    //subnormal halves are the mantissa with its implicit bit shifted down
+    //to units of 2^-24
+    uint32_t mantissa = (f & 0x007FFFFF) | 0x00800000;
+    uint32_t shift = 126 - (f >> 23);
+    uint32_t bits = mantissa >> shift;
+    uint32_t rest = mantissa & ((1u << shift) - 1);
+    uint32_t halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (bits & 1) != 0)) {
+
+        ++bits;
+    }
+
+    return sign | static_cast<uint16_t>(bits);
+}
+
+inline float PackedVector::fromHalf(uint16_t _half) {
+
+    uint32_t sign = static_cast<uint32_t>(_half & 0x8000) << 16;
+    uint32_t exponent = (_half >> 10) & 0x1F;
+    uint32_t mantissa = _half & 0x03FF;
+
+    uint32_t f = 0;
+    if (exponent == 0x1F) {
+
+        //nans are made quiet, as F16C does
+        uint32_t quiet = mantissa != 0 ? 0x00400000 : 0;
+        f = sign | 0x7F800000 | quiet | (mantissa << 13);
+    }
+    else if (exponent != 0) {
+
+        f = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else if (mantissa != 0) {
+
+        //subnormal halves are normal floats once the mantissa is shifted
+        //up to its implicit bit
+        exponent = 113;
+        do {
+
+            mantissa <<= 1;
+            --exponent;
+        } while ((mantissa & 0x0400) == 0);
+        f = sign | (exponent << 23) | ((mantissa & 0x03FF) << 13);
+    }
+    else {
+
+        f = sign;
+    }
+
+    float value = 0.0f;
+    std::memcpy(&value, &f, sizeof(value));
+    return value;
+}
+
+inline void PackedVector::toHalf(const float* _in, uint16_t* _out,
+    unsigned _count) {
+
+    unsigned i = 0;
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (util::simd::hasF16c()) {
+
+        i = toHalfF16c(_in, _out, _count);
+    }
+#endif
+    for (; i < _count; ++i) {
+
+        _out[i] = toHalf(_in[i]);
+    }
+}
+
+inline void PackedVector::fromHalf(const uint16_t* _in, float* _out,
+    unsigned _count) {
+
+    unsigned i = 0;
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (util::simd::hasF16c()) {
+
+        i = fromHalfF16c(_in, _out, _count);
+    }
+#endif
+    for (; i < _count; ++i) {
+
+        _out[i] = fromHalf(_in[i]);
+    }
+}
+
+inline void PackedVector::toHalf(const Vector3* _in, Half3* _out,
+    unsigned _count) {
+
+    if (_count > 0) {
+
+        toHalf(_in[0].data(), _out[0].v, _count * 3);
+    }
+}
+
+inline void PackedVector::fromHalf(const Half3* _in, Vector3* _out,
+    unsigned _count) {
+
+    if (_count > 0) {
+
+        fromHalf(_in[0].v, _out[0].data(), _count * 3);
+    }
+}
+
+inline void PackedVector::toHalf(const Vector4* _in, Half4* _out,
+    unsigned _count) {
+
+    if (_count > 0) {
+
+        toHalf(_in[0].data(), _out[0].v, _count * 4);
+    }
+}
+
+inline void PackedVector::fromHalf(const Half4* _in, Vector4* _out,
+    unsigned _count) {
+
+    if (_count > 0) {
+
+        fromHalf(_in[0].v, _out[0].data(), _count * 4);
+    }
+}
+
+inline uint32_t PackedVector::toOctahedral(const Vector3& _normal) {
+
+    float x = _normal.getX();
+    float y = _normal.getY();
+    float z = _normal.getZ();
+
+    //project onto the octahedron then fold the lower half over the upper
+    float l1 = (std::fabs(x) + std::fabs(y)) + std::fabs(z);
+    float u = x / l1;
+    float v = y / l1;
+    if (z < 0.0f) {
+
+        float foldedU = (1.0f - std::fabs(v)) * signNotZero(u);
+        v = (1.0f - std::fabs(u)) * signNotZero(v);
+        u = foldedU;
+    }
+
+    uint32_t bitsU = static_cast<uint32_t>(toSnorm(u, 32767.0f)) & 0xFFFF;
+    uint32_t bitsV = static_cast<uint32_t>(toSnorm(v, 32767.0f)) & 0xFFFF;
+    return bitsU | (bitsV << 16);
+}
+
+inline Vector3 PackedVector::fromOctahedral(uint32_t _packed) {
+
+    float u = static_cast<float>(static_cast<int16_t>(_packed & 0xFFFF)) /
+        32767.0f;
+    float v = static_cast<float>(static_cast<int16_t>(_packed >> 16)) /
+        32767.0f;
+    u = u < -1.0f ? -1.0f : u;
+    v = v < -1.0f ? -1.0f : v;
+
+    float z = (1.0f - std::fabs(u)) - std::fabs(v);
+    if (z < 0.0f) {
+
+        float unfoldedU = (1.0f - std::fabs(v)) * signNotZero(u);
+        v = (1.0f - std::fabs(u)) * signNotZero(v);
+        u = unfoldedU;
+    }
+
+    float inverseLength = 1.0f / std::sqrt((u * u) + (v * v) + (z * z));
+    return Vector3(u * inverseLength, v * inverseLength, z * inverseLength);
+}
+
+inline void PackedVector::toOctahedral(const Vector3* _in, uint32_t* _out,
+    unsigned _count) {
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        _out[i] = toOctahedral(_in[i]);
+    }
+}
+
+inline void PackedVector::fromOctahedral(const uint32_t* _in, Vector3* _out,
+    unsigned _count) {
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        _out[i] = fromOctahedral(_in[i]);
+    }
+}
+
+inline uint32_t PackedVector::to1010102(const Vector3& _normal, int _w) {
+
+    uint32_t x = static_cast<uint32_t>(toSnorm(_normal.getX(), 511.0f));
+    uint32_t y = static_cast<uint32_t>(toSnorm(_normal.getY(), 511.0f));
+    uint32_t z = static_cast<uint32_t>(toSnorm(_normal.getZ(), 511.0f));
+    int clampedW = _w < -1 ? -1 : (_w > 1 ? 1 : _w);
+    uint32_t w = static_cast<uint32_t>(clampedW);
+
+    return (x & 0x3FF) | ((z & 0x3FF) << 20) | ((y & 0x3FF) << 10) |
+        ((w & 0x3) << 30);
+}
+
+inline Vector3 PackedVector::from1010102(uint32_t _packed, int* _w) {
+
+    //shifting each field to the top then back down sign extends it
+    int32_t x = static_cast<int32_t>(_packed << 22) >> 22;
+    int32_t y = static_cast<int32_t>(_packed << 12) >> 22;
+    int32_t z = static_cast<int32_t>(_packed << 2) >> 22;
+    if (_w != NULL) {
+
+        *_w = static_cast<int32_t>(_packed) >> 30;
+    }
+
+    //-512 is the one value past -1, it is clamped as with graphics apis
+    float fx = static_cast<float>(x < -511 ? -511 : x) / 511.0f;
+    float fy = static_cast<float>(y < -511 ? -511 : y) / 511.0f;
+    float fz = static_cast<float>(z < -511 ? -511 : z) / 511.0f;
+    return Vector3(fx, fy, fz);
+}
+
+inline void PackedVector::to1010102(const Vector3* _in, uint32_t* _out,
+    unsigned _count) {
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        _out[i] = to1010102(_in[i]);
+    }
+}
+
+inline void PackedVector::from1010102(const uint32_t* _in, Vector3* _out,
+    unsigned _count) {
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        _out[i] = from1010102(_in[i]);
+    }
+}
+
+//PRIVATE MEMBER FUNCTIONS
+inline int32_t PackedVector::toSnorm(float _value, float _scale) {
+
+    float clamped = _value < -1.0f ? -1.0f : (_value > 1.0f ? 1.0f : _value);
+    float scaled = clamped * _scale;
+
+    return static_cast<int32_t>(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+}
+
+inline float PackedVector::signNotZero(float _value) {
+
+    return _value < 0.0f ? -1.0f : 1.0f;
+}
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+UTIL_SIMD_TARGET("avx2,fma,f16c")
+inline unsigned PackedVector::toHalfF16c(const float* _in, uint16_t* _out,
+    unsigned _count) {
+
+    unsigned i = 0;
+    for (; i + 8 <= _count; i += 8) {
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(_out + i),
+            _mm256_cvtps_ph(_mm256_loadu_ps(_in + i),
+            _MM_FROUND_TO_NEAREST_INT));
+    }
+
+    return i;
+}
+
+UTIL_SIMD_TARGET("avx2,fma,f16c")
+inline unsigned PackedVector::fromHalfF16c(const uint16_t* _in, float* _out,
+    unsigned _count) {
+
+    unsigned i = 0;
+    for (; i + 8 <= _count; i += 8) {
+
+        _mm256_storeu_ps(_out + i, _mm256_cvtph_ps(_mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(_in + i))));
+    }
+
+    return i;
+}
+#endif
+
+} } //util //vec
+
+#endif
@@ -0,0 +1,38 @@
+/*********************************************\
+| Precision policies for vector square roots. |
+|                                             |
+| @author David Saxon                         |
+\*********************************************/
+
+#ifndef UTILTIES_VECTOR_PRECISION_H_
+#   define UTILTIES_VECTOR_PRECISION_H_
+
+namespace util { namespace vec {
+
+//The vectors' magnitude() and normalise() take one of these policies to choose
+//how the square root is computed, either at the call site:
+//
+//    v.normalise(util::vec::APPROXIMATE);
+//
+//or from a template parameter in generic code:
+//
+//    v.normalise(Precision());
+
+//STRUCTURES
+/*~Computes square roots exactly, the default*/
+struct Exact {
+};
+
+/*~Computes square roots from the hardware reciprocal square root estimate
+refined by one Newton-Raphson step, the relative error is below 0.000001 and
+the division and square root are skipped*/
+struct Approximate {
+};
+
+//VARIABLES
+const Exact EXACT = Exact();
+const Approximate APPROXIMATE = Approximate();
+
+} } //util //vec
+
+#endif
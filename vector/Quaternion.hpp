@@ -0,0 +1,509 @@
+/***************************\
+| Quaternion for rotations. |
+|                           |
+| @author David Saxon       |
+\***************************/
+
+#ifndef UTILTIES_VECTOR_QUATERNION_H_
+#   define UTILTIES_VECTOR_QUATERNION_H_
+
+#include <iostream>
+#include <cmath>
+#include <sstream>
+
+#include "../SimdUtil.hpp"
+#include "../ValuesUtil.hpp"
+#include "../exceptions/ArrayException.hpp"
+#include "Vector3.hpp"
+
+namespace util { namespace vec {
+
+class Quaternion {
+
+    //FRIEND FUNCTIONS
+    /*!Prints the quaternion to the output stream
+    @_output the output stream to print to
+    @_q the quaternion to print
+    @return the changed output stream*/
+    friend std::ostream& operator <<(std::ostream& _output,
+        const Quaternion& _q);
+
+public:
+
+    //CONSTRUCTORS
+    /*!Creates a new identity quaternion*/
+    Quaternion() {
+
+        util::simd::store(v, util::simd::set(0.0f, 0.0f, 0.0f, 1.0f));
+    }
+
+    /*!Creates a new quaternion
+    @_x the x value of the imaginary part
+    @_y the y value of the imaginary part
+    @_z the z value of the imaginary part
+    @_w the real part*/
+    Quaternion(float _x, float _y, float _z, float _w) {
+
+        v[0] = _x;
+        v[1] = _y;
+        v[2] = _z;
+        v[3] = _w;
+    }
+
+    /*!Creates a quaternion from the four values of a SIMD register
+    @_simd the register holding the x, y, z and w values*/
+    explicit Quaternion(util::simd::Float4 _simd) {
+
+        util::simd::store(v, _simd);
+    }
+
+    /*!Creates a quaternion by copying the other quaternion
+    @_other the other quaternion to copy from*/
+    Quaternion(const Quaternion& _other) {
+
+        util::simd::store(v, util::simd::load(_other.v));
+    }
+
+    //OPERATORS
+    /*!Copies the other quaternion's values to this quaternion
+    @_other the other quaternion to copy from*/
+    Quaternion& operator =(const Quaternion& _other);
+
+    /*!Checks if this quaternion and the other quaternion are equal
+    @_other the other quaternion to compare with
+    @return whether the quaternions are equal*/
+    bool operator ==(const Quaternion& _other) const;
+
+    /*!Checks if this quaternion and the other quaternion are not equal
+    @_other the other quaternion to compare with
+    @return whether the quaternions are not equal*/
+    bool operator !=(const Quaternion& _other) const;
+
+    /*!Gets the value at the specified index
+    @_index the index
+    @return the value*/
+    float& operator [](unsigned _index);
+
+    /*!Gets the value at the specified index
+    @_index the index
+    @return the value*/
+    const float& operator [](unsigned _index) const;
+
+    /*!@return the quaternion with all elements negated, this represents the
+    same rotation*/
+    Quaternion operator -() const;
+
+    /*!Creates the product of this and the other quaternion, the resulting
+    rotation applies the other quaternion first and then this one
+    @_other the other quaternion to multiply with
+    @return the result of the multiplication*/
+    Quaternion operator *(const Quaternion& _other) const;
+
+    /*!Multiplies this quaternion by the other quaternion
+    @_other the other quaternion to multiply by*/
+    void operator *=(const Quaternion& _other);
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!@return the identity quaternion*/
+    static Quaternion identity();
+
+    /*!Creates a quaternion to rotate around a unit-length vector
+    @_degrees the degrees to rotate
+    @_unitVec the vector to rotate around
+    @return the rotation quaternion*/
+    static Quaternion rotation(float _degrees, const Vector3& _unitVec);
+
+    /*!Linearly interpolates between the two quaternions along the shortest
+    path and normalises the result
+    @_a the quaternion at 0
+    @_b the quaternion at 1
+    @_t the position to interpolate to between 0 and 1
+    @return the interpolated quaternion*/
+    static Quaternion nlerp(const Quaternion& _a, const Quaternion& _b,
+        float _t);
+
+    /*!Spherically interpolates between the two quaternions along the
+    shortest path
+    @_a the quaternion at 0
+    @_b the quaternion at 1
+    @_t the position to interpolate to between 0 and 1
+    @return the interpolated quaternion*/
+    static Quaternion slerp(const Quaternion& _a, const Quaternion& _b,
+        float _t);
+
+    /*!Spherically interpolates between each pair of quaternions, four pairs
+    are blended at a time with a polynomial approximation of the sine ratios
+    #NOTE: results are within 0.00005 of slerp()
+    @_a the quaternions at 0
+    @_b the quaternions at 1
+    @_t the position to interpolate to for each pair
+    @_out receives the interpolated quaternions, may be either input array
+    @_count the number of quaternions*/
+    static void slerp(const Quaternion* _a, const Quaternion* _b,
+        const float* _t, Quaternion* _out, unsigned _count);
+
+    /*!Normalises the quaternion*/
+    void normalise();
+
+    /*!@return the magnitude of the quaternion*/
+    float magnitude() const;
+
+    /*!Computes the dot product of this quaternion and the other quaternion
+    @_other the other quaternion
+    @return the dot product*/
+    float dotProduct(const Quaternion& _other) const;
+
+    /*!Conjugates the quaternion, for a unit quaternion this is the inverse
+    rotation*/
+    void conjugate();
+
+    /*!@return the conjugate of the quaternion*/
+    Quaternion getConjugate() const;
+
+    /*!Rotates the vector by the quaternion
+    #WARNING: the quaternion should be unit length
+    @_vec the vector to rotate
+    @return the rotated vector*/
+    Vector3 rotate(const Vector3& _vec) const;
+
+    /*!@return the quaternion as a SIMD register*/
+    util::simd::Float4 toSimd() const;
+
+    /*!@return the x value*/
+    float getX() const;
+
+    /*!@return the y value*/
+    float getY() const;
+
+    /*!@return the z value*/
+    float getZ() const;
+
+    /*!@return the w value*/
+    float getW() const;
+
+    /*!Sets the new values
+    @_x the new x value
+    @_y the new y value
+    @_z the new z value
+    @_w the new w value*/
+    void set(float _x, float _y, float _z, float _w);
+
+    /*!Outputs the quaternion in string format
+    @return the string of the quaternion*/
+    std::string toString() const;
+
+private:
+
+    //VARIABLES
+    //the imaginary x, y, z parts and the real w part, aligned so they can be
+    //loaded straight into a SIMD register
+    UTIL_SIMD_ALIGN float v[4];
+};
+
+//INLINE
+//OPERATORS
+inline std::ostream& operator <<(std::ostream& _output,
+    const Quaternion& _q) {
+
+    //print the quaternion to the output
+    _output << _q.toString();
+
+    return _output;
+}
+
+inline Quaternion& Quaternion::operator =(const Quaternion& _other) {
+
+    util::simd::store(v, util::simd::load(_other.v));
+
+    return *this;
+}
+
+inline bool Quaternion::operator ==(const Quaternion& _other) const {
+
+    return v[0] == _other.v[0] && v[1] == _other.v[1] &&
+           v[2] == _other.v[2] && v[3] == _other.v[3];
+}
+
+inline bool Quaternion::operator !=(const Quaternion& _other) const {
+
+    return !((*this) == _other);
+}
+
+inline float& Quaternion::operator [](unsigned _index) {
+
+    //check that the index is within bounds
+    if (_index > 3) {
+
+        throw util::ex::IndexOutOfBoundsException("index is greater than 3.");
+    }
+
+    return v[_index];
+}
+
+inline const float& Quaternion::operator [](unsigned _index) const {
+
+    //check that the index is within bounds
+    if (_index > 3) {
+
+        throw util::ex::IndexOutOfBoundsException("index is greater than 3.");
+    }
+
+    return v[_index];
+}
+
+inline Quaternion Quaternion::operator -() const {
+
+    return Quaternion(util::simd::negate(toSimd()));
+}
+
+inline Quaternion Quaternion::operator *(const Quaternion& _other) const {
+
+    const float* o = _other.v;
+
+    return Quaternion(
+        (((v[3] * o[0]) + (v[0] * o[3])) + (v[1] * o[2])) - (v[2] * o[1]),
+        (((v[3] * o[1]) + (v[1] * o[3])) + (v[2] * o[0])) - (v[0] * o[2]),
+        (((v[3] * o[2]) + (v[2] * o[3])) + (v[0] * o[1])) - (v[1] * o[0]),
+        (((v[3] * o[3]) - (v[0] * o[0])) - (v[1] * o[1])) - (v[2] * o[2]));
+}
+
+inline void Quaternion::operator *=(const Quaternion& _other) {
+
+    *this = *this * _other;
+}
+
+//PUBLIC MEMBER FUNCTIONS
+inline Quaternion Quaternion::identity() {
+
+    return Quaternion();
+}
+
+inline Quaternion Quaternion::rotation(float _degrees,
+    const Vector3& _unitVec) {
+
+    float halfAngle = (_degrees * util::val::DEGREES_TO_RADIANS) * 0.5f;
+    float s = sinf(halfAngle);
+
+    return Quaternion(_unitVec.getX() * s, _unitVec.getY() * s,
+        _unitVec.getZ() * s, cosf(halfAngle));
+}
+
+inline Quaternion Quaternion::nlerp(const Quaternion& _a, const Quaternion& _b,
+    float _t) {
+
+    util::simd::Float4 a = _a.toSimd();
+    util::simd::Float4 b = _b.toSimd();
+
+    //take the shortest path by flipping b when the quaternions point away
+    //from each other
+    if (util::simd::dot(a, b) < 0.0f) {
+
+        b = util::simd::negate(b);
+    }
+
+    util::simd::Float4 r = util::simd::add(a,
+        util::simd::mul(util::simd::sub(b, a), util::simd::splat(_t)));
+
+    return Quaternion(util::simd::div(r,
+        util::simd::splat(std::sqrt(util::simd::dot(r, r)))));
+}
+
+inline Quaternion Quaternion::slerp(const Quaternion& _a, const Quaternion& _b,
+    float _t) {
+
+    util::simd::Float4 a = _a.toSimd();
+    util::simd::Float4 b = _b.toSimd();
+    float cosine = util::simd::dot(a, b);
+
+    //take the shortest path
+    if (cosine < 0.0f) {
+
+        b = util::simd::negate(b);
+        cosine = -cosine;
+    }
+
+    //the sine of very small angles is unstable so fall back to a linear
+    //interpolation
+    if (cosine > 0.9995f) {
+
+        return nlerp(_a, Quaternion(b), _t);
+    }
+
+    float angle = acosf(cosine);
+    float sineInv = 1.0f / sinf(angle);
+    float scaleA = sinf((1.0f - _t) * angle) * sineInv;
+    float scaleB = sinf(_t * angle) * sineInv;
+
+    return Quaternion(util::simd::add(
+        util::simd::mul(a, util::simd::splat(scaleA)),
+        util::simd::mul(b, util::simd::splat(scaleB))));
+}
+
+inline void Quaternion::slerp(const Quaternion* _a, const Quaternion* _b,
+    const float* _t, Quaternion* _out, unsigned _count) {
+
+    //coefficients of the series for sin(t * angle) / sin(angle) in terms of
+    //cos(angle) - 1, the last term is scaled to absorb the truncated tail
+    //(D. Eberly, "A Fast and Accurate Algorithm for Computing SLERP")
+    static const float MU = 1.85298109240830f;
+    static const float U[8] = {
+        1.0f / 3.0f, 1.0f / 10.0f, 1.0f / 21.0f, 1.0f / 36.0f,
+        1.0f / 55.0f, 1.0f / 78.0f, 1.0f / 105.0f, MU / 136.0f
+    };
+    static const float V[8] = {
+        1.0f / 3.0f, 2.0f / 5.0f, 3.0f / 7.0f, 4.0f / 9.0f,
+        5.0f / 11.0f, 6.0f / 13.0f, 7.0f / 15.0f, (MU * 8.0f) / 17.0f
+    };
+
+    util::simd::Float4 one = util::simd::splat(1.0f);
+
+    unsigned i = 0;
+    for (; i + 4 <= _count; i += 4) {
+
+        //swizzle four pairs into registers of x, y, z and w values
+        util::simd::Float4 a[4];
+        util::simd::Float4 b[4];
+        for (unsigned j = 0; j < 4; ++j) {
+
+            a[j] = _a[i + j].toSimd();
+            b[j] = _b[i + j].toSimd();
+        }
+        util::simd::transpose(a[0], a[1], a[2], a[3]);
+        util::simd::transpose(b[0], b[1], b[2], b[3]);
+
+        util::simd::Float4 cosine = util::simd::add(
+            util::simd::add(util::simd::mul(a[0], b[0]),
+                util::simd::mul(a[1], b[1])),
+            util::simd::add(util::simd::mul(a[2], b[2]),
+                util::simd::mul(a[3], b[3])));
+
+        //take the shortest path by flipping b wherever the cosine is negative
+        util::simd::Float4 signs = util::simd::signBits(cosine);
+        cosine = util::simd::flipSign(cosine, signs);
+
+        util::simd::Float4 t = util::simd::load(_t + i);
+        util::simd::Float4 d = util::simd::sub(one, t);
+        util::simd::Float4 tt = util::simd::mul(t, t);
+        util::simd::Float4 dd = util::simd::mul(d, d);
+        util::simd::Float4 xm1 = util::simd::sub(cosine, one);
+
+        util::simd::Float4 scaleA = one;
+        util::simd::Float4 scaleB = one;
+        for (int k = 7; k >= 0; --k) {
+
+            util::simd::Float4 u = util::simd::splat(U[k]);
+            util::simd::Float4 w = util::simd::splat(V[k]);
+
+            scaleB = util::simd::add(one, util::simd::mul(util::simd::mul(
+                util::simd::sub(util::simd::mul(u, tt), w), xm1), scaleB));
+            scaleA = util::simd::add(one, util::simd::mul(util::simd::mul(
+                util::simd::sub(util::simd::mul(u, dd), w), xm1), scaleA));
+        }
+        scaleA = util::simd::mul(scaleA, d);
+        scaleB = util::simd::flipSign(util::simd::mul(scaleB, t), signs);
+
+        util::simd::Float4 r[4];
+        for (unsigned j = 0; j < 4; ++j) {
+
+            r[j] = util::simd::add(util::simd::mul(a[j], scaleA),
+                util::simd::mul(b[j], scaleB));
+        }
+        util::simd::transpose(r[0], r[1], r[2], r[3]);
+
+        for (unsigned j = 0; j < 4; ++j) {
+
+            _out[i + j] = Quaternion(r[j]);
+        }
+    }
+    for (; i < _count; ++i) {
+
+        _out[i] = slerp(_a[i], _b[i], _t[i]);
+    }
+}
+
+inline void Quaternion::normalise() {
+
+    util::simd::Float4 values = toSimd();
+    float mag = std::sqrt(util::simd::dot(values, values));
+
+    util::simd::store(v, util::simd::div(values, util::simd::splat(mag)));
+}
+
+inline float Quaternion::magnitude() const {
+
+    util::simd::Float4 values = toSimd();
+
+    return std::sqrt(util::simd::dot(values, values));
+}
+
+inline float Quaternion::dotProduct(const Quaternion& _other) const {
+
+    return util::simd::dot(toSimd(), _other.toSimd());
+}
+
+inline void Quaternion::conjugate() {
+
+    v[0] = -v[0];
+    v[1] = -v[1];
+    v[2] = -v[2];
+}
+
+inline Quaternion Quaternion::getConjugate() const {
+
+    return Quaternion(-v[0], -v[1], -v[2], v[3]);
+}
+
+inline Vector3 Quaternion::rotate(const Vector3& _vec) const {
+
+    //v' = v + 2w(q x v) + 2(q x (q x v))
+    Vector3 q(v[0], v[1], v[2]);
+    Vector3 t = q.crossProduct(_vec) * 2.0f;
+
+    return _vec + (t * v[3]) + q.crossProduct(t);
+}
+
+inline util::simd::Float4 Quaternion::toSimd() const {
+
+    return util::simd::load(v);
+}
+
+inline float Quaternion::getX() const {
+
+    return v[0];
+}
+
+inline float Quaternion::getY() const {
+
+    return v[1];
+}
+
+inline float Quaternion::getZ() const {
+
+    return v[2];
+}
+
+inline float Quaternion::getW() const {
+
+    return v[3];
+}
+
+inline void Quaternion::set(float _x, float _y, float _z, float _w) {
+
+    v[0] = _x;
+    v[1] = _y;
+    v[2] = _z;
+    v[3] = _w;
+}
+
+inline std::string Quaternion::toString() const {
+
+    //create the string of the quaternion
+    std::stringstream ss;
+    ss << "[" << v[0] << ", " << v[1] << ", " << v[2] << ", " << v[3] << "]";
+
+    return ss.str();
+}
+
+} } //util //vec
+
+#endif
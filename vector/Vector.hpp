@@ -0,0 +1,561 @@
+/*******************************************\
+| N dimensional vector of any numeric type. |
+|                                           |
+| @author David Saxon                       |
+\*******************************************/
+
+#ifndef UTILTIES_VECTOR_VECTOR_H_
+#   define UTILTIES_VECTOR_VECTOR_H_
+
+#include <iostream>
+#include <cmath>
+#include <sstream>
+#include <stdint.h>
+
+#include "../MacroUtil.hpp"
+#include "../exceptions/ArrayException.hpp"
+#include "Vector2.hpp"
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+
+namespace util { namespace vec {
+
+//Vector2, Vector3 and Vector4 stay the float vectors used by the rest of the
+//library, Vector4 is built on SIMD registers. This template covers the
+//other element types, such as double precision world coordinates, integer
+//grid cells and 8 bit colours. Every operation is a fixed length loop so the
+//compiler unrolls it and vectorises it where the width fits. From C++14 the
+//operations can be evaluated at compile time.
+//
+//#NOTE: there are deliberately no specialisations on SIMD registers. The
+//intrinsics are not constexpr so a Vector<4, float> on Float4 would lose
+//compile time evaluation, and Vector4 is already the float vector on Float4.
+//The loops of a Vector<4, float>, Vector<4, int32_t> or Vector<4, double>
+//already become single packed instructions from GCC 12 at -O2, and AVX ones
+//for double when AVX is enabled.
+
+/*~An N dimensional vector with elements of type T*/
+template <unsigned N, typename T>
+class Vector {
+public:
+
+    //CONSTRUCTORS
+    /*!Creates a new zero vector*/
+    UTIL_CONSTEXPR Vector() :
+        v() {
+    }
+
+    /*!Creates a new vector with every value set to the scalar
+    @_scalar the value of every element*/
+    UTIL_CONSTEXPR explicit Vector(T _scalar) :
+        v() {
+
+        for (unsigned i = 0; i < N; ++i) {
+
+            v[i] = _scalar;
+        }
+    }
+
+    /*!Creates a new 2D vector, only a Vector<2, T> can be created from two
+    values
+    @_x the vector's first value
+    @_y the vector's second value*/
+    UTIL_CONSTEXPR Vector(T _x, T _y) :
+        v() {
+
+        checkArity<2>();
+        v[0] = _x;
+        v[1] = _y;
+    }
+
+    /*!Creates a new 3D vector, only a Vector<3, T> can be created from three
+    values
+    @_x the vector's first value
+    @_y the vector's second value
+    @_z the vector's third value*/
+    UTIL_CONSTEXPR Vector(T _x, T _y, T _z) :
+        v() {
+
+        checkArity<3>();
+        v[0] = _x;
+        v[1] = _y;
+        v[2] = _z;
+    }
+
+    /*!Creates a new 4D vector, only a Vector<4, T> can be created from four
+    values
+    @_x the vector's first value
+    @_y the vector's second value
+    @_z the vector's third value
+    @_w the vector's fourth value*/
+    UTIL_CONSTEXPR Vector(T _x, T _y, T _z, T _w) :
+        v() {
+
+        checkArity<4>();
+        v[0] = _x;
+        v[1] = _y;
+        v[2] = _z;
+        v[3] = _w;
+    }
+
+    /*!Creates a vector by converting the values of a vector of another type
+    @_other the other vector to convert from*/
+    template <typename U>
+    UTIL_CONSTEXPR explicit Vector(const Vector<N, U>& _other) :
+        v() {
+
+        for (unsigned i = 0; i < N; ++i) {
+
+            v[i] = static_cast<T>(_other.data()[i]);
+        }
+    }
+
+    //OPERATORS
+    /*!Checks if this vector and the other vector are equal
+    @_other the other vector to compare with
+    @return whether the vectors are equal*/
+    UTIL_CONSTEXPR bool operator ==(const Vector& _other) const {
+
+        for (unsigned i = 0; i < N; ++i) {
+
+            if (v[i] != _other.v[i]) {
+
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /*!Checks if this vector and the other vector are not equal
+    @_other the other vector to compare with
+    @return whether the vectors are not equal*/
+    UTIL_CONSTEXPR bool operator !=(const Vector& _other) const {
+
+        return !((*this) == _other);
+    }
+
+    /*!Gets the value at the specified index
+    @_index the index
+    @return the value*/
+    UTIL_CONSTEXPR T& operator [](unsigned _index) {
+
+        //check that the index is within bounds
+        if (_index >= N) {
+
+            throw util::ex::IndexOutOfBoundsException(
+                "index is greater than the vector's size.");
+        }
+
+        return v[_index];
+    }
+
+    /*!Gets the value at the specified index
+    @_index the index
+    @return the value*/
+    UTIL_CONSTEXPR const T& operator [](unsigned _index) const {
+
+        //check that the index is within bounds
+        if (_index >= N) {
+
+            throw util::ex::IndexOutOfBoundsException(
+                "index is greater than the vector's size.");
+        }
+
+        return v[_index];
+    }
+
+    /*!@return the vector with all elements negated*/
+    UTIL_CONSTEXPR Vector operator -() const {
+
+        Vector r;
+        for (unsigned i = 0; i < N; ++i) {
+
+            r.v[i] = static_cast<T>(-v[i]);
+        }
+
+        return r;
+    }
+
+    /*!Creates a new vector from the addition of this and the scalar
+    @_scalar the scalar to add with
+    @return the result of the addition*/
+    UTIL_CONSTEXPR Vector operator +(T _scalar) const {
+
+        Vector r(*this);
+        r += _scalar;
+
+        return r;
+    }
+
+    /*!Adds the value of the scalar to this vector
+    @_scalar the scalar to add*/
+    UTIL_CONSTEXPR void operator +=(T _scalar) {
+
+        for (unsigned i = 0; i < N; ++i) {
+
+            v[i] = static_cast<T>(v[i] + _scalar);
+        }
+    }
+
+    /*!Creates a new vector from the addition of this and the other vector
+    @_other the other vector to add with
+    @return the result of the addition*/
+    UTIL_CONSTEXPR Vector operator +(const Vector& _other) const {
+
+        Vector r(*this);
+        r += _other;
+
+        return r;
+    }
+
+    /*!Adds the value of the other vector to this vector
+    @_other the other vector to add to this*/
+    UTIL_CONSTEXPR void operator +=(const Vector& _other) {
+
+        for (unsigned i = 0; i < N; ++i) {
+
+            v[i] = static_cast<T>(v[i] + _other.v[i]);
+        }
+    }
+
+    /*!Creates a new vector from the subtraction of this and the scalar
+    @_scalar the scalar to subtract with
+    @return the result of the subtraction*/
+    UTIL_CONSTEXPR Vector operator -(T _scalar) const {
+
+        Vector r(*this);
+        r -= _scalar;
+
+        return r;
+    }
+
+    /*!Subtracts the value of the scalar from this vector
+    @_scalar the scalar to subtract*/
+    UTIL_CONSTEXPR void operator -=(T _scalar) {
+
+        for (unsigned i = 0; i < N; ++i) {
+
+            v[i] = static_cast<T>(v[i] - _scalar);
+        }
+    }
+
+    /*!Creates a new vector from the subtraction of this and the other vector
+    @_other the other vector to subtract with
+    @return the result of the subtraction*/
+    UTIL_CONSTEXPR Vector operator -(const Vector& _other) const {
+
+        Vector r(*this);
+        r -= _other;
+
+        return r;
+    }
+
+    /*!Subtracts the value of the other vector from this vector
+    @_other the other vector to subtract from this*/
+    UTIL_CONSTEXPR void operator -=(const Vector& _other) {
+
+        for (unsigned i = 0; i < N; ++i) {
+
+            v[i] = static_cast<T>(v[i] - _other.v[i]);
+        }
+    }
+
+    /*!Creates a new vector from the multiplication of this and the scalar
+    @_scalar the scalar to multiply with
+    @return the result of the multiplication*/
+    UTIL_CONSTEXPR Vector operator *(T _scalar) const {
+
+        Vector r(*this);
+        r *= _scalar;
+
+        return r;
+    }
+
+    /*!Multiplies this vector by the scalar
+    @_scalar the scalar to multiply by*/
+    UTIL_CONSTEXPR void operator *=(T _scalar) {
+
+        for (unsigned i = 0; i < N; ++i) {
+
+            v[i] = static_cast<T>(v[i] * _scalar);
+        }
+    }
+
+    /*!Creates a new vector from the multiplication of this and the other vector
+    #NOTE: where multiplication is evaluated as (x1 * x2), (y1 * y2), ....
+    @_other the other vector to multiply with
+    @return the result of the multiplication*/
+    UTIL_CONSTEXPR Vector operator *(const Vector& _other) const {
+
+        Vector r(*this);
+        r *= _other;
+
+        return r;
+    }
+
+    /*!Multiplies this vector by the other vector
+    #NOTE: where multiplication is evaluated as (x1 * x2), (y1 * y2), ....
+    @_other the other vector to multiply by*/
+    UTIL_CONSTEXPR void operator *=(const Vector& _other) {
+
+        for (unsigned i = 0; i < N; ++i) {
+
+            v[i] = static_cast<T>(v[i] * _other.v[i]);
+        }
+    }
+
+    /*!Creates a new vector from the division of this and the scalar
+    @_scalar the scalar to divide by
+    @return the result of the division*/
+    UTIL_CONSTEXPR Vector operator /(T _scalar) const {
+
+        Vector r(*this);
+        r /= _scalar;
+
+        return r;
+    }
+
+    /*!Divides this vector by the scalar
+    @_scalar the scalar to divide by*/
+    UTIL_CONSTEXPR void operator /=(T _scalar) {
+
+        for (unsigned i = 0; i < N; ++i) {
+
+            v[i] = static_cast<T>(v[i] / _scalar);
+        }
+    }
+
+    /*!Creates a new vector from the division of this and the other vector
+    #NOTE: where division is evaluated as (x1 / x2), (y1 / y2), ....
+    @_other the other vector to divide with
+    @return the result of the division*/
+    UTIL_CONSTEXPR Vector operator /(const Vector& _other) const {
+
+        Vector r(*this);
+        r /= _other;
+
+        return r;
+    }
+
+    /*!Divides this vector by the other vector
+    #NOTE: where division is evaluated as (x1 / x2), (y1 / y2), ....
+    @_other the other vector to divide by*/
+    UTIL_CONSTEXPR void operator /=(const Vector& _other) {
+
+        for (unsigned i = 0; i < N; ++i) {
+
+            v[i] = static_cast<T>(v[i] / _other.v[i]);
+        }
+    }
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!@return the zero vector*/
+    static UTIL_CONSTEXPR Vector zero() {
+
+        return Vector();
+    }
+
+    /*!@return the number of values in the vector*/
+    static UTIL_CONSTEXPR unsigned size() {
+
+        return N;
+    }
+
+    /*!Resets the vector to the zero vector*/
+    UTIL_CONSTEXPR void clear() {
+
+        for (unsigned i = 0; i < N; ++i) {
+
+            v[i] = T();
+        }
+    }
+
+    /*!Inverses the vector*/
+    UTIL_CONSTEXPR void inverse() {
+
+        (*this) = -(*this);
+    }
+
+    /*!normalises the vector*/
+    void normalise() {
+
+        (*this) /= magnitude();
+    }
+
+    /*!@return the magnitude of the vector*/
+    T magnitude() const {
+
+        return static_cast<T>(std::sqrt(dotProduct(*this)));
+    }
+
+    /*!@return the squared magnitude of the vector, which skips the square root
+    and is enough for comparing lengths*/
+    UTIL_CONSTEXPR T squaredMagnitude() const {
+
+        return dotProduct(*this);
+    }
+
+    /*!Computes the dot product of this vector and the other vector
+    @_other the other vector
+    @return the dot product*/
+    UTIL_CONSTEXPR T dotProduct(const Vector& _other) const {
+
+        T r = T();
+        for (unsigned i = 0; i < N; ++i) {
+
+            r = static_cast<T>(r + v[i] * _other.v[i]);
+        }
+
+        return r;
+    }
+
+    /*!Calculates the distance between this vector and the other vector
+    @_other the vector
+    @return the distance*/
+    T distance(const Vector& _other) const {
+
+        return ((*this) - _other).magnitude();
+    }
+
+    /*!Calculates the squared distance between this vector and the other
+    vector, which skips the square root and is enough for comparing distances
+    @_other the other vector
+    @return the squared distance*/
+    UTIL_CONSTEXPR T squaredDistance(const Vector& _other) const {
+
+        return ((*this) - _other).squaredMagnitude();
+    }
+
+    /*!@return the values of the vector, unchecked and contiguous*/
+    UTIL_CONSTEXPR T* data() {
+
+        return v;
+    }
+
+    /*!@return the values of the vector, unchecked and contiguous*/
+    UTIL_CONSTEXPR const T* data() const {
+
+        return v;
+    }
+
+    /*!Outputs the vector in string format
+    @return the string of the vector*/
+    std::string toString() const {
+
+        //create the string of the vector, promoting so 8 bit values are
+        //printed as numbers rather than characters
+        std::stringstream ss;
+        ss << "[";
+        for (unsigned i = 0; i < N; ++i) {
+
+            if (i != 0) {
+
+                ss << ", ";
+            }
+            ss << +v[i];
+        }
+        ss << "]";
+
+        return ss.str();
+    }
+
+private:
+
+    //VARIABLES
+    //the values of the vector
+    T v[N];
+
+    //PRIVATE MEMBER FUNCTIONS
+    /*!Fails to compile when a constructor taking Count values is used by a
+    vector that does not have Count values, it is only instantiated by the
+    constructors that are called so the rest stay available*/
+    template <unsigned Count>
+    static UTIL_CONSTEXPR void checkArity() {
+
+        typedef char ArityMatches[(Count == N) ? 1 : -1];
+        (void) sizeof(ArityMatches);
+    }
+};
+
+//TYPEDEFS
+typedef Vector<2, double> Vector2d;
+typedef Vector<3, double> Vector3d;
+typedef Vector<4, double> Vector4d;
+
+typedef Vector<2, int32_t> Vector2i;
+typedef Vector<3, int32_t> Vector3i;
+typedef Vector<4, int32_t> Vector4i;
+
+//!8 bit per channel colours
+typedef Vector<3, uint8_t> Vector3ub;
+typedef Vector<4, uint8_t> Vector4ub;
+
+//arrays of vectors are read as unbroken arrays of values, for example by
+//Matrix4d::transformPoints()
+typedef char Vector3dIsPacked[
+    (sizeof(Vector3d) == (3 * sizeof(double))) ? 1 : -1];
+typedef char Vector3iIsPacked[
+    (sizeof(Vector3i) == (3 * sizeof(int32_t))) ? 1 : -1];
+typedef char Vector3ubIsPacked[
+    (sizeof(Vector3ub) == (3 * sizeof(uint8_t))) ? 1 : -1];
+
+//FUNCTIONS
+/*!Prints the vector to the output stream
+@_output the output stream to print to
+@_v the vector to print
+@return the changed output stream*/
+template <unsigned N, typename T>
+inline std::ostream& operator <<(std::ostream& _output,
+    const Vector<N, T>& _v) {
+
+    _output << _v.toString();
+
+    return _output;
+}
+
+/*!Computes the cross product of the two 3D vectors
+@_a the first vector
+@_b the second vector
+@return the vector that is the result of the cross product*/
+template <typename T>
+inline UTIL_CONSTEXPR Vector<3, T> crossProduct(const Vector<3, T>& _a,
+    const Vector<3, T>& _b) {
+
+    const T* a = _a.data();
+    const T* b = _b.data();
+
+    return Vector<3, T>(
+        static_cast<T>((a[1] * b[2]) - (a[2] * b[1])),
+        static_cast<T>((a[2] * b[0]) - (a[0] * b[2])),
+        static_cast<T>((a[0] * b[1]) - (a[1] * b[0])));
+}
+
+/*!@return the vector converted to the float 2D vector*/
+template <typename T>
+inline Vector2 toVector2(const Vector<2, T>& _v) {
+
+    return Vector2(static_cast<float>(_v.data()[0]),
+        static_cast<float>(_v.data()[1]));
+}
+
+/*!@return the vector converted to the float 3D vector*/
+template <typename T>
+inline Vector3 toVector3(const Vector<3, T>& _v) {
+
+    return Vector3(static_cast<float>(_v.data()[0]),
+        static_cast<float>(_v.data()[1]), static_cast<float>(_v.data()[2]));
+}
+
+/*!@return the vector converted to the float 4D vector*/
+template <typename T>
+inline Vector4 toVector4(const Vector<4, T>& _v) {
+
+    return Vector4(static_cast<float>(_v.data()[0]),
+        static_cast<float>(_v.data()[1]), static_cast<float>(_v.data()[2]),
+        static_cast<float>(_v.data()[3]));
+}
+
+} } //util //vec
+
+#endif
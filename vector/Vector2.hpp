@@ -11,7 +11,9 @@
 #include <cmath>
 #include <sstream>
 
+#include "../SimdUtil.hpp"
 #include "../exceptions/ArrayException.hpp"
+#include "Precision.hpp"
 
 namespace util { namespace vec {
 
@@ -200,15 +202,35 @@ public:
     /*!Inverses the vector*/
     void inverse();
 
-    /*!@return the vector inversed*/
+    /*!Creates a new inversed copy of the vector
+    #NOTE: the copy is allocated and must be deleted by the caller, the
+    unary minus operator gives the inverse by value without allocating
+    @return the vector inversed*/
     Vector2* getInverse() const;
 
     /*!normalises the vector*/
     void normalise();
 
+    /*!normalises the vector exactly, the same as normalise()*/
+    void normalise(Exact);
+
+    /*!normalises the vector by multiplying it with its approximate reciprocal
+    magnitude*/
+    void normalise(Approximate);
+
     /*!@return the magnitude of the vector*/
     float magnitude() const;
 
+    /*!@return the magnitude of the vector, the same as magnitude()*/
+    float magnitude(Exact) const;
+
+    /*!@return the approximate magnitude of the vector*/
+    float magnitude(Approximate) const;
+
+    /*!@return the squared magnitude of the vector, which skips the square root
+    and is enough for comparing lengths*/
+    float squaredMagnitude() const;
+
     /*!Computes the dot product of this vector and the other vector
     @_other the other vector
     @return the dot product*/
@@ -219,14 +241,35 @@ public:
     @return the distance*/
     float distance(const util::vec::Vector2& _other) const;
 
+    /*!Calculates the squared distance between this vector and the other
+    vector, which skips the square root and is enough for comparing distances
+    @_other the other vector
+    @return the squared distance*/
+    float squaredDistance(const util::vec::Vector2& _other) const;
+
     /*!Calculates the angle between this vector and the other vector
     @_other the other vector
     @return the angle between*/
     float angleBetween(const util::vec::Vector2& _other) const;
 
-    /*!@return the vector as an array*/
+    /*!Copies the values of the vector into a new array
+    #NOTE: the array is allocated and must be deleted by the caller, use
+    data() or toArray(float*) to avoid the allocation
+    @return the vector as an array*/
     float* toArray() const;
 
+    /*!Copies the values of the vector into the given array
+    @_array the array to write the 2 values to*/
+    void toArray(float* _array) const;
+
+    /*!@return the values of the vector as a contiguous array, valid for as long
+    as the vector is*/
+    float* data();
+
+    /*!@return the values of the vector as a contiguous array, valid for as long
+    as the vector is*/
+    const float* data() const;
+
     /*!@return the x value*/
     float getX() const;
 
@@ -280,6 +323,10 @@ private:
     float y;
 };
 
+//data() reads the values as an array so they must be packed with no padding
+typedef char Vector2IsPacked[
+    (sizeof(Vector2) == (2 * sizeof(float))) ? 1 : -1];
+
 //INLINE
 //OPERATORS
 inline std::ostream& operator <<(std::ostream& _output,
@@ -487,9 +534,44 @@ inline void Vector2::normalise() {
     y /= mag;
 }
 
+inline void Vector2::normalise(Exact) {
+
+    normalise();
+}
+
+inline void Vector2::normalise(Approximate) {
+
+    float inv = util::simd::rsqrt(squaredMagnitude());
+
+    x *= inv;
+    y *= inv;
+}
+
 inline float Vector2::magnitude() const {
 
-    return distance(Vector2::zero());
+    return std::sqrt(squaredMagnitude());
+}
+
+inline float Vector2::magnitude(Exact) const {
+
+    return magnitude();
+}
+
+inline float Vector2::magnitude(Approximate) const {
+
+    //the estimate of zero is infinite so zero is handled on its own
+    float squared = squaredMagnitude();
+    if (squared == 0.0f) {
+
+        return 0.0f;
+    }
+
+    return squared * util::simd::rsqrt(squared);
+}
+
+inline float Vector2::squaredMagnitude() const {
+
+    return dotProduct(*this);
 }
 
 inline float Vector2::dotProduct(const util::vec::Vector2& _other) const {
@@ -499,7 +581,15 @@ inline float Vector2::dotProduct(const util::vec::Vector2& _other) const {
 
 inline float Vector2::distance(const util::vec::Vector2& _other) const {
 
-    return sqrt(pow(x - _other.x, 2.0f) + pow(y - _other.y, 2.0f));
+    return std::sqrt(squaredDistance(_other));
+}
+
+inline float Vector2::squaredDistance(const util::vec::Vector2& _other) const {
+
+    float dx = x - _other.x;
+    float dy = y - _other.y;
+
+    return (dx * dx) + (dy * dy);
 }
 
 inline float Vector2::angleBetween(const util::vec::Vector2& _other) const {
@@ -516,6 +606,22 @@ inline float* Vector2::toArray() const {
     return array;
 }
 
+inline void Vector2::toArray(float* _array) const {
+
+    _array[0] = x;
+    _array[1] = y;
+}
+
+inline float* Vector2::data() {
+
+    return &x;
+}
+
+inline const float* Vector2::data() const {
+
+    return &x;
+}
+
 inline float Vector2::getX() const {
 
     return x;
@@ -11,7 +11,10 @@
 #include <cmath>
 #include <sstream>
 
+#include "../MacroUtil.hpp"
+#include "../SimdUtil.hpp"
 #include "../exceptions/ArrayException.hpp"
+#include "Precision.hpp"
 
 namespace util { namespace vec {
 
@@ -58,7 +61,7 @@ public:
 
     //CONSTRUCTORS
     /*!Creates a new zero 3D vector*/
-    Vector3() :
+    UTIL_CONSTEXPR Vector3() :
         x(0),
         y(0),
         z(0) {
@@ -68,7 +71,7 @@ public:
     @_x the vector's first value
     @_y the vector's second value
     @_z the vector's third value*/
-    Vector3(float _x, float _y, float _z) :
+    UTIL_CONSTEXPR Vector3(float _x, float _y, float _z) :
         x(_x),
         y(_y),
         z(_z) {
@@ -76,17 +79,12 @@ public:
 
     /*!Creates a vector by copying the other vector
     @_other the other vector to copy from*/
-    Vector3(const Vector3& _other) :
+    UTIL_CONSTEXPR Vector3(const Vector3& _other) :
         x(_other.x),
         y(_other.y),
         z(_other.z) {
     }
 
-    //DESTRUCTOR
-    /*!Destorys this vector*/
-    ~Vector3() {
-    }
-
     //OPERATORS
     /*!Copies the other vector's values to this vector
     @_other the other vector to copy from*/
@@ -194,16 +192,16 @@ public:
 
     //PUBLIC MEMBER FUNCTIONS
     /*!@return the 3D zero vector*/
-    static Vector3 zero();
+    static UTIL_CONSTEXPR Vector3 zero();
 
     /*!@return the x 3d vector*/
-    static Vector3 xVector();
+    static UTIL_CONSTEXPR Vector3 xVector();
 
     /*!@return the y 3d vector*/
-    static Vector3 yVector();
+    static UTIL_CONSTEXPR Vector3 yVector();
 
     /*!@return the z 3d vector*/
-    static Vector3 zVector();
+    static UTIL_CONSTEXPR Vector3 zVector();
 
     /*!@return the white rgb vector*/
     static Vector3 white();
@@ -247,15 +245,35 @@ public:
     /*!Inverses the vector*/
     void inverse();
 
-    /*!@return the vector inversed*/
+    /*!Creates a new inversed copy of the vector
+    #NOTE: the copy is allocated and must be deleted by the caller, the
+    unary minus operator gives the inverse by value without allocating
+    @return the vector inversed*/
     Vector3* getInverse() const;
 
     /*!normalises the vector*/
     void normalise();
+
+    /*!normalises the vector exactly, the same as normalise()*/
+    void normalise(Exact);
+
+    /*!normalises the vector by multiplying it with its approximate reciprocal
+    magnitude*/
+    void normalise(Approximate);
     
     /*!@return the magnitude of the vector*/
     float magnitude() const;
 
+    /*!@return the magnitude of the vector, the same as magnitude()*/
+    float magnitude(Exact) const;
+
+    /*!@return the approximate magnitude of the vector*/
+    float magnitude(Approximate) const;
+
+    /*!@return the squared magnitude of the vector, which skips the square root
+    and is enough for comparing lengths*/
+    float squaredMagnitude() const;
+
     /*!Computes the dot product of this vector and the other vector
     @_other the other vector
     @return the dot product*/
@@ -271,22 +289,43 @@ public:
     @return the distance*/
     float distance(const Vector3& _other) const;
 
+    /*!Calculates the squared distance between this vector and the other
+    vector, which skips the square root and is enough for comparing distances
+    @_other the other vector
+    @return the squared distance*/
+    float squaredDistance(const Vector3& _other) const;
+
     /*Calculates the angle between this vector and the other vector
     @_other the other vector
     @return the angle between the two vectors*/
     float angleBetween(const Vector3& _other) const;
 
-    /*!@return the vector as an array*/
+    /*!Copies the values of the vector into a new array
+    #NOTE: the array is allocated and must be deleted by the caller, use
+    data() or toArray(float*) to avoid the allocation
+    @return the vector as an array*/
     float* toArray() const;
 
+    /*!Copies the values of the vector into the given array
+    @_array the array to write the 3 values to*/
+    void toArray(float* _array) const;
+
+    /*!@return the values of the vector as a contiguous array, valid for as long
+    as the vector is*/
+    float* data();
+
+    /*!@return the values of the vector as a contiguous array, valid for as long
+    as the vector is*/
+    const float* data() const;
+
     /*!@return the x value*/
-    float getX() const;
+    UTIL_CONSTEXPR float getX() const;
 
     /*!@return the y value*/
-    float getY() const;
+    UTIL_CONSTEXPR float getY() const;
 
     /*!@return the z value*/
-    float getZ() const;
+    UTIL_CONSTEXPR float getZ() const;
 
     /*!@return the x value*/
     float getR() const;
@@ -352,6 +391,10 @@ private:
     float z;
 };
 
+//data() reads the values as an array so they must be packed with no padding
+typedef char Vector3IsPacked[
+    (sizeof(Vector3) == (3 * sizeof(float))) ? 1 : -1];
+
 //INLINE
 //OPERATORS
 inline std::ostream& operator <<(std::ostream& _output,
@@ -534,22 +577,22 @@ inline void Vector3::operator /=(const Vector3& _other) {
 }
 
 //PUBLIC MEMBER FUNCTIONS
-inline Vector3 Vector3::zero() {
+inline UTIL_CONSTEXPR Vector3 Vector3::zero() {
 
     return Vector3();
 }
 
-inline Vector3 Vector3::xVector() {
+inline UTIL_CONSTEXPR Vector3 Vector3::xVector() {
 
     return Vector3(1.0f, 0.0f, 0.0f);
 }
 
-inline Vector3 Vector3::yVector() {
+inline UTIL_CONSTEXPR Vector3 Vector3::yVector() {
 
     return Vector3(0.0f, 1.0f, 0.0f);
 }
 
-inline Vector3 Vector3::zVector() {
+inline UTIL_CONSTEXPR Vector3 Vector3::zVector() {
 
     return Vector3(0.0f, 0.0f, 1.0f);
 }
@@ -644,9 +687,45 @@ inline void Vector3::normalise() {
     z /= mag;
 }
 
+inline void Vector3::normalise(Exact) {
+
+    normalise();
+}
+
+inline void Vector3::normalise(Approximate) {
+
+    float inv = util::simd::rsqrt(squaredMagnitude());
+
+    x *= inv;
+    y *= inv;
+    z *= inv;
+}
+
 inline float Vector3::magnitude() const {
 
-    return distance(Vector3::zero());
+    return std::sqrt(squaredMagnitude());
+}
+
+inline float Vector3::magnitude(Exact) const {
+
+    return magnitude();
+}
+
+inline float Vector3::magnitude(Approximate) const {
+
+    //the estimate of zero is infinite so zero is handled on its own
+    float squared = squaredMagnitude();
+    if (squared == 0.0f) {
+
+        return 0.0f;
+    }
+
+    return squared * util::simd::rsqrt(squared);
+}
+
+inline float Vector3::squaredMagnitude() const {
+
+    return dotProduct(*this);
 }
 
 inline float Vector3::dotProduct(const Vector3& _other) const {
@@ -662,7 +741,7 @@ inline Vector3 Vector3::crossProduct(const Vector3& _other) const {
     float cz = 0.0f;
 
     cx = (y * _other.z) - (z * _other.y);
-    cy = (x * _other.z) - (z * _other.x);
+    cy = (z * _other.x) - (x * _other.z);
     cz = (x * _other.y) - (y * _other.x);
 
     return Vector3(cx, cy, cz);
@@ -670,8 +749,16 @@ inline Vector3 Vector3::crossProduct(const Vector3& _other) const {
 
 inline float Vector3::distance(const Vector3& _other) const {
 
-    return sqrt(pow(x - _other.x, 2.0f) + pow(y - _other.y, 2.0f) +
-        pow(z - _other.z, 2.0f));
+    return std::sqrt(squaredDistance(_other));
+}
+
+inline float Vector3::squaredDistance(const Vector3& _other) const {
+
+    float dx = x - _other.x;
+    float dy = y - _other.y;
+    float dz = z - _other.z;
+
+    return (dx * dx) + (dy * dy) + (dz * dz);
 }
 
 inline float Vector3::angleBetween(const Vector3& _other) const {
@@ -689,17 +776,34 @@ inline float* Vector3::toArray() const {
     return array;
 }
 
-inline float Vector3::getX() const {
+inline void Vector3::toArray(float* _array) const {
+
+    _array[0] = x;
+    _array[1] = y;
+    _array[2] = z;
+}
+
+inline float* Vector3::data() {
+
+    return &x;
+}
+
+inline const float* Vector3::data() const {
+
+    return &x;
+}
+
+inline UTIL_CONSTEXPR float Vector3::getX() const {
 
     return x;
 }
 
-inline float Vector3::getY() const {
+inline UTIL_CONSTEXPR float Vector3::getY() const {
 
     return y;
 }
 
-inline float Vector3::getZ() const {
+inline UTIL_CONSTEXPR float Vector3::getZ() const {
 
     return z;
 }
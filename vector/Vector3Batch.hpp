@@ -0,0 +1,933 @@
+/******************************************\
+| Structure of arrays batch of 3D vectors. |
+|                                          |
+| @author David Saxon                      |
+\******************************************/
+
+#ifndef UTILTIES_VECTOR_VECTOR3BATCH_H_
+#   define UTILTIES_VECTOR_VECTOR3BATCH_H_
+
+#include <cstddef>
+#include <vector>
+
+#if defined(_OPENMP)
+#   include <omp.h>
+#endif
+
+#include "../SimdUtil.hpp"
+#include "../exceptions/ArrayException.hpp"
+#include "../exceptions/FunctionCallException.hpp"
+#include "Vector3.hpp"
+
+namespace util { namespace vec {
+
+/*********************************************************************\
+| Holds a batch of 3D vectors as three separate arrays of x, y and z  |
+| values so that operations can be run over four vectors at a time.   |
+|                                                                     |
+| @author David Saxon                                                 |
+\*********************************************************************/
+class Vector3Batch {
+public:
+
+    //CONSTRUCTORS
+    /*!Creates a new empty batch*/
+    Vector3Batch() {
+    }
+
+    /*!Creates a new batch of zero vectors
+    @_size the number of vectors in the batch*/
+    explicit Vector3Batch(unsigned _size) :
+        x(_size, 0.0f),
+        y(_size, 0.0f),
+        z(_size, 0.0f) {
+    }
+
+    /*!Creates a new batch by copying the array of vectors
+    @_vectors the array of vectors to copy
+    @_count the number of vectors in the array*/
+    Vector3Batch(const Vector3* _vectors, unsigned _count) {
+
+        fromArray(_vectors, _count);
+    }
+
+    //OPERATORS
+    /*!Gets the vector at the given index
+    @_index the index of the vector
+    @return a copy of the vector*/
+    Vector3 operator [](unsigned _index) const;
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!Adds the two batches together
+    @_a the first batch
+    @_b the second batch
+    @_out is resized and filled with the results, may be either input*/
+    static void add(const Vector3Batch& _a, const Vector3Batch& _b,
+        Vector3Batch& _out);
+
+    /*!Subtracts the second batch from the first batch
+    @_a the first batch
+    @_b the batch to subtract
+    @_out is resized and filled with the results, may be either input*/
+    static void subtract(const Vector3Batch& _a, const Vector3Batch& _b,
+        Vector3Batch& _out);
+
+    /*!Multiplies every vector in the batch by the scalar
+    @_a the batch to scale
+    @_scalar the scalar to multiply by
+    @_out is resized and filled with the results, may be the input*/
+    static void scale(const Vector3Batch& _a, float _scalar,
+        Vector3Batch& _out);
+
+    /*!Computes the dot product of each pair of vectors
+    @_a the first batch
+    @_b the second batch
+    @_out must have room for size() results*/
+    static void dotProduct(const Vector3Batch& _a, const Vector3Batch& _b,
+        float* _out);
+
+    /*!Computes the cross product of each pair of vectors
+    @_a the first batch
+    @_b the second batch
+    @_out is resized and filled with the results, may be either input*/
+    static void crossProduct(const Vector3Batch& _a, const Vector3Batch& _b,
+        Vector3Batch& _out);
+
+    /*!Normalises each vector in the batch
+    @_a the batch to normalise
+    @_out is resized and filled with the results, may be the input*/
+    static void normalise(const Vector3Batch& _a, Vector3Batch& _out);
+
+    /*!Computes the distance between each pair of vectors
+    @_a the first batch
+    @_b the second batch
+    @_out must have room for size() results*/
+    static void distance(const Vector3Batch& _a, const Vector3Batch& _b,
+        float* _out);
+
+    /*!Computes the magnitude of each vector in the batch
+    @_a the batch
+    @_out must have room for size() results*/
+    static void magnitude(const Vector3Batch& _a, float* _out);
+
+    /*!Computes the squared distance between every vector of the first batch
+    and every vector of the second batch, the second batch is worked through
+    in tiles that stay in cache while they are compared with a block of rows
+    @_a the first batch, one row of results per vector
+    @_b the second batch, one column of results per vector
+    @_out must have room for _a.size() * _b.size() results, the distance
+    between _a[i] and _b[j] is written to _out[(i * _b.size()) + j]
+    @_parallel whether the rows are split across threads, only when built
+    with OpenMP*/
+    static void pairwiseSquaredDistance(const Vector3Batch& _a,
+        const Vector3Batch& _b, float* _out, bool _parallel = false);
+
+    /*!Finds the nearest vectors of the second batch to every vector of the
+    first batch without storing the full distance matrix
+    @_a the batch of vectors to search around
+    @_b the batch of vectors to search through
+    @_k the number of nearest vectors to find for each vector of _a, must not
+    be greater than _b.size()
+    @_indices must have room for _a.size() * _k results, receives the indices
+    into _b of the nearest vectors for each vector of _a, nearest first
+    @_squaredDistances may be NULL, otherwise must have room for
+    _a.size() * _k results and receives the matching squared distances
+    @_parallel whether the rows are split across threads, only when built
+    with OpenMP*/
+    static void nearest(const Vector3Batch& _a, const Vector3Batch& _b,
+        unsigned _k, unsigned* _indices, float* _squaredDistances = NULL,
+        bool _parallel = false);
+
+    /*!Replaces the contents of the batch with the array of vectors
+    @_vectors the array of vectors to copy
+    @_count the number of vectors in the array*/
+    void fromArray(const Vector3* _vectors, unsigned _count);
+
+    /*!Copies the batch into an array of vectors
+    @_vectors must have room for size() vectors*/
+    void toArray(Vector3* _vectors) const;
+
+    /*!@return the number of vectors in the batch*/
+    unsigned size() const;
+
+    /*!Changes the number of vectors in the batch, new vectors are zero
+    @_size the new number of vectors*/
+    void resize(unsigned _size);
+
+    /*!Removes all vectors from the batch*/
+    void clear();
+
+    /*!Sets the vector at the given index
+    @_index the index of the vector
+    @_vector the new value*/
+    void set(unsigned _index, const Vector3& _vector);
+
+    /*!@return the array of x values*/
+    float* getX();
+
+    /*!@return the array of x values*/
+    const float* getX() const;
+
+    /*!@return the array of y values*/
+    float* getY();
+
+    /*!@return the array of y values*/
+    const float* getY() const;
+
+    /*!@return the array of z values*/
+    float* getZ();
+
+    /*!@return the array of z values*/
+    const float* getZ() const;
+
+private:
+
+    //VARIABLES
+    //the separate component arrays
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    //PRIVATE MEMBER FUNCTIONS
+    /*!Checks that the two batches are the same size
+    @_a the first batch
+    @_b the second batch*/
+    static void checkSize(const Vector3Batch& _a, const Vector3Batch& _b);
+
+    /*!Computes the squared distances from one point to a range of vectors
+    @_px the x value of the point
+    @_py the y value of the point
+    @_pz the z value of the point
+    @_x the x values of the vectors
+    @_y the y values of the vectors
+    @_z the z values of the vectors
+    @_begin the index of the first vector of the range
+    @_end the index one past the last vector of the range
+    @_out receives the distance to vector j at _out[j - _begin]*/
+    static void squaredDistanceRow(float _px, float _py, float _pz,
+        const float* _x, const float* _y, const float* _z,
+        unsigned _begin, unsigned _end, float* _out);
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+    /*!Computes the dot products of as many vectors as fit in 8 wide AVX2
+    registers
+    @return the number of vectors computed, the rest are left to the caller*/
+    UTIL_SIMD_TARGET("avx2,fma")
+    static unsigned dotProductAvx2(const float* _ax, const float* _ay,
+        const float* _az, const float* _bx, const float* _by,
+        const float* _bz, float* _out, unsigned _count);
+
+    /*!Computes the dot products of as many vectors as fit in 16 wide AVX-512
+    registers
+    @return the number of vectors computed, the rest are left to the caller*/
+    UTIL_SIMD_TARGET("avx512f")
+    static unsigned dotProductAvx512(const float* _ax, const float* _ay,
+        const float* _az, const float* _bx, const float* _by,
+        const float* _bz, float* _out, unsigned _count);
+
+    /*!Normalises as many vectors as fit in 8 wide AVX2 registers
+    @return the number of vectors normalised, the rest are left to the
+    caller*/
+    UTIL_SIMD_TARGET("avx2,fma")
+    static unsigned normaliseAvx2(const float* _ax, const float* _ay,
+        const float* _az, float* _ox, float* _oy, float* _oz,
+        unsigned _count);
+
+    /*!Normalises as many vectors as fit in 16 wide AVX-512 registers
+    @return the number of vectors normalised, the rest are left to the
+    caller*/
+    UTIL_SIMD_TARGET("avx512f")
+    static unsigned normaliseAvx512(const float* _ax, const float* _ay,
+        const float* _az, float* _ox, float* _oy, float* _oz,
+        unsigned _count);
+#endif
+};
+
+//INLINE
+//OPERATORS
+inline Vector3 Vector3Batch::operator [](unsigned _index) const {
+
+    //check that the index is within bounds
+    if (_index >= size()) {
+
+        throw util::ex::IndexOutOfBoundsException(
+            "index is greater than the batch size.");
+    }
+
+    return Vector3(x[_index], y[_index], z[_index]);
+}
+
+//PUBLIC MEMBER FUNCTIONS
+inline void Vector3Batch::add(const Vector3Batch& _a, const Vector3Batch& _b,
+    Vector3Batch& _out) {
+
+    checkSize(_a, _b);
+    _out.resize(_a.size());
+
+    const float* in[6] = {_a.getX(), _a.getY(), _a.getZ(),
+                          _b.getX(), _b.getY(), _b.getZ()};
+    float* out[3] = {_out.getX(), _out.getY(), _out.getZ()};
+    unsigned count = _a.size();
+
+    for (unsigned c = 0; c < 3; ++c) {
+
+        unsigned i = 0;
+        for (; i + 4 <= count; i += 4) {
+
+            util::simd::store(out[c] + i, util::simd::add(
+                util::simd::load(in[c] + i), util::simd::load(in[c + 3] + i)));
+        }
+        for (; i < count; ++i) {
+
+            out[c][i] = in[c][i] + in[c + 3][i];
+        }
+    }
+}
+
+inline void Vector3Batch::subtract(const Vector3Batch& _a,
+    const Vector3Batch& _b, Vector3Batch& _out) {
+
+    checkSize(_a, _b);
+    _out.resize(_a.size());
+
+    const float* in[6] = {_a.getX(), _a.getY(), _a.getZ(),
+                          _b.getX(), _b.getY(), _b.getZ()};
+    float* out[3] = {_out.getX(), _out.getY(), _out.getZ()};
+    unsigned count = _a.size();
+
+    for (unsigned c = 0; c < 3; ++c) {
+
+        unsigned i = 0;
+        for (; i + 4 <= count; i += 4) {
+
+            util::simd::store(out[c] + i, util::simd::sub(
+                util::simd::load(in[c] + i), util::simd::load(in[c + 3] + i)));
+        }
+        for (; i < count; ++i) {
+
+            out[c][i] = in[c][i] - in[c + 3][i];
+        }
+    }
+}
+
+inline void Vector3Batch::scale(const Vector3Batch& _a, float _scalar,
+    Vector3Batch& _out) {
+
+    _out.resize(_a.size());
+
+    const float* in[3] = {_a.getX(), _a.getY(), _a.getZ()};
+    float* out[3] = {_out.getX(), _out.getY(), _out.getZ()};
+    unsigned count = _a.size();
+    util::simd::Float4 s = util::simd::splat(_scalar);
+
+    for (unsigned c = 0; c < 3; ++c) {
+
+        unsigned i = 0;
+        for (; i + 4 <= count; i += 4) {
+
+            util::simd::store(out[c] + i,
+                util::simd::mul(util::simd::load(in[c] + i), s));
+        }
+        for (; i < count; ++i) {
+
+            out[c][i] = in[c][i] * _scalar;
+        }
+    }
+}
+
+inline void Vector3Batch::dotProduct(const Vector3Batch& _a,
+    const Vector3Batch& _b, float* _out) {
+
+    checkSize(_a, _b);
+
+    const float* ax = _a.getX();
+    const float* ay = _a.getY();
+    const float* az = _a.getZ();
+    const float* bx = _b.getX();
+    const float* by = _b.getY();
+    const float* bz = _b.getZ();
+    unsigned count = _a.size();
+    util::simd::cpu::Level level = util::simd::level();
+
+    //the widest kernel the processor supports takes as many vectors as it
+    //can and the rest fall through to the narrower loops
+    unsigned i = 0;
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (level == util::simd::cpu::AVX512) {
+
+        i = dotProductAvx512(ax, ay, az, bx, by, bz, _out, count);
+    }
+    else if (level == util::simd::cpu::AVX2) {
+
+        i = dotProductAvx2(ax, ay, az, bx, by, bz, _out, count);
+    }
+#endif
+    if (level != util::simd::cpu::SCALAR) {
+
+        for (; i + 4 <= count; i += 4) {
+
+            util::simd::Float4 d = util::simd::mul(
+                util::simd::load(ax + i), util::simd::load(bx + i));
+            d = util::simd::add(d, util::simd::mul(
+                util::simd::load(ay + i), util::simd::load(by + i)));
+            d = util::simd::add(d, util::simd::mul(
+                util::simd::load(az + i), util::simd::load(bz + i)));
+
+            util::simd::store(_out + i, d);
+        }
+    }
+    for (; i < count; ++i) {
+
+        _out[i] = (ax[i] * bx[i]) + (ay[i] * by[i]) + (az[i] * bz[i]);
+    }
+}
+
+inline void Vector3Batch::crossProduct(const Vector3Batch& _a,
+    const Vector3Batch& _b, Vector3Batch& _out) {
+
+    checkSize(_a, _b);
+    _out.resize(_a.size());
+
+    const float* ax = _a.getX();
+    const float* ay = _a.getY();
+    const float* az = _a.getZ();
+    const float* bx = _b.getX();
+    const float* by = _b.getY();
+    const float* bz = _b.getZ();
+    float* ox = _out.getX();
+    float* oy = _out.getY();
+    float* oz = _out.getZ();
+    unsigned count = _a.size();
+
+    //all inputs are read before any output is written so the output may
+    //alias either input
+    unsigned i = 0;
+    for (; i + 4 <= count; i += 4) {
+
+        util::simd::Float4 vax = util::simd::load(ax + i);
+        util::simd::Float4 vay = util::simd::load(ay + i);
+        util::simd::Float4 vaz = util::simd::load(az + i);
+        util::simd::Float4 vbx = util::simd::load(bx + i);
+        util::simd::Float4 vby = util::simd::load(by + i);
+        util::simd::Float4 vbz = util::simd::load(bz + i);
+
+        util::simd::store(ox + i, util::simd::sub(
+            util::simd::mul(vay, vbz), util::simd::mul(vaz, vby)));
+        util::simd::store(oy + i, util::simd::sub(
+            util::simd::mul(vaz, vbx), util::simd::mul(vax, vbz)));
+        util::simd::store(oz + i, util::simd::sub(
+            util::simd::mul(vax, vby), util::simd::mul(vay, vbx)));
+    }
+    for (; i < count; ++i) {
+
+        float cx = (ay[i] * bz[i]) - (az[i] * by[i]);
+        float cy = (az[i] * bx[i]) - (ax[i] * bz[i]);
+        float cz = (ax[i] * by[i]) - (ay[i] * bx[i]);
+
+        ox[i] = cx;
+        oy[i] = cy;
+        oz[i] = cz;
+    }
+}
+
+inline void Vector3Batch::normalise(const Vector3Batch& _a,
+    Vector3Batch& _out) {
+
+    _out.resize(_a.size());
+
+    const float* ax = _a.getX();
+    const float* ay = _a.getY();
+    const float* az = _a.getZ();
+    float* ox = _out.getX();
+    float* oy = _out.getY();
+    float* oz = _out.getZ();
+    unsigned count = _a.size();
+    util::simd::cpu::Level level = util::simd::level();
+
+    unsigned i = 0;
+#if defined(UTIL_SIMD_DISPATCH)
+
+    if (level == util::simd::cpu::AVX512) {
+
+        i = normaliseAvx512(ax, ay, az, ox, oy, oz, count);
+    }
+    else if (level == util::simd::cpu::AVX2) {
+
+        i = normaliseAvx2(ax, ay, az, ox, oy, oz, count);
+    }
+#endif
+    if (level != util::simd::cpu::SCALAR) {
+
+        for (; i + 4 <= count; i += 4) {
+
+            util::simd::Float4 vx = util::simd::load(ax + i);
+            util::simd::Float4 vy = util::simd::load(ay + i);
+            util::simd::Float4 vz = util::simd::load(az + i);
+
+            util::simd::Float4 mag = util::simd::sqrt(util::simd::add(
+                util::simd::add(util::simd::mul(vx, vx),
+                    util::simd::mul(vy, vy)),
+                util::simd::mul(vz, vz)));
+
+            util::simd::store(ox + i, util::simd::div(vx, mag));
+            util::simd::store(oy + i, util::simd::div(vy, mag));
+            util::simd::store(oz + i, util::simd::div(vz, mag));
+        }
+    }
+    for (; i < count; ++i) {
+
+        float mag = std::sqrt(
+            (ax[i] * ax[i]) + (ay[i] * ay[i]) + (az[i] * az[i]));
+
+        ox[i] = ax[i] / mag;
+        oy[i] = ay[i] / mag;
+        oz[i] = az[i] / mag;
+    }
+}
+
+inline void Vector3Batch::distance(const Vector3Batch& _a,
+    const Vector3Batch& _b, float* _out) {
+
+    checkSize(_a, _b);
+
+    const float* ax = _a.getX();
+    const float* ay = _a.getY();
+    const float* az = _a.getZ();
+    const float* bx = _b.getX();
+    const float* by = _b.getY();
+    const float* bz = _b.getZ();
+    unsigned count = _a.size();
+
+    unsigned i = 0;
+    for (; i + 4 <= count; i += 4) {
+
+        util::simd::Float4 dx = util::simd::sub(
+            util::simd::load(ax + i), util::simd::load(bx + i));
+        util::simd::Float4 dy = util::simd::sub(
+            util::simd::load(ay + i), util::simd::load(by + i));
+        util::simd::Float4 dz = util::simd::sub(
+            util::simd::load(az + i), util::simd::load(bz + i));
+
+        util::simd::store(_out + i, util::simd::sqrt(util::simd::add(
+            util::simd::add(util::simd::mul(dx, dx), util::simd::mul(dy, dy)),
+            util::simd::mul(dz, dz))));
+    }
+    for (; i < count; ++i) {
+
+        float dx = ax[i] - bx[i];
+        float dy = ay[i] - by[i];
+        float dz = az[i] - bz[i];
+
+        _out[i] = std::sqrt((dx * dx) + (dy * dy) + (dz * dz));
+    }
+}
+
+inline void Vector3Batch::magnitude(const Vector3Batch& _a, float* _out) {
+
+    const float* ax = _a.getX();
+    const float* ay = _a.getY();
+    const float* az = _a.getZ();
+    unsigned count = _a.size();
+
+    unsigned i = 0;
+    for (; i + 4 <= count; i += 4) {
+
+        util::simd::Float4 vx = util::simd::load(ax + i);
+        util::simd::Float4 vy = util::simd::load(ay + i);
+        util::simd::Float4 vz = util::simd::load(az + i);
+
+        util::simd::store(_out + i, util::simd::sqrt(util::simd::add(
+            util::simd::add(util::simd::mul(vx, vx), util::simd::mul(vy, vy)),
+            util::simd::mul(vz, vz))));
+    }
+    for (; i < count; ++i) {
+
+        _out[i] = std::sqrt(
+            (ax[i] * ax[i]) + (ay[i] * ay[i]) + (az[i] * az[i]));
+    }
+}
+
+inline void Vector3Batch::pairwiseSquaredDistance(const Vector3Batch& _a,
+    const Vector3Batch& _b, float* _out, bool _parallel) {
+
+    //a tile of the second batch is 12KB so it stays in the L1 cache while a
+    //block of rows is compared with it
+    const unsigned ROWS = 64;
+    const unsigned COLS = 1024;
+
+    const float* ax = _a.getX();
+    const float* ay = _a.getY();
+    const float* az = _a.getZ();
+    const float* bx = _b.getX();
+    const float* by = _b.getY();
+    const float* bz = _b.getZ();
+    unsigned rows = _a.size();
+    unsigned cols = _b.size();
+    int blocks = static_cast<int>((rows + ROWS - 1) / ROWS);
+
+#if defined(_OPENMP)
+#   pragma omp parallel for schedule(dynamic) if (_parallel)
+#endif
+    for (int block = 0; block < blocks; ++block) {
+
+        unsigned rowBegin = static_cast<unsigned>(block) * ROWS;
+        unsigned rowEnd = rowBegin + ROWS < rows ? rowBegin + ROWS : rows;
+
+        for (unsigned colBegin = 0; colBegin < cols; colBegin += COLS) {
+
+            unsigned colEnd = colBegin + COLS < cols ? colBegin + COLS : cols;
+            for (unsigned i = rowBegin; i < rowEnd; ++i) {
+
+                squaredDistanceRow(ax[i], ay[i], az[i], bx, by, bz,
+                    colBegin, colEnd,
+                    _out + (static_cast<size_t>(i) * cols) + colBegin);
+            }
+        }
+    }
+
+#if !defined(_OPENMP)
+    (void) _parallel;
+#endif
+}
+
+inline void Vector3Batch::nearest(const Vector3Batch& _a,
+    const Vector3Batch& _b, unsigned _k, unsigned* _indices,
+    float* _squaredDistances, bool _parallel) {
+
+    if (_k > _b.size()) {
+
+        throw util::ex::IllegalArgumentException(
+            "cannot find more nearest vectors than are in the batch.");
+    }
+    if (_k == 0) {
+
+        return;
+    }
+
+    const unsigned ROWS = 64;
+    const unsigned COLS = 1024;
+
+    const float* ax = _a.getX();
+    const float* ay = _a.getY();
+    const float* az = _a.getZ();
+    const float* bx = _b.getX();
+    const float* by = _b.getY();
+    const float* bz = _b.getZ();
+    unsigned rows = _a.size();
+    unsigned cols = _b.size();
+    int blocks = static_cast<int>((rows + ROWS - 1) / ROWS);
+
+    //the current k nearest of every row in a block are kept sorted nearest
+    //first, every thread's lists are allocated up front so the parallel
+    //region does not allocate
+#if defined(_OPENMP)
+
+    size_t threads =
+        _parallel ? static_cast<size_t>(omp_get_max_threads()) : 1;
+#else
+
+    (void) _parallel;
+    size_t threads = 1;
+#endif
+    std::vector<float> nearestDistances(threads * ROWS * _k);
+
+#if defined(_OPENMP)
+#   pragma omp parallel if (_parallel)
+#endif
+    {
+#if defined(_OPENMP)
+
+        float* bestDistances = &nearestDistances[
+            static_cast<size_t>(omp_get_thread_num()) * ROWS * _k];
+#   pragma omp for schedule(dynamic)
+#else
+
+        float* bestDistances = &nearestDistances[0];
+#endif
+        for (int block = 0; block < blocks; ++block) {
+
+            //one tile of distances and the number found for every row in
+            //the block
+            float tile[COLS];
+            unsigned found[ROWS];
+
+            unsigned rowBegin = static_cast<unsigned>(block) * ROWS;
+            unsigned rowEnd = rowBegin + ROWS < rows ? rowBegin + ROWS : rows;
+            for (unsigned i = rowBegin; i < rowEnd; ++i) {
+
+                found[i - rowBegin] = 0;
+            }
+
+            for (unsigned colBegin = 0; colBegin < cols; colBegin += COLS) {
+
+                unsigned colEnd =
+                    colBegin + COLS < cols ? colBegin + COLS : cols;
+                for (unsigned i = rowBegin; i < rowEnd; ++i) {
+
+                    squaredDistanceRow(ax[i], ay[i], az[i], bx, by, bz,
+                        colBegin, colEnd, tile);
+
+                    float* distances = bestDistances +
+                        (static_cast<size_t>(i - rowBegin) * _k);
+                    unsigned* indices =
+                        _indices + (static_cast<size_t>(i) * _k);
+                    unsigned& count = found[i - rowBegin];
+
+                    for (unsigned j = colBegin; j < colEnd; ++j) {
+
+                        float d = tile[j - colBegin];
+                        if (count == _k && d >= distances[_k - 1]) {
+
+                            continue;
+                        }
+
+                        //insert into the sorted list, dropping the furthest
+                        unsigned slot = count < _k ? count++ : _k - 1;
+                        for (; slot > 0 && distances[slot - 1] > d; --slot) {
+
+                            distances[slot] = distances[slot - 1];
+                            indices[slot] = indices[slot - 1];
+                        }
+                        distances[slot] = d;
+                        indices[slot] = j;
+                    }
+                }
+            }
+
+            if (_squaredDistances != NULL) {
+
+                for (unsigned i = rowBegin; i < rowEnd; ++i) {
+
+                    const float* best = bestDistances +
+                        (static_cast<size_t>(i - rowBegin) * _k);
+                    float* out =
+                        _squaredDistances + (static_cast<size_t>(i) * _k);
+                    for (unsigned n = 0; n < _k; ++n) {
+
+                        out[n] = best[n];
+                    }
+                }
+            }
+        }
+    }
+}
+
+inline void Vector3Batch::fromArray(const Vector3* _vectors, unsigned _count) {
+
+    resize(_count);
+
+    for (unsigned i = 0; i < _count; ++i) {
+
+        x[i] = _vectors[i].getX();
+        y[i] = _vectors[i].getY();
+        z[i] = _vectors[i].getZ();
+    }
+}
+
+inline void Vector3Batch::toArray(Vector3* _vectors) const {
+
+    for (unsigned i = 0; i < size(); ++i) {
+
+        _vectors[i].set(x[i], y[i], z[i]);
+    }
+}
+
+inline unsigned Vector3Batch::size() const {
+
+    return static_cast<unsigned>(x.size());
+}
+
+inline void Vector3Batch::resize(unsigned _size) {
+
+    x.resize(_size, 0.0f);
+    y.resize(_size, 0.0f);
+    z.resize(_size, 0.0f);
+}
+
+inline void Vector3Batch::clear() {
+
+    x.clear();
+    y.clear();
+    z.clear();
+}
+
+inline void Vector3Batch::set(unsigned _index, const Vector3& _vector) {
+
+    //check that the index is within bounds
+    if (_index >= size()) {
+
+        throw util::ex::IndexOutOfBoundsException(
+            "index is greater than the batch size.");
+    }
+
+    x[_index] = _vector.getX();
+    y[_index] = _vector.getY();
+    z[_index] = _vector.getZ();
+}
+
+inline float* Vector3Batch::getX() {
+
+    return x.empty() ? 0 : &x[0];
+}
+
+inline const float* Vector3Batch::getX() const {
+
+    return x.empty() ? 0 : &x[0];
+}
+
+inline float* Vector3Batch::getY() {
+
+    return y.empty() ? 0 : &y[0];
+}
+
+inline const float* Vector3Batch::getY() const {
+
+    return y.empty() ? 0 : &y[0];
+}
+
+inline float* Vector3Batch::getZ() {
+
+    return z.empty() ? 0 : &z[0];
+}
+
+inline const float* Vector3Batch::getZ() const {
+
+    return z.empty() ? 0 : &z[0];
+}
+
+//PRIVATE MEMBER FUNCTIONS
+inline void Vector3Batch::checkSize(const Vector3Batch& _a,
+    const Vector3Batch& _b) {
+
+    if (_a.size() != _b.size()) {
+
+        throw util::ex::IllegalArgumentException(
+            "batches must contain the same number of vectors.");
+    }
+}
+
+inline void Vector3Batch::squaredDistanceRow(float _px, float _py,
+    float _pz, const float* _x, const float* _y, const float* _z,
+    unsigned _begin, unsigned _end, float* _out) {
+
+    util::simd::Float4 px = util::simd::splat(_px);
+    util::simd::Float4 py = util::simd::splat(_py);
+    util::simd::Float4 pz = util::simd::splat(_pz);
+
+    unsigned j = _begin;
+    for (; j + 4 <= _end; j += 4) {
+
+        util::simd::Float4 dx = util::simd::sub(util::simd::load(_x + j), px);
+        util::simd::Float4 dy = util::simd::sub(util::simd::load(_y + j), py);
+        util::simd::Float4 dz = util::simd::sub(util::simd::load(_z + j), pz);
+
+        util::simd::store(_out + (j - _begin), util::simd::add(
+            util::simd::add(util::simd::mul(dx, dx), util::simd::mul(dy, dy)),
+            util::simd::mul(dz, dz)));
+    }
+    for (; j < _end; ++j) {
+
+        float dx = _x[j] - _px;
+        float dy = _y[j] - _py;
+        float dz = _z[j] - _pz;
+
+        _out[j - _begin] = (dx * dx) + (dy * dy) + (dz * dz);
+    }
+}
+
+#if defined(UTIL_SIMD_DISPATCH)
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline unsigned Vector3Batch::dotProductAvx2(const float* _ax,
+    const float* _ay, const float* _az, const float* _bx, const float* _by,
+    const float* _bz, float* _out, unsigned _count) {
+
+    unsigned i = 0;
+    for (; i + 8 <= _count; i += 8) {
+
+        __m256 d = _mm256_mul_ps(_mm256_loadu_ps(_ax + i),
+            _mm256_loadu_ps(_bx + i));
+        d = _mm256_fmadd_ps(_mm256_loadu_ps(_ay + i),
+            _mm256_loadu_ps(_by + i), d);
+        d = _mm256_fmadd_ps(_mm256_loadu_ps(_az + i),
+            _mm256_loadu_ps(_bz + i), d);
+
+        _mm256_storeu_ps(_out + i, d);
+    }
+
+    return i;
+}
+
+UTIL_SIMD_TARGET("avx512f")
+inline unsigned Vector3Batch::dotProductAvx512(const float* _ax,
+    const float* _ay, const float* _az, const float* _bx, const float* _by,
+    const float* _bz, float* _out, unsigned _count) {
+
+    unsigned i = 0;
+    for (; i + 16 <= _count; i += 16) {
+
+        __m512 d = _mm512_mul_ps(_mm512_loadu_ps(_ax + i),
+            _mm512_loadu_ps(_bx + i));
+        d = _mm512_fmadd_ps(_mm512_loadu_ps(_ay + i),
+            _mm512_loadu_ps(_by + i), d);
+        d = _mm512_fmadd_ps(_mm512_loadu_ps(_az + i),
+            _mm512_loadu_ps(_bz + i), d);
+
+        _mm512_storeu_ps(_out + i, d);
+    }
+
+    return i;
+}
+
+UTIL_SIMD_TARGET("avx2,fma")
+inline unsigned Vector3Batch::normaliseAvx2(const float* _ax,
+    const float* _ay, const float* _az, float* _ox, float* _oy, float* _oz,
+    unsigned _count) {
+
+    unsigned i = 0;
+    for (; i + 8 <= _count; i += 8) {
+
+        __m256 vx = _mm256_loadu_ps(_ax + i);
+        __m256 vy = _mm256_loadu_ps(_ay + i);
+        __m256 vz = _mm256_loadu_ps(_az + i);
+
+        __m256 mag = _mm256_sqrt_ps(_mm256_fmadd_ps(vz, vz,
+            _mm256_fmadd_ps(vy, vy, _mm256_mul_ps(vx, vx))));
+
+        _mm256_storeu_ps(_ox + i, _mm256_div_ps(vx, mag));
+        _mm256_storeu_ps(_oy + i, _mm256_div_ps(vy, mag));
+        _mm256_storeu_ps(_oz + i, _mm256_div_ps(vz, mag));
+    }
+
+    return i;
+}
+
+UTIL_SIMD_TARGET("avx512f")
+inline unsigned Vector3Batch::normaliseAvx512(const float* _ax,
+    const float* _ay, const float* _az, float* _ox, float* _oy, float* _oz,
+    unsigned _count) {
+
+    unsigned i = 0;
+    for (; i + 16 <= _count; i += 16) {
+
+        __m512 vx = _mm512_loadu_ps(_ax + i);
+        __m512 vy = _mm512_loadu_ps(_ay + i);
+        __m512 vz = _mm512_loadu_ps(_az + i);
+
+        __m512 mag = _mm512_sqrt_ps(_mm512_fmadd_ps(vz, vz,
+            _mm512_fmadd_ps(vy, vy, _mm512_mul_ps(vx, vx))));
+
+        _mm512_storeu_ps(_ox + i, _mm512_div_ps(vx, mag));
+        _mm512_storeu_ps(_oy + i, _mm512_div_ps(vy, mag));
+        _mm512_storeu_ps(_oz + i, _mm512_div_ps(vz, mag));
+    }
+
+    return i;
+}
+#endif
+
+} } //util //vec
+
+#endif
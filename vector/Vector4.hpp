@@ -11,7 +11,10 @@
 #include <cmath>
 #include <sstream>
 
+#include "../MacroUtil.hpp"
+#include "../SimdUtil.hpp"
 #include "../exceptions/ArrayException.hpp"
+#include "Precision.hpp"
 
 namespace util { namespace vec {
 
@@ -52,10 +55,8 @@ public:
 
     //CONSTRUCTORS
     /*!Creates a new zero 4D vector*/
-    Vector4() :
-        x(0),
-        y(0),
-        z(0) {
+    UTIL_CONSTEXPR Vector4() :
+        v() {
     }
 
     /*!Creates a new 4D vector
@@ -63,32 +64,26 @@ public:
     @_y the vector's second value
     @_z the vector's third value
     @_w the vector's fourth value*/
-    Vector4(float _x, float _y, float _z, float _w) :
-        x(_x),
-        y(_y),
-        z(_z),
-        w(_w) {
-    }
+    UTIL_CONSTEXPR Vector4(float _x, float _y, float _z, float _w) :
+        v() {
 
-    /*!Creates a vector by copying the other vector
-    @_other the other vector to copy from*/
-    Vector4(const Vector4& _other) :
-        x(_other.x),
-        y(_other.y),
-        z(_other.z),
-        w(_other.w) {
+        v[0] = _x;
+        v[1] = _y;
+        v[2] = _z;
+        v[3] = _w;
     }
 
-    //DESTRUCTOR
-    /*!Destorys this vector*/
-    ~Vector4() {
+    /*!Creates a vector from the four values of a SIMD register
+    @_simd the register holding the x, y, z and w values*/
+    explicit Vector4(util::simd::Float4 _simd) {
+
+        util::simd::store(v, _simd);
     }
 
-    //OPERATORS
-    /*!Copies the other vector's values to this vector
-    @_other the other vector to copy from*/
-    Vector4& operator =(const Vector4& _other);
+    //copying, assignment and destruction are left to the compiler so the
+    //vector is trivially copyable and can be used in constant expressions
 
+    //OPERATORS
     /*!Checks if this vector and the other vector are equal
     @_other the other vector to compare with
     @return whether the vectors are equal*/
@@ -190,19 +185,19 @@ public:
 
     //PUBLIC MEMBER FUNCTIONS
     /*!@return the 4D zero vector*/
-    static Vector4 zero();
+    static UTIL_CONSTEXPR Vector4 zero();
 
     /*!@return the x 4d vector*/
-    static Vector4 xVector();
+    static UTIL_CONSTEXPR Vector4 xVector();
 
     /*!@return the y 4d vector*/
-    static Vector4 yVector();
+    static UTIL_CONSTEXPR Vector4 yVector();
 
     /*!@return the z 4d vector*/
-    static Vector4 zVector();
+    static UTIL_CONSTEXPR Vector4 zVector();
 
     /*!@return the w 4d vector*/
-    static Vector4 wVector();
+    static UTIL_CONSTEXPR Vector4 wVector();
 
     /*!@return the white rgba vector*/
     static Vector4 white();
@@ -246,15 +241,35 @@ public:
     /*!Inverses the vector*/
     void inverse();
 
-    /*!@return the vector inversed*/
+    /*!Creates a new inversed copy of the vector
+    #NOTE: the copy is allocated and must be deleted by the caller, the
+    unary minus operator gives the inverse by value without allocating
+    @return the vector inversed*/
     Vector4* getInverse() const;
 
     /*!normalises the vector*/
     void normalise();
 
+    /*!normalises the vector exactly, the same as normalise()*/
+    void normalise(Exact);
+
+    /*!normalises the vector by multiplying it with its approximate reciprocal
+    magnitude*/
+    void normalise(Approximate);
+
     /*!@return the magnitude of the vector*/
     float magnitude() const;
 
+    /*!@return the magnitude of the vector, the same as magnitude()*/
+    float magnitude(Exact) const;
+
+    /*!@return the approximate magnitude of the vector*/
+    float magnitude(Approximate) const;
+
+    /*!@return the squared magnitude of the vector, which skips the square root
+    and is enough for comparing lengths*/
+    float squaredMagnitude() const;
+
     /*!Computes the dot product of this vector and the other vector
     @_other the other vector
     @return the dot product*/
@@ -265,20 +280,44 @@ public:
     @return the distance*/
     float distance(const Vector4& _other) const;
 
-    /*!@return the vector as an array*/
+    /*!Calculates the squared distance between this vector and the other
+    vector, which skips the square root and is enough for comparing distances
+    @_other the other vector
+    @return the squared distance*/
+    float squaredDistance(const Vector4& _other) const;
+
+    /*!Copies the values of the vector into a new array
+    #NOTE: the array is allocated and must be deleted by the caller, use
+    data() or toArray(float*) to avoid the allocation
+    @return the vector as an array*/
     float* toArray() const;
 
+    /*!Copies the values of the vector into the given array
+    @_array the array to write the 4 values to*/
+    void toArray(float* _array) const;
+
+    /*!@return the values of the vector as a contiguous array, valid for as long
+    as the vector is*/
+    float* data();
+
+    /*!@return the values of the vector as a contiguous array, valid for as long
+    as the vector is*/
+    const float* data() const;
+
+    /*!@return the vector as a SIMD register*/
+    util::simd::Float4 toSimd() const;
+
     /*!@return the x value*/
-    float getX() const;
+    UTIL_CONSTEXPR float getX() const;
 
     /*!@return the y value*/
-    float getY() const;
+    UTIL_CONSTEXPR float getY() const;
 
     /*!@return the z value*/
-    float getZ() const;
+    UTIL_CONSTEXPR float getZ() const;
 
     /*!@return the w value*/
-    float getW() const;
+    UTIL_CONSTEXPR float getW() const;
 
     /*!@return the x value*/
     float getR() const;
@@ -330,11 +369,9 @@ public:
 private:
 
     //VARIABLES
-    //the four values of the vector
-    float x;
-    float y;
-    float z;
-    float w;
+    //the four values of the vector, aligned so they can be loaded straight
+    //into a SIMD register
+    UTIL_SIMD_ALIGN float v[4];
 };
 
 //INLINE
@@ -348,19 +385,10 @@ inline std::ostream& operator <<(std::ostream& _output,
     return _output;
 }
 
-inline Vector4& Vector4::operator =(const Vector4& _other) {
-
-    x = _other.x;
-    y = _other.y;
-    z = _other.z;
-    w = _other.w;
-
-    return *this;
-}
-
 inline bool Vector4::operator ==(const Vector4& _other) const {
 
-    return x == _other.x && y == _other.y && z == _other.z && w == _other.w;
+    return v[0] == _other.v[0] && v[1] == _other.v[1] &&
+           v[2] == _other.v[2] && v[3] == _other.v[3];
 }
 
 inline bool Vector4::operator !=(const Vector4& _other) const {
@@ -376,25 +404,7 @@ inline float& Vector4::operator [](unsigned _index) {
         throw util::ex::IndexOutOfBoundsException("index is greater than 3.");
     }
 
-    switch (_index) {
-
-        case 0: {
-
-            return x;
-        }
-        case 1: {
-
-            return y;
-        }
-        case 2: {
-
-            return z;
-        }
-        default: {
-
-            return w;
-        }
-    }
+    return v[_index];
 }
 
 inline const float& Vector4::operator [](unsigned _index) const {
@@ -405,158 +415,120 @@ inline const float& Vector4::operator [](unsigned _index) const {
         throw util::ex::IndexOutOfBoundsException("index is greater than 3.");
     }
 
-    switch (_index) {
-
-        case 0: {
-
-            return x;
-        }
-        case 1: {
-
-            return y;
-        }
-        case 2: {
-
-            return z;
-        }
-        default: {
-
-            return w;
-        }
-    }
+    return v[_index];
 }
 
 inline Vector4 Vector4::operator -() const {
 
-    return Vector4(-x, -y, -z, -w);
+    return Vector4(util::simd::negate(toSimd()));
 }
 
 inline Vector4 Vector4::operator +(float _scalar) const {
 
-    return Vector4(x + _scalar, y + _scalar, z + _scalar, w + _scalar);
+    return Vector4(util::simd::add(toSimd(), util::simd::splat(_scalar)));
 }
 
 inline void Vector4::operator +=(float _scalar) {
 
-    x += _scalar;
-    y += _scalar;
-    z += _scalar;
-    w += _scalar;
+    util::simd::store(v,
+        util::simd::add(toSimd(), util::simd::splat(_scalar)));
 }
 
 inline Vector4 Vector4::operator +(const Vector4& _other) const {
 
-    return Vector4(x + _other.x, y + _other.y, z + _other.z, w + _other.w);
+    return Vector4(util::simd::add(toSimd(), _other.toSimd()));
 }
 
 inline void Vector4::operator +=(const Vector4& _other) {
 
-    x += _other.x;
-    y += _other.y;
-    z += _other.z;
-    w += _other.w;
+    util::simd::store(v, util::simd::add(toSimd(), _other.toSimd()));
 }
 
 inline Vector4 Vector4::operator -(float _scalar) const {
 
-    return Vector4(x - _scalar, y - _scalar, z - _scalar, w - _scalar);
+    return Vector4(util::simd::sub(toSimd(), util::simd::splat(_scalar)));
 }
 
 inline void Vector4::operator -=(float _scalar) {
 
-    x -= _scalar;
-    y -= _scalar;
-    z -= _scalar;
-    w -= _scalar;
+    util::simd::store(v,
+        util::simd::sub(toSimd(), util::simd::splat(_scalar)));
 }
 
 inline Vector4 Vector4::operator -(const Vector4& _other) const {
 
-    return Vector4(x - _other.x, y - _other.y, z - _other.z, w - _other.w);
+    return Vector4(util::simd::sub(toSimd(), _other.toSimd()));
 }
 
 inline void Vector4::operator -=(const Vector4& _other) {
 
-    x -= _other.x;
-    y -= _other.y;
-    z -= _other.z;
-    w -= _other.w;
+    util::simd::store(v, util::simd::sub(toSimd(), _other.toSimd()));
 }
 
 inline Vector4 Vector4::operator *(float _scalar) const {
 
-    return Vector4(x * _scalar, y * _scalar, z * _scalar, w * _scalar);
+    return Vector4(util::simd::mul(toSimd(), util::simd::splat(_scalar)));
 }
 
 inline void Vector4::operator *=(float _scalar) {
 
-    x *= _scalar;
-    y *= _scalar;
-    z *= _scalar;
-    w *= _scalar;
+    util::simd::store(v,
+        util::simd::mul(toSimd(), util::simd::splat(_scalar)));
 }
 
 inline Vector4 Vector4::operator *(const Vector4& _other) const {
 
-    return Vector4(x * _other.x, y * _other.y, z * _other.z, w * _other.w);
+    return Vector4(util::simd::mul(toSimd(), _other.toSimd()));
 }
 
 inline void Vector4::operator *=(const Vector4& _other) {
 
-    x *= _other.x;
-    y *= _other.y;
-    z *= _other.z;
-    w *= _other.w;
+    util::simd::store(v, util::simd::mul(toSimd(), _other.toSimd()));
 }
 
 inline Vector4 Vector4::operator /(float _scalar) const {
 
-    return Vector4(x / _scalar, y / _scalar, z / _scalar, w / _scalar);
+    return Vector4(util::simd::div(toSimd(), util::simd::splat(_scalar)));
 }
 
 inline void Vector4::operator /=(float _scalar) {
 
-    x /= _scalar;
-    y /= _scalar;
-    z /= _scalar;
-    w /= _scalar;
+    util::simd::store(v,
+        util::simd::div(toSimd(), util::simd::splat(_scalar)));
 }
 
 inline Vector4 Vector4::operator /(const Vector4& _other) const {
 
-    return Vector4(x / _other.x, y / _other.y, z / _other.z, w / _other.w);
+    return Vector4(util::simd::div(toSimd(), _other.toSimd()));
 }
 
 inline void Vector4::operator /=(const Vector4& _other) {
 
-    x /= _other.x;
-    y /= _other.y;
-    z /= _other.z;
-    w /= _other.w;
+    util::simd::store(v, util::simd::div(toSimd(), _other.toSimd()));
 }
 
 //PUBLIC MEMBER FUNCTIONS
-inline Vector4 Vector4::zero() {
+inline UTIL_CONSTEXPR Vector4 Vector4::zero() {
 
     return Vector4();
 }
 
-inline Vector4 Vector4::xVector() {
+inline UTIL_CONSTEXPR Vector4 Vector4::xVector() {
 
     return Vector4(1.0f, 0.0f, 0.0f, 0.0f);
 }
 
-inline Vector4 Vector4::yVector() {
+inline UTIL_CONSTEXPR Vector4 Vector4::yVector() {
 
     return Vector4(0.0f, 1.0f, 0.0f, 0.0f);
 }
 
-inline Vector4 Vector4::zVector() {
+inline UTIL_CONSTEXPR Vector4 Vector4::zVector() {
 
     return Vector4(0.0f, 0.0f, 1.0f, 0.0f);
 }
 
-inline Vector4 Vector4::wVector() {
+inline UTIL_CONSTEXPR Vector4 Vector4::wVector() {
 
     return Vector4(0.0f, 0.0f, 0.0f, 1.0f);
 }
@@ -623,157 +595,208 @@ inline Vector4 Vector4::purple() {
 
 inline void Vector4::clear() {
 
-    x = 0;
-    y = 0;
-    z = 0;
-    w = 0;
+    util::simd::store(v, util::simd::splat(0.0f));
 }
 
 inline void Vector4::inverse() {
 
-    x = -x;
-    y = -y;
-    z = -z;
-    w = -w;
+    util::simd::store(v, util::simd::negate(toSimd()));
 }
 
 inline Vector4* Vector4::getInverse() const {
 
-    return new Vector4(-x, -y, -z, -w);
+    return new Vector4(util::simd::negate(toSimd()));
 }
 
 inline void Vector4::normalise() {
 
     //get the magnitude
-    float mag = magnitude();
+    util::simd::Float4 values = toSimd();
+    float mag = std::sqrt(util::simd::dot(values, values));
 
     //normalise the components
-    x /= mag;
-    y /= mag;
-    z /= mag;
-    w /= mag;
+    util::simd::store(v, util::simd::div(values, util::simd::splat(mag)));
+}
+
+inline void Vector4::normalise(Exact) {
+
+    normalise();
+}
+
+inline void Vector4::normalise(Approximate) {
+
+    util::simd::Float4 values = toSimd();
+    util::simd::Float4 inv = util::simd::rsqrt(
+        util::simd::splat(util::simd::dot(values, values)));
+
+    util::simd::store(v, util::simd::mul(values, inv));
 }
 
 inline float Vector4::magnitude() const {
 
-    return distance(Vector4::zero());
+    return std::sqrt(squaredMagnitude());
+}
+
+inline float Vector4::magnitude(Exact) const {
+
+    return magnitude();
+}
+
+inline float Vector4::magnitude(Approximate) const {
+
+    //the estimate of zero is infinite so zero is handled on its own
+    float squared = squaredMagnitude();
+    if (squared == 0.0f) {
+
+        return 0.0f;
+    }
+
+    return squared * util::simd::rsqrt(squared);
+}
+
+inline float Vector4::squaredMagnitude() const {
+
+    return dotProduct(*this);
 }
 
 inline float Vector4::dotProduct(const Vector4& _other)  const {
 
-    return (x * _other.x) + (y * _other.y) + (z * _other.z) + (w * _other.w);
+    return util::simd::dot(toSimd(), _other.toSimd());
 }
 
 inline float Vector4::distance(const Vector4& _other) const {
 
-    return sqrt(pow(x - _other.x, 2.0f) + pow(y - _other.y, 2.0f) +
-        pow(z - _other.z, 2.0f) + pow(w - _other.w, 2.0f));
+    return std::sqrt(squaredDistance(_other));
+}
+
+inline float Vector4::squaredDistance(const Vector4& _other) const {
+
+    util::simd::Float4 diff = util::simd::sub(toSimd(), _other.toSimd());
+
+    return util::simd::dot(diff, diff);
 }
 
 inline float* Vector4::toArray() const {
 
     float* array = new float[4];
-    array[0] = x;
-    array[1] = y;
-    array[2] = z;
-    array[3] = w;
+    util::simd::store(array, toSimd());
 
     return array;
 }
 
-inline float Vector4::getX() const {
+inline void Vector4::toArray(float* _array) const {
+
+    util::simd::store(_array, toSimd());
+}
+
+inline float* Vector4::data() {
+
+    return v;
+}
+
+inline const float* Vector4::data() const {
+
+    return v;
+}
+
+inline util::simd::Float4 Vector4::toSimd() const {
+
+    return util::simd::load(v);
+}
+
+inline UTIL_CONSTEXPR float Vector4::getX() const {
 
-    return x;
+    return v[0];
 }
 
-inline float Vector4::getY() const {
+inline UTIL_CONSTEXPR float Vector4::getY() const {
 
-    return y;
+    return v[1];
 }
 
-inline float Vector4::getZ() const {
+inline UTIL_CONSTEXPR float Vector4::getZ() const {
 
-    return z;
+    return v[2];
 }
 
-inline float Vector4::getW() const {
+inline UTIL_CONSTEXPR float Vector4::getW() const {
 
-    return w;
+    return v[3];
 }
 
 inline float Vector4::getR() const {
 
-    return x;
+    return v[0];
 }
 
 inline float Vector4::getG() const {
 
-    return y;
+    return v[1];
 }
 
 inline float Vector4::getB() const {
 
-    return z;
+    return v[2];
 }
 
 inline float Vector4::getA() const {
 
-    return w;
+    return v[3];
 }
 
 inline void Vector4::set(float _x, float _y, float _z, float _w) {
 
-    x = _x;
-    y = _y;
-    z = _z;
-    w = _w;
+    v[0] = _x;
+    v[1] = _y;
+    v[2] = _z;
+    v[3] = _w;
 }
 
 inline void Vector4::setX(float _x) {
 
-    x = _x;
+    v[0] = _x;
 }
 
 inline void Vector4::setY(float _y) {
 
-    y = _y;
+    v[1] = _y;
 }
 
 inline void Vector4::setZ(float _z) {
 
-    z = _z;
+    v[2] = _z;
 }
 
 inline void Vector4::setW(float _w) {
 
-    w = _w;
+    v[3] = _w;
 }
 
 inline void Vector4::setR(float _r) {
 
-    x = _r;
+    v[0] = _r;
 }
 
 inline void Vector4::setG(float _g) {
 
-    y = _g;
+    v[1] = _g;
 }
 
 inline void Vector4::setB(float _b) {
 
-    z = _b;
+    v[2] = _b;
 }
 
 inline void Vector4::setA(float _a) {
 
-    w = _a;
+    v[3] = _a;
 }
 
 inline std::string Vector4::toString() const {
 
     //create the string of the vector
     std::stringstream ss;
-    ss << "[" << x << ", " << y << ", " << z << ", " << w << "]";
+    ss << "[" << v[0] << ", " << v[1] << ", " << v[2] << ", " << v[3] << "]";
 
     return ss.str();
 }
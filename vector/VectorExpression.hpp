@@ -0,0 +1,641 @@
+/**********************************************\
+| Expression templates for fused vector maths. |
+|                                              |
+| @author David Saxon                          |
+\**********************************************/
+
+#ifndef UTILTIES_VECTOR_VECTOREXPRESSION_H_
+#   define UTILTIES_VECTOR_VECTOREXPRESSION_H_
+
+#include "../exceptions/FunctionCallException.hpp"
+#include "Vector3.hpp"
+#include "Vector3Batch.hpp"
+#include "Vector4.hpp"
+
+namespace util { namespace vec { namespace expr {
+
+//Compound vector expressions are opted into by wrapping operands with lazy(),
+//for example:
+//
+//    expr::assign(out, expr::lazy(a) + expr::lazy(b) * s - expr::lazy(c));
+//
+//builds no intermediate vectors, every element of out is computed in one
+//pass. The operands are held by reference so an expression must be
+//assigned in the statement it is built in.
+
+//STRUCTURES
+/*~Base of every expression, E is the type of the expression itself. Every
+expression provides size(), the number of elements it has or 0 if it is the
+same for every element, x(i), y(i), z(i) and w(i) which compute the
+components of element i, and x4(i), y4(i) and z4(i) which compute a component
+of elements i to i + 3 at once. BATCH is whether the expression reads a batch,
+which decides at compile time what it can be assigned to*/
+template <typename E>
+struct Expression {
+
+    /*!@return this expression as its real type*/
+    const E& self() const {
+
+        return static_cast<const E&>(*this);
+    }
+};
+
+/*~A single scalar used for every element*/
+struct Scalar : public Expression<Scalar> {
+
+    //VARIABLES
+    static const bool BATCH = false;
+    float value;
+
+    //CONSTRUCTOR
+    /*!Creates a new scalar expression
+    @_value the scalar*/
+    explicit Scalar(float _value) :
+        value(_value) {
+    }
+
+    //PUBLIC MEMBER FUNCTIONS
+    /*!@return the number of elements, 0 when the expression is the same for
+    every element*/
+    unsigned size() const {
+
+        return 0;
+    }
+
+    float x(unsigned) const {
+
+        return value;
+    }
+
+    float y(unsigned) const {
+
+        return value;
+    }
+
+    float z(unsigned) const {
+
+        return value;
+    }
+
+    float w(unsigned) const {
+
+        return value;
+    }
+
+    util::simd::Float4 x4(unsigned) const {
+
+        return util::simd::splat(value);
+    }
+
+    util::simd::Float4 y4(unsigned) const {
+
+        return util::simd::splat(value);
+    }
+
+    util::simd::Float4 z4(unsigned) const {
+
+        return util::simd::splat(value);
+    }
+};
+
+/*~A single 3D vector used for every element*/
+struct Vector3Leaf : public Expression<Vector3Leaf> {
+
+    //VARIABLES
+    static const bool BATCH = false;
+    const Vector3& vector;
+
+    //CONSTRUCTOR
+    /*!Creates a new leaf expression
+    @_vector the vector the expression reads from*/
+    explicit Vector3Leaf(const Vector3& _vector) :
+        vector(_vector) {
+    }
+
+    //PUBLIC MEMBER FUNCTIONS
+    unsigned size() const {
+
+        return 0;
+    }
+
+    float x(unsigned) const {
+
+        return vector.getX();
+    }
+
+    float y(unsigned) const {
+
+        return vector.getY();
+    }
+
+    float z(unsigned) const {
+
+        return vector.getZ();
+    }
+
+    float w(unsigned) const {
+
+        return 0.0f;
+    }
+
+    util::simd::Float4 x4(unsigned) const {
+
+        return util::simd::splat(vector.getX());
+    }
+
+    util::simd::Float4 y4(unsigned) const {
+
+        return util::simd::splat(vector.getY());
+    }
+
+    util::simd::Float4 z4(unsigned) const {
+
+        return util::simd::splat(vector.getZ());
+    }
+};
+
+/*~A single 4D vector used for every element*/
+struct Vector4Leaf : public Expression<Vector4Leaf> {
+
+    //VARIABLES
+    static const bool BATCH = false;
+    const Vector4& vector;
+
+    //CONSTRUCTOR
+    /*!Creates a new leaf expression
+    @_vector the vector the expression reads from*/
+    explicit Vector4Leaf(const Vector4& _vector) :
+        vector(_vector) {
+    }
+
+    //PUBLIC MEMBER FUNCTIONS
+    unsigned size() const {
+
+        return 0;
+    }
+
+    float x(unsigned) const {
+
+        return vector.getX();
+    }
+
+    float y(unsigned) const {
+
+        return vector.getY();
+    }
+
+    float z(unsigned) const {
+
+        return vector.getZ();
+    }
+
+    float w(unsigned) const {
+
+        return vector.getW();
+    }
+
+    util::simd::Float4 x4(unsigned) const {
+
+        return util::simd::splat(vector.getX());
+    }
+
+    util::simd::Float4 y4(unsigned) const {
+
+        return util::simd::splat(vector.getY());
+    }
+
+    util::simd::Float4 z4(unsigned) const {
+
+        return util::simd::splat(vector.getZ());
+    }
+};
+
+/*~Every vector of a batch, one per element*/
+struct BatchLeaf : public Expression<BatchLeaf> {
+
+    //VARIABLES
+    static const bool BATCH = true;
+    const float* xs;
+    const float* ys;
+    const float* zs;
+    unsigned count;
+
+    //CONSTRUCTOR
+    /*!Creates a new leaf expression
+    @_batch the batch the expression reads from*/
+    explicit BatchLeaf(const Vector3Batch& _batch) :
+        xs(_batch.getX()),
+        ys(_batch.getY()),
+        zs(_batch.getZ()),
+        count(_batch.size()) {
+    }
+
+    //PUBLIC MEMBER FUNCTIONS
+    unsigned size() const {
+
+        return count;
+    }
+
+    float x(unsigned _i) const {
+
+        return xs[_i];
+    }
+
+    float y(unsigned _i) const {
+
+        return ys[_i];
+    }
+
+    float z(unsigned _i) const {
+
+        return zs[_i];
+    }
+
+    float w(unsigned) const {
+
+        return 0.0f;
+    }
+
+    util::simd::Float4 x4(unsigned _i) const {
+
+        return util::simd::load(xs + _i);
+    }
+
+    util::simd::Float4 y4(unsigned _i) const {
+
+        return util::simd::load(ys + _i);
+    }
+
+    util::simd::Float4 z4(unsigned _i) const {
+
+        return util::simd::load(zs + _i);
+    }
+};
+
+/*~The operations a binary expression can perform*/
+struct Add {
+
+    static float apply(float _a, float _b) {
+
+        return _a + _b;
+    }
+
+    static util::simd::Float4 apply(util::simd::Float4 _a,
+        util::simd::Float4 _b) {
+
+        return util::simd::add(_a, _b);
+    }
+};
+
+struct Subtract {
+
+    static float apply(float _a, float _b) {
+
+        return _a - _b;
+    }
+
+    static util::simd::Float4 apply(util::simd::Float4 _a,
+        util::simd::Float4 _b) {
+
+        return util::simd::sub(_a, _b);
+    }
+};
+
+struct Multiply {
+
+    static float apply(float _a, float _b) {
+
+        return _a * _b;
+    }
+
+    static util::simd::Float4 apply(util::simd::Float4 _a,
+        util::simd::Float4 _b) {
+
+        return util::simd::mul(_a, _b);
+    }
+};
+
+struct Divide {
+
+    static float apply(float _a, float _b) {
+
+        return _a / _b;
+    }
+
+    static util::simd::Float4 apply(util::simd::Float4 _a,
+        util::simd::Float4 _b) {
+
+        return util::simd::div(_a, _b);
+    }
+};
+
+/*~Applies an operation element wise to two expressions*/
+template <typename L, typename Op, typename R>
+struct Binary : public Expression<Binary<L, Op, R> > {
+
+    //VARIABLES
+    static const bool BATCH = L::BATCH || R::BATCH;
+    L left;
+    R right;
+
+    //CONSTRUCTOR
+    /*!Creates a new binary expression
+    @_left the left hand side
+    @_right the right hand side*/
+    Binary(const L& _left, const R& _right) :
+        left(_left),
+        right(_right) {
+
+        if (left.size() != 0 && right.size() != 0 &&
+            left.size() != right.size()) {
+
+            throw util::ex::IllegalArgumentException(
+                "batches in an expression must be the same size.");
+        }
+    }
+
+    //PUBLIC MEMBER FUNCTIONS
+    unsigned size() const {
+
+        return left.size() != 0 ? left.size() : right.size();
+    }
+
+    float x(unsigned _i) const {
+
+        return Op::apply(left.x(_i), right.x(_i));
+    }
+
+    float y(unsigned _i) const {
+
+        return Op::apply(left.y(_i), right.y(_i));
+    }
+
+    float z(unsigned _i) const {
+
+        return Op::apply(left.z(_i), right.z(_i));
+    }
+
+    float w(unsigned _i) const {
+
+        return Op::apply(left.w(_i), right.w(_i));
+    }
+
+    util::simd::Float4 x4(unsigned _i) const {
+
+        return Op::apply(left.x4(_i), right.x4(_i));
+    }
+
+    util::simd::Float4 y4(unsigned _i) const {
+
+        return Op::apply(left.y4(_i), right.y4(_i));
+    }
+
+    util::simd::Float4 z4(unsigned _i) const {
+
+        return Op::apply(left.z4(_i), right.z4(_i));
+    }
+};
+
+/*~Negates every element of an expression*/
+template <typename E>
+struct Negate : public Expression<Negate<E> > {
+
+    //VARIABLES
+    static const bool BATCH = E::BATCH;
+    E operand;
+
+    //CONSTRUCTOR
+    /*!Creates a new negation expression
+    @_operand the expression to negate*/
+    explicit Negate(const E& _operand) :
+        operand(_operand) {
+    }
+
+    //PUBLIC MEMBER FUNCTIONS
+    unsigned size() const {
+
+        return operand.size();
+    }
+
+    float x(unsigned _i) const {
+
+        return -operand.x(_i);
+    }
+
+    float y(unsigned _i) const {
+
+        return -operand.y(_i);
+    }
+
+    float z(unsigned _i) const {
+
+        return -operand.z(_i);
+    }
+
+    float w(unsigned _i) const {
+
+        return -operand.w(_i);
+    }
+
+    util::simd::Float4 x4(unsigned _i) const {
+
+        return util::simd::negate(operand.x4(_i));
+    }
+
+    util::simd::Float4 y4(unsigned _i) const {
+
+        return util::simd::negate(operand.y4(_i));
+    }
+
+    util::simd::Float4 z4(unsigned _i) const {
+
+        return util::simd::negate(operand.z4(_i));
+    }
+};
+
+//FUNCTIONS
+/*!@return the vector as an operand of a lazily evaluated expression*/
+inline Vector3Leaf lazy(const Vector3& _vector) {
+
+    return Vector3Leaf(_vector);
+}
+
+/*!@return the vector as an operand of a lazily evaluated expression*/
+inline Vector4Leaf lazy(const Vector4& _vector) {
+
+    return Vector4Leaf(_vector);
+}
+
+/*!@return the batch as an operand of a lazily evaluated expression*/
+inline BatchLeaf lazy(const Vector3Batch& _batch) {
+
+    return BatchLeaf(_batch);
+}
+
+/*!Evaluates the expression into the 3D vector, fails to compile if the
+expression reads a batch
+@_out the vector to write to, may be an operand of the expression
+@_e the expression to evaluate*/
+template <typename E>
+inline void assign(Vector3& _out, const Expression<E>& _e) {
+
+    typedef char ExpressionIsNotBatch[E::BATCH ? -1 : 1];
+    (void) sizeof(ExpressionIsNotBatch);
+
+    const E& e = _e.self();
+    _out.set(e.x(0), e.y(0), e.z(0));
+}
+
+/*!Evaluates the expression into the 4D vector, fails to compile if the
+expression reads a batch
+@_out the vector to write to, may be an operand of the expression
+@_e the expression to evaluate*/
+template <typename E>
+inline void assign(Vector4& _out, const Expression<E>& _e) {
+
+    typedef char ExpressionIsNotBatch[E::BATCH ? -1 : 1];
+    (void) sizeof(ExpressionIsNotBatch);
+
+    const E& e = _e.self();
+    _out.set(e.x(0), e.y(0), e.z(0), e.w(0));
+}
+
+/*!Evaluates the expression into the batch in a single pass, the batch is
+resized to the size of the batches in the expression, fails to compile if
+the expression does not read a batch
+@_out the batch to write to, may be an operand of the expression
+@_e the expression to evaluate*/
+template <typename E>
+inline void assign(Vector3Batch& _out, const Expression<E>& _e) {
+
+    typedef char ExpressionIsBatch[E::BATCH ? 1 : -1];
+    (void) sizeof(ExpressionIsBatch);
+
+    const E& e = _e.self();
+    unsigned count = e.size();
+    _out.resize(count);
+
+    float* ox = _out.getX();
+    float* oy = _out.getY();
+    float* oz = _out.getZ();
+
+    //four elements of each component are computed at once, every expression
+    //is element wise so an output that is also an operand is never read
+    //after being written
+    unsigned i = 0;
+    for (; i + 4 <= count; i += 4) {
+
+        util::simd::Float4 rx = e.x4(i);
+        util::simd::Float4 ry = e.y4(i);
+        util::simd::Float4 rz = e.z4(i);
+
+        util::simd::store(ox + i, rx);
+        util::simd::store(oy + i, ry);
+        util::simd::store(oz + i, rz);
+    }
+    for (; i < count; ++i) {
+
+        float rx = e.x(i);
+        float ry = e.y(i);
+        float rz = e.z(i);
+
+        ox[i] = rx;
+        oy[i] = ry;
+        oz[i] = rz;
+    }
+}
+
+//OPERATORS
+template <typename E>
+inline Negate<E> operator -(const Expression<E>& _e) {
+
+    return Negate<E>(_e.self());
+}
+
+template <typename L, typename R>
+inline Binary<L, Add, R> operator +(const Expression<L>& _l,
+    const Expression<R>& _r) {
+
+    return Binary<L, Add, R>(_l.self(), _r.self());
+}
+
+template <typename L>
+inline Binary<L, Add, Scalar> operator +(const Expression<L>& _l,
+    float _scalar) {
+
+    return Binary<L, Add, Scalar>(_l.self(), Scalar(_scalar));
+}
+
+template <typename R>
+inline Binary<Scalar, Add, R> operator +(float _scalar,
+    const Expression<R>& _r) {
+
+    return Binary<Scalar, Add, R>(Scalar(_scalar), _r.self());
+}
+
+template <typename L, typename R>
+inline Binary<L, Subtract, R> operator -(const Expression<L>& _l,
+    const Expression<R>& _r) {
+
+    return Binary<L, Subtract, R>(_l.self(), _r.self());
+}
+
+template <typename L>
+inline Binary<L, Subtract, Scalar> operator -(const Expression<L>& _l,
+    float _scalar) {
+
+    return Binary<L, Subtract, Scalar>(_l.self(), Scalar(_scalar));
+}
+
+template <typename R>
+inline Binary<Scalar, Subtract, R> operator -(float _scalar,
+    const Expression<R>& _r) {
+
+    return Binary<Scalar, Subtract, R>(Scalar(_scalar), _r.self());
+}
+
+template <typename L, typename R>
+inline Binary<L, Multiply, R> operator *(const Expression<L>& _l,
+    const Expression<R>& _r) {
+
+    return Binary<L, Multiply, R>(_l.self(), _r.self());
+}
+
+template <typename L>
+inline Binary<L, Multiply, Scalar> operator *(const Expression<L>& _l,
+    float _scalar) {
+
+    return Binary<L, Multiply, Scalar>(_l.self(), Scalar(_scalar));
+}
+
+template <typename R>
+inline Binary<Scalar, Multiply, R> operator *(float _scalar,
+    const Expression<R>& _r) {
+
+    return Binary<Scalar, Multiply, R>(Scalar(_scalar), _r.self());
+}
+
+template <typename L, typename R>
+inline Binary<L, Divide, R> operator /(const Expression<L>& _l,
+    const Expression<R>& _r) {
+
+    return Binary<L, Divide, R>(_l.self(), _r.self());
+}
+
+template <typename L>
+inline Binary<L, Divide, Scalar> operator /(const Expression<L>& _l,
+    float _scalar) {
+
+    return Binary<L, Divide, Scalar>(_l.self(), Scalar(_scalar));
+}
+
+template <typename R>
+inline Binary<Scalar, Divide, R> operator /(float _scalar,
+    const Expression<R>& _r) {
+
+    return Binary<Scalar, Divide, R>(Scalar(_scalar), _r.self());
+}
+
+} } } //util //vec //expr
+
+#endif